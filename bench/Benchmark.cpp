@@ -0,0 +1,382 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <regex>
+#include <thread>
+#include <algorithm>
+
+// Tiempo mínimo medido por ejecución (s) y techo de iteraciones al calibrar
+static const double    DEFAULT_MIN_TIME = 0.5;
+static const long long MAX_ITERATIONS   = 1000000000LL;
+
+//------------------------------------------------------------------
+// Estado de una ejecución
+//------------------------------------------------------------------
+BenchmarkState::BenchmarkState(const std::vector<long long> &args, long long maxIterations)
+    : args(args), maxIterations(maxIterations), running(false), cpuStart(0), realSeconds(0.0),
+      cpuSeconds(0.0), itemsProcessed(0), bytesProcessed(0) {
+
+}
+
+BenchmarkState::Iterator BenchmarkState::begin() {
+
+    startTimer();
+    Iterator it = { this, error.empty() ? maxIterations : 0 };
+    return it;
+
+}
+
+bool BenchmarkState::Iterator::operator!=(const Iterator &) const {
+
+    if(remaining > 0) return true;
+    state->stopTimer();
+    return false;
+
+}
+
+void BenchmarkState::pauseTiming() {
+
+    stopTimer();
+
+}
+
+void BenchmarkState::resumeTiming() {
+
+    startTimer();
+
+}
+
+void BenchmarkState::skipWithError(const std::string &message) {
+
+    error = message;
+    stopTimer();
+
+}
+
+void BenchmarkState::startTimer() {
+
+    if(running) return;
+    running   = true;
+    realStart = Clock::now();
+    cpuStart  = std::clock();
+
+}
+
+void BenchmarkState::stopTimer() {
+
+    if(!running) return;
+    running      = false;
+    realSeconds += std::chrono::duration<double>(Clock::now() - realStart).count();
+    cpuSeconds  += (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+}
+
+//------------------------------------------------------------------
+// Registro
+//------------------------------------------------------------------
+Benchmark::Benchmark(const std::string &name, BenchmarkFunction function) : name(name), function(function), fixedIterations(0) {
+
+}
+
+Benchmark* Benchmark::arg(long long value) {
+
+    argSets.push_back(std::vector<long long>(1, value));
+    return this;
+
+}
+
+Benchmark* Benchmark::args(const std::vector<long long> &values) {
+
+    argSets.push_back(values);
+    return this;
+
+}
+
+Benchmark* Benchmark::argNames(const std::vector<std::string> &names) {
+
+    this->names = names;
+    return this;
+
+}
+
+Benchmark* Benchmark::iterations(long long count) {
+
+    fixedIterations = count;
+    return this;
+
+}
+
+//----------------------------------------------------------------------
+// Nombre de una ejecución: nombre/arg0/arg1... o nombre/peces:9/... si
+// los argumentos tienen nombre
+//----------------------------------------------------------------------
+std::string Benchmark::runName(size_t index) const {
+
+    std::ostringstream text;
+    text << name;
+    if(index < argSets.size()) {
+        for(size_t a = 0; a < argSets[index].size(); a++) {
+            text << "/";
+            if(a < names.size()) text << names[a] << ":";
+            text << argSets[index][a];
+        }
+    }
+    return text.str();
+
+}
+
+static std::vector<Benchmark*>& registry() {
+
+    static std::vector<Benchmark*> benchmarks;
+    return benchmarks;
+
+}
+
+Benchmark* registerBenchmark(const std::string &name, BenchmarkFunction function) {
+
+    Benchmark *benchmark = new Benchmark(name, function);
+    registry().push_back(benchmark);
+    return benchmark;
+
+}
+
+//------------------------------------------------------------------
+// Ejecución e informes
+//------------------------------------------------------------------
+struct BenchmarkResult {
+    std::string name;
+    long long   iterations;
+    double      realNs;   // Por iteración
+    double      cpuNs;
+    double      itemsPerSecond;
+    double      bytesPerSecond;
+    std::string label;
+    std::string error;
+};
+
+class BenchmarkRunner {
+
+    public:
+
+        static BenchmarkResult run(const Benchmark &benchmark, size_t index, double minTime);
+
+};
+
+//------------------------------------------------------------------------------------------
+// Ejecuta la función con 1 iteración y repite con más (hasta 10 veces más cada vez) hasta que
+// el tiempo medido llega a minTime; el resultado es el de la última ejecución
+//------------------------------------------------------------------------------------------
+BenchmarkResult BenchmarkRunner::run(const Benchmark &benchmark, size_t index, double minTime) {
+
+    const std::vector<long long> args = index < benchmark.argSets.size() ? benchmark.argSets[index] : std::vector<long long>();
+    long long iterations = benchmark.fixedIterations > 0 ? benchmark.fixedIterations : 1;
+    BenchmarkResult result;
+    result.name = benchmark.runName(index);
+
+    while(true) {
+        BenchmarkState state(args, iterations);
+        benchmark.function(state);
+        state.stopTimer();
+
+        const bool done = !state.error.empty() || benchmark.fixedIterations > 0 ||
+                          state.realSeconds >= minTime || iterations >= MAX_ITERATIONS;
+        if(done) {
+            result.iterations     = iterations;
+            result.realNs         = state.realSeconds * 1.0e9 / iterations;
+            result.cpuNs          = state.cpuSeconds  * 1.0e9 / iterations;
+            result.itemsPerSecond = state.itemsProcessed > 0 && state.realSeconds > 0.0 ? state.itemsProcessed / state.realSeconds : 0.0;
+            result.bytesPerSecond = state.bytesProcessed > 0 && state.realSeconds > 0.0 ? state.bytesProcessed / state.realSeconds : 0.0;
+            result.label          = state.label;
+            result.error          = state.error;
+            return result;
+        }
+
+        // Estimación con un 40 % de margen, sin multiplicar por más de 10 de una vez
+        const double predicted = state.realSeconds > 1.0e-9 ? iterations * minTime * 1.4 / state.realSeconds : iterations * 10.0;
+        iterations = std::min(MAX_ITERATIONS, std::max(iterations + 1, std::min((long long)predicted, iterations * 10)));
+    }
+
+}
+
+static std::string jsonString(const std::string &text) {
+
+    std::string out = "\"";
+    for(char c : text) {
+        if(c == '"' || c == '\\') out += '\\';
+        if((unsigned char)c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", c);
+            out += code;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+
+}
+
+//--------------------------------------------------------------------------------------
+// Mismo esquema que --benchmark_out de Google Benchmark (context + benchmarks, tiempos en
+// ns por iteración), para comparar ejecuciones con sus herramientas (compare.py)
+//--------------------------------------------------------------------------------------
+static void writeJson(std::ostream &out, const char *executable, const std::vector<BenchmarkResult> &results) {
+
+    char date[64];
+    const std::time_t now = std::time(NULL);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": " << jsonString(date) << ",\n";
+    out << "    \"executable\": " << jsonString(executable) << ",\n";
+    out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+    out << "    \"library_build_type\": \"release\"\n";
+#else
+    out << "    \"library_build_type\": \"debug\"\n";
+#endif
+    out << "  },\n  \"benchmarks\": [";
+    for(size_t i = 0; i < results.size(); i++) {
+        const BenchmarkResult &result = results[i];
+        char number[64];
+        out << (i ? ",\n" : "\n") << "    {\n";
+        out << "      \"name\": " << jsonString(result.name) << ",\n";
+        out << "      \"run_name\": " << jsonString(result.name) << ",\n";
+        out << "      \"run_type\": \"iteration\",\n";
+        if(!result.error.empty()) {
+            out << "      \"error_occurred\": true,\n";
+            out << "      \"error_message\": " << jsonString(result.error) << ",\n";
+        }
+        out << "      \"iterations\": " << result.iterations << ",\n";
+        snprintf(number, sizeof(number), "%.6g", result.realNs);
+        out << "      \"real_time\": " << number << ",\n";
+        snprintf(number, sizeof(number), "%.6g", result.cpuNs);
+        out << "      \"cpu_time\": " << number << ",\n";
+        if(result.itemsPerSecond > 0.0) {
+            snprintf(number, sizeof(number), "%.6g", result.itemsPerSecond);
+            out << "      \"items_per_second\": " << number << ",\n";
+        }
+        if(result.bytesPerSecond > 0.0) {
+            snprintf(number, sizeof(number), "%.6g", result.bytesPerSecond);
+            out << "      \"bytes_per_second\": " << number << ",\n";
+        }
+        if(!result.label.empty()) out << "      \"label\": " << jsonString(result.label) << ",\n";
+        out << "      \"time_unit\": \"ns\"\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+}
+
+static void printHeader(size_t nameWidth) {
+
+    const std::string rule(nameWidth + 43, '-');
+    char line[512];
+    snprintf(line, sizeof(line), "%-*s %15s %15s %12s", (int)nameWidth, "Benchmark", "Time", "CPU", "Iterations");
+    std::cout << rule << "\n" << line << "\n" << rule << std::endl;
+
+}
+
+static void printResult(const BenchmarkResult &result, size_t nameWidth) {
+
+    char line[512];
+    if(!result.error.empty()) {
+        snprintf(line, sizeof(line), "%-*s ERROR: %s", (int)nameWidth, result.name.c_str(), result.error.c_str());
+        std::cout << line << std::endl;
+        return;
+    }
+    int length = snprintf(line, sizeof(line), "%-*s %12.0f ns %12.0f ns %12lld", (int)nameWidth, result.name.c_str(), result.realNs, result.cpuNs, result.iterations);
+    if(result.itemsPerSecond > 0.0) length += snprintf(line + length, sizeof(line) - length, " items_per_second=%.4g/s", result.itemsPerSecond);
+    if(result.bytesPerSecond > 0.0) length += snprintf(line + length, sizeof(line) - length, " bytes_per_second=%.4g/s", result.bytesPerSecond);
+    if(!result.label.empty()) snprintf(line + length, sizeof(line) - length, " %s", result.label.c_str());
+    std::cout << line << std::endl;
+
+}
+
+static const char* optionValue(const char *arg, const char *option) {
+
+    const size_t length = std::strlen(option);
+    return std::strncmp(arg, option, length) == 0 && arg[length] == '=' ? arg + length + 1 : NULL;
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Opciones (las de Google Benchmark que se usan): --benchmark_filter=<regex> (con '-' delante se
+// excluye lo que coincide), --benchmark_out=<fichero> (JSON), --benchmark_format=<console|json>,
+// --benchmark_min_time=<s> y --benchmark_list_tests
+//---------------------------------------------------------------------------------------------
+int runBenchmarks(int argc, char **argv) {
+
+    std::string filter = ".";
+    const char *outFile = NULL;
+    bool json = false;
+    bool list = false;
+    double minTime = DEFAULT_MIN_TIME;
+
+    for(int i = 1; i < argc; i++) {
+        const char *value;
+        if     ((value = optionValue(argv[i], "--benchmark_filter"))) filter = value;
+        else if((value = optionValue(argv[i], "--benchmark_out"))) outFile = value;
+        else if((value = optionValue(argv[i], "--benchmark_out_format"))) {
+            if(std::strcmp(value, "json") != 0) std::cerr << "Solo se guarda en JSON" << std::endl;
+        }
+        else if((value = optionValue(argv[i], "--benchmark_format"))) json = std::strcmp(value, "json") == 0;
+        else if((value = optionValue(argv[i], "--benchmark_min_time"))) minTime = std::atof(value);
+        else if(std::strcmp(argv[i], "--benchmark_list_tests") == 0) list = true;
+        else {
+            std::cerr << "Opcion desconocida: " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const bool exclude = !filter.empty() && filter[0] == '-';
+    std::regex pattern;
+    try {
+        pattern = std::regex(exclude ? filter.substr(1) : filter);
+    } catch(const std::regex_error &) {
+        std::cerr << "Filtro no valido: " << filter << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Ejecuciones seleccionadas: cada benchmark con cada juego de argumentos
+    std::vector<std::pair<Benchmark*, size_t>> runs;
+    size_t nameWidth = 10;
+    for(Benchmark *benchmark : registry()) {
+        for(size_t s = 0; s < benchmark->numRuns(); s++) {
+            const std::string name = benchmark->runName(s);
+            if(std::regex_search(name, pattern) == exclude) continue;
+            runs.push_back(std::make_pair(benchmark, s));
+            nameWidth = std::max(nameWidth, name.size());
+        }
+    }
+
+    if(list) {
+        for(const auto &run : runs) std::cout << run.first->runName(run.second) << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<BenchmarkResult> results;
+    if(!json) printHeader(nameWidth);
+    for(const auto &run : runs) {
+        results.push_back(BenchmarkRunner::run(*run.first, run.second, minTime));
+        if(!json) printResult(results.back(), nameWidth);
+    }
+    if(json) writeJson(std::cout, argv[0], results);
+
+    if(outFile) {
+        std::ostringstream text;
+        writeJson(text, argv[0], results);
+        FILE *out = fopen(outFile, "w");
+        if(!out) {
+            std::cerr << "No se puede crear " << outFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        const std::string data = text.str();
+        fwrite(data.data(), 1, data.size(), out);
+        fclose(out);
+    }
+    return EXIT_SUCCESS;
+
+}
@@ -0,0 +1,114 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <functional>
+
+class BenchmarkState;
+
+// Sin aviso de variable sin usar por la _ de for (auto _ : state)
+#if defined(__GNUC__)
+#define BENCHMARK_UNUSED __attribute__((unused))
+#else
+#define BENCHMARK_UNUSED
+#endif
+
+typedef std::function<void(BenchmarkState&)> BenchmarkFunction;
+
+// Estado de una ejecución de un microbenchmark, al estilo de Google Benchmark: el cuerpo que se
+// mide va en un for (auto _ : state) y el marco decide cuántas iteraciones hacen falta
+class BenchmarkState {
+
+    public:
+
+        BenchmarkState(const std::vector<long long> &args, long long maxIterations);
+
+        long long range(size_t index = 0) const { return index < args.size() ? args[index] : 0; }
+        long long iterations() const { return maxIterations; }
+
+        void pauseTiming ();
+        void resumeTiming();
+        void skipWithError   (const std::string &message);
+        void setItemsProcessed(long long items) { itemsProcessed = items; }
+        void setBytesProcessed(long long bytes) { bytesProcessed = bytes; }
+        void setLabel        (const std::string &text) { label = text; }
+
+        // Iteración de for (auto _ : state): el reloj corre desde begin() hasta llegar a end()
+        struct BENCHMARK_UNUSED Value {};
+        struct Iterator {
+            BenchmarkState *state;
+            long long       remaining;
+            bool  operator!=(const Iterator &) const;
+            void  operator++() { remaining--; }
+            Value operator* () const { return Value(); }
+        };
+        Iterator begin();
+        Iterator end  () { Iterator it = { this, 0 }; return it; }
+
+    private:
+
+        friend class BenchmarkRunner;
+        typedef std::chrono::steady_clock Clock;
+
+        std::vector<long long> args;
+        long long              maxIterations;
+        bool                   running;
+        Clock::time_point      realStart;
+        std::clock_t           cpuStart;
+        double                 realSeconds;
+        double                 cpuSeconds;
+        long long              itemsProcessed;
+        long long              bytesProcessed;
+        std::string            label;
+        std::string            error;
+
+        void startTimer();
+        void stopTimer ();
+
+};
+
+// Un microbenchmark registrado y sus juegos de argumentos (uno por ejecución)
+class Benchmark {
+
+    public:
+
+        Benchmark(const std::string &name, BenchmarkFunction function);
+
+        Benchmark* arg       (long long value);
+        Benchmark* args      (const std::vector<long long> &values);
+        Benchmark* argNames  (const std::vector<std::string> &names);
+        Benchmark* iterations(long long count);   // Fija las iteraciones en vez de calibrarlas
+
+        size_t      numRuns() const { return argSets.empty() ? 1 : argSets.size(); }
+        std::string runName(size_t index) const;
+
+    private:
+
+        friend class BenchmarkRunner;
+
+        std::string                         name;
+        BenchmarkFunction                   function;
+        std::vector<std::vector<long long>> argSets;
+        std::vector<std::string>            names;
+        long long                           fixedIterations;
+
+};
+
+Benchmark* registerBenchmark(const std::string &name, BenchmarkFunction function);
+int        runBenchmarks    (int argc, char **argv);
+
+#define BENCHMARK_CONCAT_(a, b) a##b
+#define BENCHMARK_CONCAT(a, b)  BENCHMARK_CONCAT_(a, b)
+
+// BENCHMARK(funcion)->arg(...): registra la función con su nombre.
+// BENCHMARK_CAPTURE(funcion, caso, valores...): la registra como funcion/caso con esos valores
+#define BENCHMARK(function) \
+    static Benchmark *BENCHMARK_CONCAT(benchmark_, __LINE__) = registerBenchmark(#function, function)
+#define BENCHMARK_CAPTURE(function, caseName, ...) \
+    static Benchmark *BENCHMARK_CONCAT(benchmark_, __LINE__) = registerBenchmark(#function "/" #caseName, \
+        [](BenchmarkState &state) { function(state, __VA_ARGS__); })
+
+#endif /* BENCHMARK_H */
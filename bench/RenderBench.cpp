@@ -0,0 +1,178 @@
+#include "Benchmark.h"
+#include "Shaders.h"
+#include "Model.h"
+#include "AssetLoader.h"
+#include "HeadlessContext.h"
+#include "MemoryRegistry.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <fstream>
+
+//------------------------------------------------------------------------------------------------
+// Contexto OpenGL 3.3 core para las pruebas que lo necesitan, creado la primera vez: sin ventana
+// si el ejecutable tiene backend (AQUARIO_HEADLESS) y si no con una ventana GLFW oculta
+//------------------------------------------------------------------------------------------------
+static bool ensureContext() {
+
+    static int ready = -1;
+    if(ready >= 0) return ready == 1;
+    ready = 0;
+
+#if defined(AQUARIO_HEADLESS_EGL) || defined(AQUARIO_HEADLESS_OSMESA)
+    static HeadlessContext context;
+    if(!context.create()) return false;
+#else
+    if(!glfwInit()) return false;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    GLFWwindow *window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+    if(!window) return false;
+    glfwMakeContextCurrent(window);
+#endif
+
+    glewExperimental = GL_TRUE;
+    const GLenum result = glewInit();
+    if(result != GLEW_OK && result != GLEW_ERROR_NO_GLX_DISPLAY) return false;
+    ready = 1;
+    return true;
+
+}
+
+// Programa de la escena, compilado una vez
+static Shaders* sceneShader() {
+
+    static Shaders *shader = NULL;
+    if(!shader) {
+        shader = new Shaders();
+        shader->initShaders("resources/shaders/vshader.glsl", "resources/shaders/fshader.glsl");
+        shader->useShaders();
+    }
+    return shader;
+
+}
+
+static bool fileExists(const char *file) {
+
+    std::ifstream in(file);
+    return in.good();
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Setters de uniformes del shader de la escena con los nombres que usa renderScene: cada uno
+// busca la posición por nombre y sube el valor
+//--------------------------------------------------------------------------------------------
+static void Shaders_setMat4(BenchmarkState &state) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    Shaders &shader = *sceneShader();
+    glm::mat4 value(1.0f);
+    for(auto _ : state) {
+        value[3][0] += 1.0f;
+        shader.setMat4("uPVM", value);
+    }
+    glFinish();
+    state.setItemsProcessed(state.iterations());
+
+}
+BENCHMARK(Shaders_setMat4);
+
+static void Shaders_setVec4(BenchmarkState &state) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    Shaders &shader = *sceneShader();
+    glm::vec4 value(0.0f);
+    for(auto _ : state) {
+        value.x += 1.0f;
+        shader.setVec4("uColor", value);
+    }
+    glFinish();
+    state.setItemsProcessed(state.iterations());
+
+}
+BENCHMARK(Shaders_setVec4);
+
+static void Shaders_setFloat(BenchmarkState &state) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    Shaders &shader = *sceneShader();
+    float value = 0.0f;
+    for(auto _ : state) {
+        value += 1.0f;
+        shader.setFloat("uTime", value);
+    }
+    glFinish();
+    state.setItemsProcessed(state.iterations());
+
+}
+BENCHMARK(Shaders_setFloat);
+
+static void Shaders_setBool(BenchmarkState &state) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    Shaders &shader = *sceneShader();
+    int value = 0;
+    for(auto _ : state) {
+        value ^= 1;
+        shader.setBool("uInstanced", value);
+    }
+    glFinish();
+    state.setItemsProcessed(state.iterations());
+
+}
+BENCHMARK(Shaders_setBool);
+
+//-----------------------------------------------------------------------------------------
+// Carga completa de un modelo (lectura con assimp y subida a la GPU) y su liberación
+//-----------------------------------------------------------------------------------------
+static void Model_initModel(BenchmarkState &state, const char *modelFile) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    if(!fileExists(modelFile)) return state.skipWithError(std::string("no existe ") + modelFile + " (ejecutar desde binary/)");
+    for(auto _ : state) {
+        Model *model = new Model();
+        model->initModel(modelFile);
+        glFinish();
+        state.pauseTiming();
+        delete model;
+        state.resumeTiming();
+    }
+    state.setLabel(modelFile);
+
+}
+BENCHMARK_CAPTURE(Model_initModel, cube, "resources/models/cube.obj");
+BENCHMARK_CAPTURE(Model_initModel, pez, "resources/models/pez.obj");
+BENCHMARK_CAPTURE(Model_initModel, sphere, "resources/models/sphere.obj");
+BENCHMARK_CAPTURE(Model_initModel, Table, "resources/models/Table.obj");
+BENCHMARK_CAPTURE(Model_initModel, coral, "resources/models/coral.obj");
+BENCHMARK_CAPTURE(Model_initModel, cone, "resources/models/cone.obj");
+
+//-----------------------------------------------------------------------------------------
+// Carga síncrona de una textura (decodificación, subida y mipmaps) y su liberación
+//-----------------------------------------------------------------------------------------
+static void loadTexture(BenchmarkState &state, const char *textureFile) {
+
+    if(!ensureContext()) return state.skipWithError("sin contexto OpenGL");
+    if(!fileExists(textureFile)) return state.skipWithError(std::string("no existe ") + textureFile + " (ejecutar desde binary/)");
+    for(auto _ : state) {
+        GLuint texture = AssetLoader::loadTexture(textureFile);
+        glFinish();
+        state.pauseTiming();
+        glDeleteTextures(1, &texture);
+        MemoryRegistry::remove(MEMORIA_TEXTURA, texture);
+        state.resumeTiming();
+    }
+    state.setLabel(textureFile);
+
+}
+BENCHMARK_CAPTURE(loadTexture, arena, "resources/textures/arena.jpg");
+BENCHMARK_CAPTURE(loadTexture, coral, "resources/textures/coral.jpg");
+BENCHMARK_CAPTURE(loadTexture, ventilador1, "resources/textures/ventilador1.jpg");
+BENCHMARK_CAPTURE(loadTexture, room_back, "resources/textures/room_back.jpg");
+BENCHMARK_CAPTURE(loadTexture, acuario, "resources/textures/acuario.jpeg");
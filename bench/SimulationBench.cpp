@@ -0,0 +1,149 @@
+#include "Benchmark.h"
+#include "Simulation.h"
+
+#include <vector>
+#include <random>
+
+// Un paso de la simulación, como en Simulation::step
+static const float BENCH_DT = Simulation::STEP;
+
+// Iteraciones tras las que comida y burbujas se vuelven a colocar (antes de que salgan de la
+// pecera y el bucle solo compruebe activa); la reposición no se mide
+static const long long RESET_INTERVAL = 256;
+
+static JobSystem& benchJobs() {
+
+    static JobSystem jobs;
+    return jobs;
+
+}
+
+//----------------------------------------------------------------------------------------
+// n peces repartidos por la pecera con velocidades y ondulación como los de Simulation::init
+//----------------------------------------------------------------------------------------
+static std::vector<Pez> crearPeces(int n, std::minstd_rand &rng) {
+
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<Pez> peces(n);
+    for(Pez &pez : peces) {
+        pez = Pez();
+        pez.posicion          = glm::vec3(-2.4f + u(rng) * 4.8f, -3.6f + u(rng) * 3.7f, -13.3f + u(rng) * 2.6f);
+        pez.velocidadOriginal = glm::vec3(u(rng) - 0.5f, (u(rng) - 0.5f) * 0.3f, u(rng) - 0.5f);
+        pez.velocidad         = pez.velocidadOriginal;
+        pez.color             = glm::vec4(u(rng), u(rng), u(rng), 1.0f);
+        pez.escala            = 0.35f + u(rng) * 0.04f;
+        pez.anguloDireccion   = atan2(pez.velocidad.x, pez.velocidad.z);
+        pez.anguloObjetivo    = pez.anguloDireccion;
+        pez.tiempoOndulacion  = u(rng) * 6.28f;
+        pez.amplitudOndulacion   = 0.02f + u(rng) * 0.015f;
+        pez.frecuenciaOndulacion = 4.0f + u(rng);
+        pez.tiempoCambio      = u(rng) * 3.0f;
+        pez.alturaObjetivo    = pez.posicion.y;
+    }
+    return peces;
+
+}
+
+// Comida recién echada (toda activa) en la superficie, como Simulation::echarComida
+static void echarComida(std::vector<Comida> &comidas, std::minstd_rand &rng) {
+
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for(Comida &comida : comidas) {
+        comida.posicion = glm::vec3(-2.0f + u(rng) * 4.0f, 0.2f, -13.0f + u(rng) * 2.0f);
+        comida.color    = glm::vec4(1.0f, 0.9f, 0.2f, 1.0f);
+        comida.escala   = 1.0f;
+        comida.activa   = true;
+    }
+
+}
+
+// Burbujas activas en el fondo, con las velocidades de Simulation::generarBurbuja
+static void soltarBurbujas(std::vector<Burbuja> &burbujas, std::minstd_rand &rng) {
+
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for(Burbuja &burbuja : burbujas) {
+        burbuja.posicion        = glm::vec3(-2.4f + u(rng) * 4.8f, -3.8f, -13.3f + u(rng) * 2.6f);
+        burbuja.escala          = 0.02f + u(rng) * 0.02f;
+        burbuja.velocidadSubida = 0.25f + u(rng) * 0.2f;
+        burbuja.oscilacionX     = 0.06f + u(rng) * 0.08f;
+        burbuja.oscilacionZ     = 0.06f + u(rng) * 0.08f;
+        burbuja.fase            = u(rng) * 6.28f;
+        burbuja.activa          = true;
+    }
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Un paso de comportamiento de range(0) peces, con toda la comida de la pecera (range(1) = 1) o
+// sin ella. La evitación entre peces es de todos con todos, así que el coste crece con n²
+//--------------------------------------------------------------------------------------------
+static void actualizarPeces(BenchmarkState &state) {
+
+    const int numPeces = (int)state.range(0);
+    const bool conComida = state.range(1) != 0;
+    std::minstd_rand rng(1);
+    std::vector<Pez> peces = crearPeces(numPeces, rng);
+    std::vector<Comida> comidas(MAX_COMIDA);
+    std::vector<Comida> comidaInicial(MAX_COMIDA, Comida());
+    if(conComida) echarComida(comidaInicial, rng);
+
+    for(auto _ : state) {
+        // Los peces se comen la comida: cada paso empieza con la misma
+        state.pauseTiming();
+        comidas = comidaInicial;
+        state.resumeTiming();
+        Simulation::actualizarPeces(peces.data(), numPeces, comidas.data(), MAX_COMIDA, BENCH_DT, rng);
+    }
+    state.setItemsProcessed(state.iterations() * numPeces);
+
+}
+BENCHMARK(actualizarPeces)
+    ->argNames({ "peces", "comida" })
+    ->args({ NUM_PECES, 0 })->args({ NUM_PECES, 1 })
+    ->args({ 1000, 0 })->args({ 1000, 1 })
+    ->args({ 100000, 0 })->args({ 100000, 1 })
+    ->args({ 1000000, 0 })->args({ 1000000, 1 });
+
+// Caída de range(0) trozos de comida, en paralelo en el sistema de tareas
+static void actualizarComida(BenchmarkState &state) {
+
+    const int numComidas = (int)state.range(0);
+    std::minstd_rand rng(1);
+    std::vector<Comida> comidas(numComidas);
+    echarComida(comidas, rng);
+
+    long long pasos = 0;
+    for(auto _ : state) {
+        if(++pasos % RESET_INTERVAL == 0) {
+            state.pauseTiming();
+            echarComida(comidas, rng);
+            state.resumeTiming();
+        }
+        Simulation::actualizarComida(benchJobs(), comidas.data(), numComidas, BENCH_DT);
+    }
+    state.setItemsProcessed(state.iterations() * numComidas);
+
+}
+BENCHMARK(actualizarComida)->argNames({ "comida" })->arg(MAX_COMIDA)->arg(1 << 14)->arg(1 << 17)->arg(1 << 20);
+
+// Subida y oscilación de range(0) burbujas, en paralelo en el sistema de tareas
+static void actualizarBurbujas(BenchmarkState &state) {
+
+    const int numBurbujas = (int)state.range(0);
+    std::minstd_rand rng(1);
+    std::vector<Burbuja> burbujas(numBurbujas);
+    soltarBurbujas(burbujas, rng);
+
+    long long pasos = 0;
+    for(auto _ : state) {
+        if(++pasos % RESET_INTERVAL == 0) {
+            state.pauseTiming();
+            soltarBurbujas(burbujas, rng);
+            state.resumeTiming();
+        }
+        Simulation::actualizarBurbujas(benchJobs(), burbujas.data(), numBurbujas, BENCH_DT);
+    }
+    state.setItemsProcessed(state.iterations() * numBurbujas);
+
+}
+BENCHMARK(actualizarBurbujas)->argNames({ "burbujas" })->arg(MAX_BURBUJAS)->arg(1 << 14)->arg(1 << 17)->arg(1 << 20);
@@ -0,0 +1,11 @@
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "Benchmark.h"
+
+// Microbenchmarks de las partes críticas (simulación, uniformes y carga de recursos). Se ejecutan
+// desde binary/ para encontrar los recursos; --benchmark_out=<fichero> guarda el JSON
+int main(int argc, char** argv)
+{
+    return runBenchmarks(argc, argv);
+}
@@ -4,30 +4,32 @@ in vec2 vTexCoord;
 in vec3 vNormal;
 in vec3 vFragPos;
 in vec3 vViewPos;
+flat in vec4 vColor;
+flat in float vTextureLayer;
+flat in int vUseTexture;
 
-uniform vec4 uColor;
-uniform sampler2D uTexture;
-uniform bool useTexture;
+uniform sampler2DArray uTextureArray;
 uniform bool uEnableLighting;
 
-// Sistema de iluminación
-uniform vec3 uAmbientLight;        
-uniform vec3 uDirLightDir;         
-uniform vec3 uDirLightColor;       
-uniform vec3 uMovingLightPos;   
-uniform vec3 uMovingLightColor;   
-uniform bool uMovingLightEnabled;  
+// Sistema de iluminación: bloque uniforme que se escribe una vez por frame
+layout (std140) uniform Lighting {
+    vec4 uAmbientLight;        
+    vec4 uDirLightDir;         
+    vec4 uDirLightColor;       
+    vec4 uMovingLightPos;   
+    vec4 uMovingLightColor;    // w: 1 si la luz móvil está encendida
+};
 
 out vec4 outColor;
 
 void main() {
     // Color base
     vec4 baseColor;
-    if (useTexture) {
-        vec4 texColor = texture(uTexture, vTexCoord);
-        baseColor = texColor * uColor;
+    if (vUseTexture != 0) {
+        vec4 texColor = texture(uTextureArray, vec3(vTexCoord, vTextureLayer));
+        baseColor = texColor * vColor;
     } else {
-        baseColor = uColor;
+        baseColor = vColor;
     }
     
     // Si la iluminación está desactivada, devolver color base
@@ -39,37 +41,37 @@ void main() {
     vec3 norm = normalize(vNormal);
     vec3 viewDir = normalize(vViewPos - vFragPos);
     
-    vec3 ambient = uAmbientLight;
+    vec3 ambient = uAmbientLight.rgb;
     
-    vec3 dirLightDir = normalize(-uDirLightDir);
+    vec3 dirLightDir = normalize(-uDirLightDir.xyz);
     
     // Difusa
     float dirDiff = max(dot(norm, dirLightDir), 0.0);
-    vec3 dirDiffuse = dirDiff * uDirLightColor;
+    vec3 dirDiffuse = dirDiff * uDirLightColor.rgb;
     
     // Especular
     vec3 dirReflectDir = reflect(-dirLightDir, norm);
     float dirSpec = pow(max(dot(viewDir, dirReflectDir), 0.0), 32.0);
-    vec3 dirSpecular = 0.3 * dirSpec * uDirLightColor;
+    vec3 dirSpecular = 0.3 * dirSpec * uDirLightColor.rgb;
     
     vec3 movingDiffuse = vec3(0.0);
     vec3 movingSpecular = vec3(0.0);
     
-    if (uMovingLightEnabled) {
-        vec3 movingLightDir = normalize(uMovingLightPos - vFragPos);
-        float distance = length(uMovingLightPos - vFragPos);
+    if (uMovingLightColor.w > 0.5) {
+        vec3 movingLightDir = normalize(uMovingLightPos.xyz - vFragPos);
+        float distance = length(uMovingLightPos.xyz - vFragPos);
         
         // Atenuación por distancia (reducida para mayor alcance)
         float attenuation = 1.0 / (1.0 + 0.045 * distance + 0.0075 * distance * distance);
         
         // Difusa
         float movingDiff = max(dot(norm, movingLightDir), 0.0);
-        movingDiffuse = movingDiff * uMovingLightColor * attenuation;
+        movingDiffuse = movingDiff * uMovingLightColor.rgb * attenuation;
         
         // Especular
         vec3 movingReflectDir = reflect(-movingLightDir, norm);
         float movingSpec = pow(max(dot(viewDir, movingReflectDir), 0.0), 64.0);
-        movingSpecular = 1.5 * movingSpec * uMovingLightColor * attenuation;
+        movingSpecular = 1.5 * movingSpec * uMovingLightColor.rgb * attenuation;
     }
     
     vec3 lighting = ambient + dirDiffuse + dirSpecular + movingDiffuse + movingSpecular;
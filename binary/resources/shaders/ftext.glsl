@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 vTexCoord;
+in vec4 vColor;
+
+uniform sampler2D uAtlas;   // Un canal: 1 donde el carácter tiene píxel
+
+out vec4 outColor;
+
+void main() {
+    outColor = vec4(vColor.rgb, vColor.a * texture(uAtlas, vTexCoord).r);
+}
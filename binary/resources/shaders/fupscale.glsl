@@ -0,0 +1,27 @@
+#version 330 core
+
+in vec2 vTexCoord;
+
+uniform sampler2D uSource;      // Escena a resolución interna (filtro bilineal)
+uniform vec2      uTexel;       // 1 / tamaño de la escena
+uniform float     uSharpness;   // 0: solo bilineal
+
+out vec4 outColor;
+
+void main() {
+    vec3 color = texture(uSource, vTexCoord).rgb;
+
+    // Máscara de enfoque con la cruz de vecinos, limitada a su rango para no crear halos
+    if (uSharpness > 0.0) {
+        vec3 n = texture(uSource, vTexCoord + vec2(0.0, uTexel.y)).rgb;
+        vec3 s = texture(uSource, vTexCoord - vec2(0.0, uTexel.y)).rgb;
+        vec3 e = texture(uSource, vTexCoord + vec2(uTexel.x, 0.0)).rgb;
+        vec3 w = texture(uSource, vTexCoord - vec2(uTexel.x, 0.0)).rgb;
+        vec3 minColor = min(color, min(min(n, s), min(e, w)));
+        vec3 maxColor = max(color, max(max(n, s), max(e, w)));
+        vec3 sharp = color + uSharpness * (4.0 * color - n - s - e - w) * 0.25;
+        color = clamp(sharp, minColor, maxColor);
+    }
+
+    outColor = vec4(color, 1.0);
+}
@@ -4,25 +4,42 @@ layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec3 inNormal;
 layout (location = 2) in vec2 inTexCoord;
 
+// Datos por instancia (solo con uInstanced): matriz de modelo, color y (tiempo, cola, capa, textura)
+layout (location = 3) in mat4 inModel;
+layout (location = 7) in vec4 inColor;
+layout (location = 8) in vec4 inParams;
+
 uniform mat4 uPVM;
+uniform mat4 uPV;
 uniform mat4 uModel;
 uniform mat4 uView;
 uniform float uTime;
 uniform bool uAnimateTail;
+uniform bool uInstanced;
+uniform vec4 uColor;
+uniform float uTextureLayer;
+uniform bool useTexture;
 
 out vec2 vTexCoord;
 out vec3 vNormal;
 out vec3 vFragPos;
 out vec3 vViewPos;
+flat out vec4 vColor;
+flat out float vTextureLayer;
+flat out int vUseTexture;
 
 void main()
 {
     vec3 pos    = inPosition;
     vec3 normal = inNormal;
 
-    if (uAnimateTail)
+    mat4  model       = uInstanced ? inModel : uModel;
+    float time        = uInstanced ? inParams.x : uTime;
+    bool  animateTail = uInstanced ? inParams.y > 0.5 : uAnimateTail;
+
+    if (animateTail)
     {
-        float tailStartZ = -4.45;
+        float tailStartZ = -4.45;   // Igual que FISH_TAIL_START_Z: los LOD no colapsan aristas que lo crucen
         vec3 pivot = vec3(-0.263, -0.021, tailStartZ);
 
         if (pos.z < tailStartZ)
@@ -30,7 +47,7 @@ void main()
             float distancia = tailStartZ - pos.z;
             float flex = distancia * 0.4;  // Más lejos = más se mueve
             
-            float angle = sin(uTime * 4.0) * 0.5 * flex;
+            float angle = sin(time * 4.0) * 0.5 * flex;
             
             vec3 p = pos - pivot;
             float c = cos(angle);
@@ -47,10 +64,14 @@ void main()
         }
     }
 
-    vFragPos = vec3(uModel * vec4(pos, 1.0));
-    vNormal  = mat3(transpose(inverse(uModel))) * normal;
+    vFragPos = vec3(model * vec4(pos, 1.0));
+    vNormal  = mat3(transpose(inverse(model))) * normal;
     vViewPos = -vec3(uView[3][0], uView[3][1], uView[3][2]);
 
-    gl_Position = uPVM * vec4(pos, 1.0);
+    gl_Position = uInstanced ? uPV * vec4(vFragPos, 1.0) : uPVM * vec4(pos, 1.0);
     vTexCoord = inTexCoord;
+
+    vColor        = uInstanced ? inColor : uColor;
+    vTextureLayer = uInstanced ? inParams.z : uTextureLayer;
+    vUseTexture   = (uInstanced ? inParams.w > 0.5 : useTexture) ? 1 : 0;
 }
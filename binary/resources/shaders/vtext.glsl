@@ -0,0 +1,16 @@
+#version 330 core
+
+layout (location = 0) in vec2 inPosition;   // Píxeles, origen arriba a la izquierda
+layout (location = 1) in vec2 inTexCoord;
+layout (location = 2) in vec4 inColor;
+
+uniform vec2 uScreen;   // 2 / tamaño del framebuffer
+
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main() {
+    vTexCoord = inTexCoord;
+    vColor = inColor;
+    gl_Position = vec4(inPosition.x * uScreen.x - 1.0, 1.0 - inPosition.y * uScreen.y, 0.0, 1.0);
+}
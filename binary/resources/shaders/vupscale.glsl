@@ -0,0 +1,10 @@
+#version 330 core
+
+// Triángulo que cubre toda la pantalla, sin buffer de vértices (gl_VertexID de 0 a 2)
+out vec2 vTexCoord;
+
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vTexCoord = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,225 @@
+#include "AllocStats.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Parte del hilo actual (tipo trivial: se puede leer desde operator new en cualquier momento)
+static thread_local AllocSubsystem threadSubsystem = ALLOC_OTROS;
+
+AllocStats::Counters AllocStats::counters[ALLOC_SUBSYSTEMS];
+AllocCounters        AllocStats::previous[ALLOC_SUBSYSTEMS];
+AllocCounters        AllocStats::frame[ALLOC_SUBSYSTEMS];
+AllocCheckMode       AllocStats::mode = ALLOC_CHECK_OFF;
+std::atomic<bool>    AllocStats::armed(false);
+unsigned long long   AllocStats::frames = 0;
+unsigned long long   AllocStats::framesWithAllocs = 0;
+int                  AllocStats::logged = 0;
+
+void AllocStats::setThreadSubsystem(AllocSubsystem subsystem) {
+
+    ::threadSubsystem = subsystem;
+
+}
+
+AllocSubsystem AllocStats::threadSubsystem() {
+
+    return ::threadSubsystem;
+
+}
+
+void AllocStats::setCheck(AllocCheckMode mode) {
+
+    AllocStats::mode = mode;
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// Cierra un frame: reservas de cada parte desde el anterior. Pasado el calentamiento, un frame que
+// reserve en el render o la simulación se anota (y con ALLOC_CHECK_LOG se muestra)
+//-----------------------------------------------------------------------------------------------
+void AllocStats::endFrame() {
+
+    for(int s = 0; s < ALLOC_SUBSYSTEMS; s++) {
+        AllocCounters now;
+        now.allocs = counters[s].allocs.load(std::memory_order_relaxed);
+        now.frees  = counters[s].frees.load(std::memory_order_relaxed);
+        now.bytes  = counters[s].bytes.load(std::memory_order_relaxed);
+        frame[s].allocs = now.allocs - previous[s].allocs;
+        frame[s].frees  = now.frees  - previous[s].frees;
+        frame[s].bytes  = now.bytes  - previous[s].bytes;
+        previous[s] = now;
+    }
+
+    frames++;
+    const bool steady = frames > (unsigned long long)ALLOC_WARMUP_FRAMES;
+    if(steady && (frame[ALLOC_RENDER].allocs || frame[ALLOC_SIMULACION].allocs)) {
+        framesWithAllocs++;
+        if(mode == ALLOC_CHECK_LOG && logged < ALLOC_LOG_LIMIT) {
+            char line[256];
+            snprintf(line, sizeof(line), "Reservas en el frame %llu: render %llu (%llu bytes), simulacion %llu (%llu bytes)%s",
+                     frames, frame[ALLOC_RENDER].allocs, frame[ALLOC_RENDER].bytes,
+                     frame[ALLOC_SIMULACION].allocs, frame[ALLOC_SIMULACION].bytes,
+                     ++logged == ALLOC_LOG_LIMIT ? " (no se muestran mas)" : "");
+            std::cout << line << std::endl;
+        }
+    }
+    armed.store(steady && mode == ALLOC_CHECK_ASSERT, std::memory_order_relaxed);
+
+}
+
+AllocCounters AllocStats::lastTotal() {
+
+    AllocCounters sum = AllocCounters();
+    for(int s = 0; s < ALLOC_SUBSYSTEMS; s++) {
+        sum.allocs += frame[s].allocs;
+        sum.frees  += frame[s].frees;
+        sum.bytes  += frame[s].bytes;
+    }
+    return sum;
+
+}
+
+AllocCounters AllocStats::total(AllocSubsystem subsystem) {
+
+    AllocCounters sum;
+    sum.allocs = counters[subsystem].allocs.load(std::memory_order_relaxed);
+    sum.frees  = counters[subsystem].frees.load(std::memory_order_relaxed);
+    sum.bytes  = counters[subsystem].bytes.load(std::memory_order_relaxed);
+    return sum;
+
+}
+
+void AllocStats::printReport() {
+
+    char line[256];
+    std::cout << "---- Reservas de memoria ----" << std::endl;
+    for(int s = 0; s < ALLOC_SUBSYSTEMS; s++) {
+        const AllocCounters sum = total((AllocSubsystem)s);
+        snprintf(line, sizeof(line), "%-10s %10llu reservas  %10llu liberaciones  %12.1f KB",
+                 name((AllocSubsystem)s), sum.allocs, sum.frees, sum.bytes / 1024.0);
+        std::cout << line << std::endl;
+    }
+    if(frames > (unsigned long long)ALLOC_WARMUP_FRAMES) {
+        std::cout << "Frames con reservas tras el calentamiento: " << framesWithAllocs << " de "
+                  << frames - ALLOC_WARMUP_FRAMES << std::endl;
+    }
+
+}
+
+//-----------------------------------------------------------------------------------------
+// Cuenta una reserva en la parte del hilo. Con ALLOC_CHECK_ASSERT, una reserva del render o
+// la simulación en régimen estable aborta aquí mismo (sin iostream, que podría reservar)
+//-----------------------------------------------------------------------------------------
+void AllocStats::countAlloc(size_t bytes) {
+
+    const AllocSubsystem subsystem = ::threadSubsystem;
+    counters[subsystem].allocs.fetch_add(1, std::memory_order_relaxed);
+    counters[subsystem].bytes.fetch_add(bytes, std::memory_order_relaxed);
+    if(armed.load(std::memory_order_relaxed) && (subsystem == ALLOC_RENDER || subsystem == ALLOC_SIMULACION)) {
+        std::fputs(subsystem == ALLOC_RENDER ? "Reserva de memoria en un frame estable (render)\n"
+                                             : "Reserva de memoria en un frame estable (simulacion)\n", stderr);
+        std::abort();
+    }
+
+}
+
+void AllocStats::countFree() {
+
+    counters[::threadSubsystem].frees.fetch_add(1, std::memory_order_relaxed);
+
+}
+
+const char* AllocStats::name(AllocSubsystem subsystem) {
+
+    switch(subsystem) {
+        case ALLOC_OTROS:      return "otros";
+        case ALLOC_CARGA:      return "carga";
+        case ALLOC_RENDER:     return "render";
+        case ALLOC_SIMULACION: return "simulacion";
+        default:               return "?";
+    }
+
+}
+
+bool parseAllocCheckMode(const char *text, AllocCheckMode &mode) {
+
+    if     (std::strcmp(text, "log"   ) == 0) mode = ALLOC_CHECK_LOG;
+    else if(std::strcmp(text, "assert") == 0) mode = ALLOC_CHECK_ASSERT;
+    else return false;
+    return true;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Reserva global: malloc más los contadores. Las variantes de arrays y sin excepciones pasan
+// por aquí; las liberaciones con tamaño (C++14) lo ignoran
+//------------------------------------------------------------------------------------------
+void* operator new(size_t size) {
+
+    void *pointer = std::malloc(size ? size : 1);
+    if(!pointer) throw std::bad_alloc();
+    AllocStats::countAlloc(size);
+    return pointer;
+
+}
+
+void* operator new[](size_t size) {
+
+    return operator new(size);
+
+}
+
+void* operator new(size_t size, const std::nothrow_t &) noexcept {
+
+    void *pointer = std::malloc(size ? size : 1);
+    if(pointer) AllocStats::countAlloc(size);
+    return pointer;
+
+}
+
+void* operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+
+    return operator new(size, tag);
+
+}
+
+void operator delete(void *pointer) noexcept {
+
+    if(!pointer) return;
+    AllocStats::countFree();
+    std::free(pointer);
+
+}
+
+void operator delete[](void *pointer) noexcept {
+
+    operator delete(pointer);
+
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+
+    operator delete(pointer);
+
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+
+    operator delete(pointer);
+
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+
+    operator delete(pointer);
+
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+
+    operator delete(pointer);
+
+}
@@ -0,0 +1,99 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <atomic>
+#include <cstddef>
+
+// Parte del programa a la que se atribuye cada reserva: la del hilo que la hace. Las tareas del
+// sistema de tareas heredan la del hilo que las envía
+enum AllocSubsystem {
+    ALLOC_OTROS,         // Arranque, informes y herramientas (no se comprueba)
+    ALLOC_CARGA,         // Carga de modelos y texturas
+    ALLOC_RENDER,
+    ALLOC_SIMULACION,
+    ALLOC_SUBSYSTEMS
+};
+
+// Qué hacer cuando un frame reserva memoria pasado el calentamiento (--alloc-check)
+enum AllocCheckMode {
+    ALLOC_CHECK_OFF,
+    ALLOC_CHECK_LOG,      // Una línea por frame con reservas (como mucho ALLOC_LOG_LIMIT)
+    ALLOC_CHECK_ASSERT    // Aborta en la propia reserva, para verla en el depurador
+};
+
+// Frames que se dejan crecer a vectores, anillos y cachés antes de empezar a comprobar
+const int ALLOC_WARMUP_FRAMES = 120;
+const int ALLOC_LOG_LIMIT     = 32;
+
+struct AllocCounters {
+    unsigned long long allocs;
+    unsigned long long frees;
+    unsigned long long bytes;   // Bytes pedidos (la liberación no sabe el tamaño)
+};
+
+// Reservas de memoria del programa, contadas desde operator new y operator delete (globales,
+// definidos en AllocStats.cpp). Los contadores por parte son atómicos porque reservan todos los
+// hilos; endFrame() lo llama solo el hilo del render y guarda lo que se reservó desde el frame
+// anterior (de todos los hilos, también el de la simulación)
+class AllocStats {
+
+    public:
+
+        static void           setThreadSubsystem(AllocSubsystem subsystem);
+        static AllocSubsystem threadSubsystem();
+
+        static void setCheck(AllocCheckMode mode);
+        static void endFrame();
+
+        static const AllocCounters& last(AllocSubsystem subsystem) { return frame[subsystem]; }
+        static AllocCounters        lastTotal();
+        static AllocCounters        total(AllocSubsystem subsystem);
+
+        static void printReport();
+
+        // Desde operator new y operator delete
+        static void countAlloc(size_t bytes);
+        static void countFree ();
+
+        static const char* name(AllocSubsystem subsystem);
+
+    private:
+
+        struct Counters {
+            std::atomic<unsigned long long> allocs;
+            std::atomic<unsigned long long> frees;
+            std::atomic<unsigned long long> bytes;
+            char                            pad[64 - 3 * sizeof(unsigned long long)];   // Una línea de caché por parte
+        };
+
+        static Counters           counters[ALLOC_SUBSYSTEMS];
+        static AllocCounters      previous[ALLOC_SUBSYSTEMS];
+        static AllocCounters      frame[ALLOC_SUBSYSTEMS];
+        static AllocCheckMode     mode;
+        static std::atomic<bool>  armed;
+        static unsigned long long frames;
+        static unsigned long long framesWithAllocs;
+        static int                logged;
+
+};
+
+// Cambia la parte del hilo mientras dura el ámbito
+class AllocScope {
+
+    public:
+
+        explicit AllocScope(AllocSubsystem subsystem) : saved(AllocStats::threadSubsystem()) { AllocStats::setThreadSubsystem(subsystem); }
+        ~AllocScope() { AllocStats::setThreadSubsystem(saved); }
+
+    private:
+
+        AllocSubsystem saved;
+
+        AllocScope(const AllocScope &);
+        AllocScope& operator=(const AllocScope &);
+
+};
+
+bool parseAllocCheckMode(const char *text, AllocCheckMode &mode);
+
+#endif /* ALLOCSTATS_H */
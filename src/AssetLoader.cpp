@@ -0,0 +1,408 @@
+#include "AssetLoader.h"
+#include "Trace.h"
+#include "RenderStats.h"
+#include "MemoryRegistry.h"
+#include "stb_image.h"
+
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+//-------------------------------------------------------------------------
+// La decodificación se reparte en el sistema de tareas compartido del programa
+//-------------------------------------------------------------------------
+AssetLoader::AssetLoader(JobSystem &jobs) : jobs(jobs), totalTime(0.0), s3tcSupported(false) {
+
+}
+
+//----------------------------------------
+// Registra un modelo para cargarlo después
+//----------------------------------------
+void AssetLoader::addModel(Model *model, const char *modelFile) {
+
+    Asset asset = Asset();
+    asset.type  = ASSET_MODEL;
+    asset.file  = modelFile;
+    asset.model = model;
+    assets.push_back(std::move(asset));
+
+}
+
+//------------------------------------------
+// Registra una textura para cargarla después
+//------------------------------------------
+void AssetLoader::addTexture(GLuint *texture, const char *textureFile) {
+
+    Asset asset   = Asset();
+    asset.type    = ASSET_TEXTURE;
+    asset.file    = textureFile;
+    asset.texture = texture;
+    assets.push_back(std::move(asset));
+
+}
+
+//------------------------------------------------------------------
+// Registra las capas de un array de texturas (cada capa es un recurso)
+//------------------------------------------------------------------
+void AssetLoader::addTextureArray(TextureArray *array) {
+
+    for(int i = 0; i < array->layerCount(); i++) {
+        Asset asset = Asset();
+        asset.type  = ASSET_TEXTURE_LAYER;
+        asset.file  = array->layerFile(i);
+        asset.array = array;
+        asset.layer = i;
+        assets.push_back(std::move(asset));
+    }
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Registra la cadena de LOD de un modelo: lods[i] recibe el nivel i + 1 (cada uno con la mitad
+// de triángulos). Se carga del .lod cocinado o, si no existe, se simplifica al arrancar
+//---------------------------------------------------------------------------------------------
+void AssetLoader::addModelLods(Model *lods, int levels, const char *modelFile, float lockPlaneZ) {
+
+    Asset asset      = Asset();
+    asset.type       = ASSET_MODEL_LODS;
+    asset.file       = modelFile;
+    asset.lods       = lods;
+    asset.levels     = levels;
+    asset.lockPlaneZ = lockPlaneZ;
+    assets.push_back(std::move(asset));
+
+}
+
+//------------------------------------------------------------------------------------------
+// Decodifica todos los recursos en paralelo y los sube a la GPU según van estando listos
+//------------------------------------------------------------------------------------------
+void AssetLoader::loadAll() {
+
+    startTime = std::chrono::steady_clock::now();
+    uploadOrder.clear();
+    ready.clear();
+    s3tcSupported = GLEW_EXT_texture_compression_s3tc != 0;
+
+    pendingLayers.clear();
+    for(const auto& asset : assets) {
+        if(asset.type == ASSET_TEXTURE_LAYER) pendingLayers[asset.array]++;
+    }
+
+    JobCounter decoded;
+    for(size_t i = 0; i < assets.size(); i++) {
+        jobs.submit([this, i] {
+            decodeAsset(i);
+            {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                ready.push_back(i);
+            }
+            readyCond.notify_one();
+        }, &decoded);
+    }
+
+ // El hilo del contexto sube cada recurso en cuanto termina su decodificación
+    GLuint pbo;
+    glGenBuffers(1, &pbo);
+    for(size_t n = 0; n < assets.size(); n++) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCond.wait(lock, [this] { return !ready.empty(); });
+            index = ready.front();
+            ready.pop_front();
+        }
+        if((assets[index].type == ASSET_MODEL || assets[index].type == ASSET_MODEL_LODS) && !assets[index].ok) {
+            jobs.wait(decoded);
+            std::cout << "El fichero " << assets[index].file << " no se puede abrir." << std::endl;
+            std::cin.get();
+            exit(1);
+        }
+        uploadAsset(index, pbo);
+        uploadOrder.push_back(index);
+    }
+    glDeleteBuffers(1, &pbo);
+    MemoryRegistry::remove(MEMORIA_BUFFER, pbo);
+
+    jobs.wait(decoded);
+    totalTime = elapsedMs();
+
+}
+
+//----------------------------------------------------------------------------------
+// Paso de cocinado: genera el .dds de cada textura registrada (no necesita contexto)
+//----------------------------------------------------------------------------------
+bool AssetLoader::cookTextures(bool compress) {
+
+    std::vector<char> results(assets.size(), 1);
+    {
+        JobCounter cooked;
+        for(size_t i = 0; i < assets.size(); i++) {
+            if(assets[i].type == ASSET_MODEL || assets[i].type == ASSET_MODEL_LODS) continue;
+            jobs.submit([this, i, compress, &results] {
+                std::string dstFile = TextureCooker::cookedFile(assets[i].file);
+                int size = assets[i].type == ASSET_TEXTURE_LAYER ? assets[i].array->getLayerSize() : 0;
+                results[i] = TextureCooker::cook(assets[i].file.c_str(), dstFile.c_str(), compress, size);
+            }, &cooked);
+        }
+        jobs.wait(cooked);
+    }
+
+    bool ok = true;
+    for(size_t i = 0; i < assets.size(); i++) {
+        if(assets[i].type == ASSET_MODEL || assets[i].type == ASSET_MODEL_LODS) continue;
+        std::cout << (results[i] ? "Cocinada: " : "Error al cocinar: ") << TextureCooker::cookedFile(assets[i].file) << std::endl;
+        ok = ok && results[i];
+    }
+    return ok;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Paso de cocinado de modelos: simplifica cada cadena de LOD registrada y guarda su fichero .lod
+//------------------------------------------------------------------------------------------
+bool AssetLoader::cookModels() {
+
+    std::vector<char> results(assets.size(), 1);
+    {
+        JobCounter cooked;
+        for(size_t i = 0; i < assets.size(); i++) {
+            if(assets[i].type != ASSET_MODEL_LODS) continue;
+            jobs.submit([this, i, &results] {
+                ModelData data;
+                std::vector<ModelData> lods;
+                results[i] = Model::loadModelData(assets[i].file.c_str(), data);
+                if(!results[i]) return;
+                MeshSimplifier::buildLods(data, assets[i].levels, assets[i].lockPlaneZ, lods);
+                results[i] = MeshSimplifier::saveLods(MeshSimplifier::lodFile(assets[i].file).c_str(), lods);
+            }, &cooked);
+        }
+        jobs.wait(cooked);
+    }
+
+    bool ok = true;
+    for(size_t i = 0; i < assets.size(); i++) {
+        if(assets[i].type != ASSET_MODEL_LODS) continue;
+        std::cout << (results[i] ? "Cocinado: " : "Error al cocinar: ") << MeshSimplifier::lodFile(assets[i].file) << std::endl;
+        ok = ok && results[i];
+    }
+    return ok;
+
+}
+
+//----------------------------------------------------------------
+// Informe de arranque: tiempos por recurso y camino crítico total
+//----------------------------------------------------------------
+void AssetLoader::printReport() const {
+
+    if(uploadOrder.empty()) return;
+
+    char line[256];
+    std::cout << "---- Carga de recursos (" << jobs.size() << " hilos) ----" << std::endl;
+    std::snprintf(line, sizeof(line), "%-40s %10s %10s %10s %10s", "Recurso", "Decod(ms)", "Espera(ms)", "Subida(ms)", "Fin(ms)");
+    std::cout << line << std::endl;
+
+    double decodeSum = 0.0;
+    double uploadSum = 0.0;
+    for(size_t index : uploadOrder) {
+        const Asset &asset = assets[index];
+        double decode = asset.decodeEnd - asset.decodeStart;
+        double upload = asset.uploadEnd - asset.uploadStart;
+        decodeSum += decode;
+        uploadSum += upload;
+        std::string name = !asset.useCooked ? asset.file :
+                           asset.type == ASSET_MODEL_LODS ? MeshSimplifier::lodFile(asset.file) : TextureCooker::cookedFile(asset.file);
+        std::snprintf(line, sizeof(line), "%-40s %10.2f %10.2f %10.2f %10.2f", name.c_str(),
+                      decode, asset.uploadStart - asset.decodeEnd, upload, asset.uploadEnd);
+        std::cout << line << std::endl;
+    }
+
+ // Camino crítico: desde la última subida se retrocede mientras la subida tuvo que esperar a
+ // la anterior; cuando esperó a su propia decodificación el camino empieza en esa decodificación
+    std::vector<size_t> path;
+    size_t pos = uploadOrder.size() - 1;
+    for(;;) {
+        size_t index = uploadOrder[pos];
+        path.push_back(index);
+        if(pos == 0) break;
+        const Asset &previous = assets[uploadOrder[pos - 1]];
+        if(assets[index].decodeEnd >= previous.uploadEnd) break;
+        pos--;
+    }
+    std::reverse(path.begin(), path.end());
+
+    const Asset &first = assets[path.front()];
+    std::cout << "Camino crítico: decodificar " << first.file;
+    for(size_t index : path) std::cout << " -> subir " << assets[index].file;
+    std::cout << std::endl;
+
+    std::snprintf(line, sizeof(line), "Total: %.2f ms (decodificación secuencial %.2f ms, subidas %.2f ms, camino crítico %.2f ms)",
+                  totalTime, decodeSum, uploadSum, assets[path.back()].uploadEnd - first.decodeStart);
+    std::cout << line << std::endl;
+
+}
+
+//----------------------------------------------------------
+// Decodifica una imagen con stb_image (seguro entre hilos)
+//----------------------------------------------------------
+bool AssetLoader::decodeTexture(const char *textureFile, TextureData &data) {
+
+    data.pixels = stbi_load(textureFile, &data.width, &data.height, &data.channels, 0);
+    return data.pixels != NULL;
+
+}
+
+//-------------------------------------------------------------------------------------
+// Crea la textura en la GPU; si se indica un PBO los píxeles se copian a través de él.
+// name es el fichero de la imagen, para el registro de memoria
+//-------------------------------------------------------------------------------------
+GLuint AssetLoader::uploadTexture(const TextureData &data, GLuint pbo, const char *name) {
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    if(!data.pixels) return textureID;
+
+    GLenum format = GL_RGB;
+    if (data.channels == 1) format = GL_RED;
+    else if (data.channels == 3) format = GL_RGB;
+    else if (data.channels == 4) format = GL_RGBA;
+
+    const void *src = data.pixels;
+    if(pbo) {
+        size_t size = (size_t)data.width * data.height * data.channels;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        MemoryRegistry::add(MEMORIA_BUFFER, pbo, MEMORIA_TRANSFERENCIA, size, "pixeles", "AssetLoader", "PBO de subida");
+        void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if(dst) {
+            std::memcpy(dst, data.pixels, size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            src = (void *)0;
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            pbo = 0;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, data.width, data.height, 0, format, GL_UNSIGNED_BYTE, src);
+    RenderStats::countBufferBytes((size_t)data.width * data.height * data.channels);
+    if(pbo) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    MemoryRegistry::add(MEMORIA_TEXTURA, textureID, MEMORIA_TEXTURAS, MemoryRegistry::textureBytes(data.width, data.height, 1, format, 0),
+                        MemoryRegistry::formatName(format), "AssetLoader", name);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return textureID;
+
+}
+
+//-----------------------------------------------------------------------------
+// Carga síncrona de una textura: decodifica y sube en este hilo (sin PBO). Con
+// un fichero que no se puede leer devuelve una textura vacía
+//-----------------------------------------------------------------------------
+GLuint AssetLoader::loadTexture(const char *textureFile) {
+
+    TextureData data;
+    if(!decodeTexture(textureFile, data)) {
+        std::cerr << "Error al cargar textura: " << textureFile << std::endl;
+    }
+    GLuint textureID = uploadTexture(data, 0, textureFile);
+    freeTexture(data);
+    return textureID;
+
+}
+
+//------------------------------------
+// Libera los píxeles de una imagen
+//------------------------------------
+void AssetLoader::freeTexture(TextureData &data) {
+
+    if(data.pixels) stbi_image_free(data.pixels);
+    data.pixels = NULL;
+
+}
+
+double AssetLoader::elapsedMs() const {
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+}
+
+//-----------------------------------------------------
+// Trabajo de CPU de un recurso (en un hilo del conjunto)
+//-----------------------------------------------------
+void AssetLoader::decodeAsset(size_t index) {
+
+    Asset &asset = assets[index];
+    TRACE_SCOPE(Trace::intern("decodificar " + asset.file));
+    asset.decodeStart = elapsedMs();
+    if(asset.type == ASSET_MODEL) {
+        asset.ok = Model::loadModelData(asset.file.c_str(), asset.modelData);
+    } else if(asset.type == ASSET_MODEL_LODS) {
+        std::string lodFile = MeshSimplifier::lodFile(asset.file);
+        asset.useCooked = MeshSimplifier::loadLods(lodFile.c_str(), asset.lodData) && (int)asset.lodData.size() == asset.levels;
+        if(asset.useCooked) {
+            asset.ok = true;
+        } else {
+            std::cerr << "Sin LOD cocinados para " << asset.file << ", se simplifica al arrancar" << std::endl;
+            asset.ok = Model::loadModelData(asset.file.c_str(), asset.modelData);
+            if(asset.ok) MeshSimplifier::buildLods(asset.modelData, asset.levels, asset.lockPlaneZ, asset.lodData);
+            asset.modelData = ModelData();
+        }
+    } else if(asset.type == ASSET_TEXTURE_LAYER) {
+        asset.ok = asset.array->decodeLayer(asset.layer, s3tcSupported);
+        asset.useCooked = asset.array->layerCooked(asset.layer);
+    } else {
+     // Se prefiere la versión cocinada: solo hay que proyectarla y traer sus páginas a memoria
+        std::string cookedFile = TextureCooker::cookedFile(asset.file);
+        asset.useCooked = TextureCooker::openCooked(cookedFile.c_str(), asset.cooked) &&
+                          (!asset.cooked.compressed || s3tcSupported);
+        if(asset.useCooked) {
+            volatile unsigned char touch = 0;
+            for(size_t offset = 0; offset < asset.cooked.file.size(); offset += 4096) touch ^= asset.cooked.file.data()[offset];
+            (void)touch;
+            asset.ok = true;
+        } else {
+            asset.cooked = CookedTexture();
+            asset.ok = decodeTexture(asset.file.c_str(), asset.textureData);
+        }
+    }
+    asset.decodeEnd = elapsedMs();
+
+}
+
+//-------------------------------------------------------
+// Subida a la GPU de un recurso (en el hilo del contexto)
+//-------------------------------------------------------
+void AssetLoader::uploadAsset(size_t index, GLuint pbo) {
+
+    Asset &asset = assets[index];
+    TRACE_SCOPE(Trace::intern("subir " + asset.file));
+    asset.uploadStart = elapsedMs();
+    if(asset.type == ASSET_MODEL) {
+        asset.model->uploadModel(asset.modelData, asset.file.c_str());
+        asset.modelData = ModelData();
+    } else if(asset.type == ASSET_MODEL_LODS) {
+        for(int level = 0; level < asset.levels; level++) asset.lods[level].uploadModel(asset.lodData[level], asset.file.c_str());
+        std::vector<ModelData>().swap(asset.lodData);
+    } else if(asset.type == ASSET_TEXTURE_LAYER) {
+     // El array se crea de una vez cuando todas sus capas están listas
+        if(--pendingLayers[asset.array] == 0) asset.array->upload();
+    } else {
+        if(asset.useCooked) {
+            *asset.texture = TextureCooker::uploadCooked(asset.cooked, asset.file.c_str());
+            asset.cooked = CookedTexture();
+        } else {
+            if(!asset.ok) std::cerr << "Error al cargar textura: " << asset.file << std::endl;
+            *asset.texture = uploadTexture(asset.textureData, pbo, asset.file.c_str());
+            freeTexture(asset.textureData);
+        }
+    }
+    asset.uploadEnd = elapsedMs();
+
+}
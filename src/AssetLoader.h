@@ -0,0 +1,94 @@
+#ifndef ASSETLOADER_H
+#define ASSETLOADER_H
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <GL/glew.h>
+
+#include "Model.h"
+#include "TextureCooker.h"
+#include "TextureArray.h"
+#include "MeshSimplifier.h"
+#include "JobSystem.h"
+
+// Imagen decodificada en memoria de CPU (píxeles reservados por stb_image)
+struct TextureData {
+    int            width;
+    int            height;
+    int            channels;
+    unsigned char *pixels;
+};
+
+// Carga en paralelo los modelos y texturas del arranque: la decodificación se hace
+// en el sistema de tareas y la subida a la GPU en el hilo que posee el contexto
+class AssetLoader {
+
+    public:
+
+        explicit AssetLoader(JobSystem &jobs);
+
+        void addModel  (Model  *model  , const char *modelFile);
+        void addTexture(GLuint *texture, const char *textureFile);
+        void addTextureArray(TextureArray *array);
+        void addModelLods(Model *lods, int levels, const char *modelFile, float lockPlaneZ = NO_LOCK_PLANE);
+        void loadAll();
+        bool cookTextures(bool compress);
+        bool cookModels();
+        void printReport() const;
+
+        static bool   decodeTexture(const char *textureFile, TextureData &data);
+        static GLuint uploadTexture(const TextureData &data, GLuint pbo = 0, const char *name = NULL);
+        static void   freeTexture  (TextureData &data);
+        static GLuint loadTexture  (const char *textureFile);
+
+    private:
+
+        enum AssetType { ASSET_MODEL, ASSET_MODEL_LODS, ASSET_TEXTURE, ASSET_TEXTURE_LAYER };
+
+        struct Asset {
+            AssetType   type;
+            std::string file;
+            Model      *model;
+            GLuint     *texture;
+            TextureArray *array;       // Solo en capas: array al que pertenecen y su índice
+            int         layer;
+            Model      *lods;          // Solo en cadenas de LOD: modelos destino, uno por nivel
+            int         levels;
+            float       lockPlaneZ;
+            ModelData   modelData;
+            std::vector<ModelData> lodData;
+            TextureData textureData;
+            CookedTexture cooked;      // Versión cocinada (.dds/.lod) si existe y se puede usar
+            bool        useCooked;
+            bool        ok;
+            double      decodeStart;   // Tiempos en ms desde el inicio de loadAll()
+            double      decodeEnd;
+            double      uploadStart;
+            double      uploadEnd;
+        };
+
+        JobSystem               &jobs;
+        std::vector<Asset>       assets;
+        std::vector<size_t>      uploadOrder;
+        double                   totalTime;
+        bool                     s3tcSupported;
+        std::map<TextureArray *, size_t> pendingLayers;
+        std::chrono::steady_clock::time_point startTime;
+
+        std::mutex               readyMutex;
+        std::condition_variable  readyCond;
+        std::deque<size_t>       ready;
+
+        double elapsedMs() const;
+        void   decodeAsset(size_t index);
+        void   uploadAsset(size_t index, GLuint pbo);
+
+};
+
+#endif /* ASSETLOADER_H */
@@ -0,0 +1,101 @@
+#include "BatchRender.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// Un rango de frames y el resultado del proceso que lo dibuja
+struct BatchRange {
+    int    first;
+    int    count;
+    int    result;   // Valor de std::system (0: correcto)
+    double ms;       // Tiempo del proceso, incluida la carga de recursos y el avance inicial
+};
+
+//-----------------------------------------------------------------------------------------------
+// Lanza los procesos, espera a todos y muestra el ritmo de cada uno y el total. La salida de cada
+// proceso va a <prefijo>_rango<k>.log para no mezclarse. Los últimos rangos tardan algo más en
+// empezar porque simulan más frames sin dibujar, pero simular es mucho más barato que dibujar
+//-----------------------------------------------------------------------------------------------
+int runBatch(const char *program, const Options &options) {
+
+    typedef std::chrono::steady_clock Clock;
+
+    if(options.captureFile) {
+        std::cerr << "--capture no se puede repartir entre procesos: usar --dump-frames con --batch" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if(options.scenarioFile || options.replayFile) {
+        std::cerr << "--scenario y --replay miden una sola pasada: no se pueden usar con --batch" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const int          contexts = std::max(1, std::min(options.batch, options.frames));
+    const char        *prefix   = options.dumpFrames ? options.dumpFrames : "frame";
+    const unsigned int seed     = options.seed ? options.seed : 1;
+
+    // Los procesos comparten la máquina: cada uno con su parte de los núcleos (contando su hilo
+    // principal) para que los tiempos de cada rango no midan hilos de más compitiendo entre sí
+    const int cores   = std::max(1, (int)std::thread::hardware_concurrency());
+    const int workers = options.workers > 0 ? options.workers : std::max(1, cores / contexts - 1);
+
+    std::vector<BatchRange> ranges(contexts);
+    int first = options.firstFrame;
+    for(int k = 0; k < contexts; k++) {
+        ranges[k].first  = first;
+        ranges[k].count  = options.frames / contexts + (k < options.frames % contexts ? 1 : 0);
+        ranges[k].result = -1;
+        ranges[k].ms     = 0.0;
+        first += ranges[k].count;
+    }
+
+    std::cout << "Dibujando " << options.frames << " frames de " << options.width << "x" << options.height
+              << " en " << contexts << " contextos sin ventana de " << workers << " hilos de tareas (" << prefix << "_NNNNN.ppm)" << std::endl;
+
+    const Clock::time_point begin = Clock::now();
+    std::vector<std::thread> threads;
+    for(int k = 0; k < contexts; k++) {
+        char command[2048];
+        snprintf(command, sizeof(command),
+                 "\"%s\" --headless --size %dx%d --seed %u --fixed-dt %.17g --first-frame %d --frames %d --workers %d --dump-frames \"%s\" > \"%s_rango%d.log\" 2>&1",
+                 program, options.width, options.height, seed, options.fixedDt, ranges[k].first, ranges[k].count, workers, prefix, prefix, k);
+        BatchRange &range = ranges[k];
+#ifdef _WIN32
+        // cmd /c quita la primera y la última comilla de la orden: se envuelve entera
+        std::string line = std::string("\"") + command + "\"";
+#else
+        std::string line(command);
+#endif
+        threads.emplace_back([&range, line] {
+            const Clock::time_point start = Clock::now();
+            range.result = std::system(line.c_str());
+            range.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        });
+    }
+    for(auto& thread : threads) thread.join();
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+    bool ok = true;
+    char line[256];
+    std::cout << "---- Render por lotes ----" << std::endl;
+    for(int k = 0; k < contexts; k++) {
+        const BatchRange &range = ranges[k];
+        snprintf(line, sizeof(line), "Rango %2d: frames %5d-%5d  %9.1f ms  %7.1f fps  %s", k, range.first, range.first + range.count - 1,
+                 range.ms, range.count * 1000.0 / range.ms, range.result == 0 ? "correcto" : "ERROR");
+        std::cout << line << std::endl;
+        if(range.result != 0) {
+            std::cerr << "El rango " << k << " ha fallado; ver " << prefix << "_rango" << k << ".log" << std::endl;
+            ok = false;
+        }
+    }
+    snprintf(line, sizeof(line), "Total: %d frames en %.1f ms (%.1f fps)", options.frames, totalMs, options.frames * 1000.0 / totalMs);
+    std::cout << line << std::endl;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -0,0 +1,14 @@
+#ifndef BATCHRENDER_H
+#define BATCHRENDER_H
+
+#include "Options.h"
+
+// Render por lotes de una secuencia de imágenes: los frames [first-frame, first-frame + frames) se
+// reparten en options.batch rangos seguidos y cada rango se dibuja en su propio contexto sin
+// ventana, en paralelo con los demás. Todo el estado del render es global, así que cada contexto
+// es un proceso de este mismo programa (--headless --first-frame), lanzado y esperado desde un
+// hilo; cada uno avanza la simulación determinista hasta el inicio de su rango y guarda sus
+// imágenes con la numeración global
+int runBatch(const char *program, const Options &options);
+
+#endif /* BATCHRENDER_H */
@@ -0,0 +1,154 @@
+#include "DynamicResolution.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// Peso de cada medida nueva en la media móvil, y fracción del presupuesto por debajo de la cual
+// se sube la escala (la banda intermedia evita que oscile entre dos pasos)
+const double DYNRES_SMOOTHING = 0.1;
+const double DYNRES_RAISE_BELOW = 0.8;
+
+DynamicResolution::DynamicResolution() : budgetMs(0.0), minScale(1.0f), maxScale(1.0f), scale(1.0f), avgMs(0.0),
+                                         framesSinceChange(0), gpuTiming(false), next(0) {
+
+    for(int i = 0; i < DYNRES_QUERIES; i++) {
+        queries[i][0] = 0;
+        queries[i][1] = 0;
+        pending[i] = false;
+    }
+    stats = DynResStats();
+
+}
+
+//------------------------------------------------------------------------------------------
+// Presupuesto de la escena (ms) y límites de la escala. Se empieza en la escala máxima
+//------------------------------------------------------------------------------------------
+void DynamicResolution::init(double budgetMs, float minScale, float maxScale) {
+
+    this->budgetMs = budgetMs;
+    this->maxScale = std::min(std::max(maxScale, DYNRES_SCALE_STEP), 1.0f);
+    this->minScale = std::min(std::max(minScale, DYNRES_SCALE_STEP), this->maxScale);
+    scale     = this->maxScale;
+    avgMs     = 0.0;
+    lastFrame = Clock::now();
+
+    gpuTiming = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if(gpuTiming) glGenQueries(2 * DYNRES_QUERIES, &queries[0][0]);
+
+    stats = DynResStats();
+    stats.scale       = scale;
+    stats.lowestScale = scale;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Marca el inicio de la escena. Primero recoge las medidas que ya estén listas (sin esperar)
+//------------------------------------------------------------------------------------------
+void DynamicResolution::beginScene() {
+
+    if(!gpuTiming) {
+        Clock::time_point now = Clock::now();
+        update(std::chrono::duration<double, std::milli>(now - lastFrame).count());
+        lastFrame = now;
+        return;
+    }
+
+    collect();
+    if(pending[next]) return;   // Aún sin leer: este frame no se mide
+    glQueryCounter(queries[next][0], GL_TIMESTAMP);
+
+}
+
+void DynamicResolution::endScene() {
+
+    if(!gpuTiming || pending[next]) return;
+    glQueryCounter(queries[next][1], GL_TIMESTAMP);
+    pending[next] = true;
+    next = (next + 1) % DYNRES_QUERIES;
+
+}
+
+//---------------------------------------------------------------------------
+// Tamaño del framebuffer interno para una ventana de width x height
+//---------------------------------------------------------------------------
+void DynamicResolution::renderSize(int width, int height, int &renderWidth, int &renderHeight) const {
+
+    renderWidth  = std::max(1, (int)std::lround(width  * scale));
+    renderHeight = std::max(1, (int)std::lround(height * scale));
+
+}
+
+void DynamicResolution::printReport() const {
+
+    char line[256];
+    std::cout << "---- Resolucion dinamica (" << (gpuTiming ? "tiempo de GPU" : "tiempo de CPU") << ") ----" << std::endl;
+    snprintf(line, sizeof(line), "Presupuesto %.2f ms, escena %.2f ms de media; escala %.2f (minima %.2f), %llu cambios en %llu frames",
+             budgetMs, stats.avgMs, stats.scale, stats.lowestScale, stats.changes, stats.frames);
+    std::cout << line << std::endl;
+
+}
+
+//-----------------------------------------------------------------------------------
+// Lee las medidas terminadas en orden; se para en la primera que aún no esté disponible
+//-----------------------------------------------------------------------------------
+void DynamicResolution::collect() {
+
+    for(int k = 0; k < DYNRES_QUERIES; k++) {
+        int slot = (next + k) % DYNRES_QUERIES;
+        if(!pending[slot]) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) return;
+
+        GLuint64 start = 0;
+        GLuint64 end   = 0;
+        glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+        pending[slot] = false;
+        update((end - start) / 1.0e6);
+    }
+
+}
+
+//------------------------------------------------------------------------------------------
+// Nueva medida: si la media se pasa del presupuesto se baja la escala de una vez lo necesario;
+// si sobra bastante se sube un solo paso. La escala se redondea a DYNRES_SCALE_STEP
+//------------------------------------------------------------------------------------------
+void DynamicResolution::update(double ms) {
+
+    stats.frames++;
+    avgMs = avgMs == 0.0 ? ms : avgMs + (ms - avgMs) * DYNRES_SMOOTHING;
+    stats.avgMs = avgMs;
+    if(++framesSinceChange < DYNRES_COOLDOWN || budgetMs <= 0.0) return;
+
+    float target = scale;
+    if(avgMs > budgetMs) {
+        target = scale * (float)std::sqrt(budgetMs / avgMs);
+        target = std::floor(target / DYNRES_SCALE_STEP) * DYNRES_SCALE_STEP;
+    } else if(avgMs < budgetMs * DYNRES_RAISE_BELOW) {
+        target = scale + DYNRES_SCALE_STEP;
+    }
+    target = std::min(std::max(target, minScale), maxScale);
+    if(std::fabs(target - scale) < DYNRES_SCALE_STEP * 0.5f) return;
+
+    // La media se traslada a la escala nueva para no reaccionar otra vez a las medidas viejas
+    avgMs *= (target * target) / (scale * scale);
+    scale = target;
+    framesSinceChange = 0;
+    stats.changes++;
+    stats.scale = scale;
+    stats.lowestScale = std::min(stats.lowestScale, scale);
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+DynamicResolution::~DynamicResolution() {
+
+    if(queries[0][0]) glDeleteQueries(2 * DYNRES_QUERIES, &queries[0][0]);
+
+}
@@ -0,0 +1,69 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <chrono>
+#include <GL/glew.h>
+
+// Frames cuya medida de la escena en la GPU puede estar pendiente a la vez
+const int DYNRES_QUERIES = 4;
+
+// Paso en que se redondea la escala (cada cambio reserva de nuevo el framebuffer interno) y frames
+// mínimos entre cambios, para que lleguen medidas ya hechas con la escala nueva
+const float DYNRES_SCALE_STEP = 0.05f;
+const int   DYNRES_COOLDOWN   = 15;
+
+struct DynResStats {
+    unsigned long long frames;
+    unsigned long long changes;
+    float              scale;       // Escala actual (lado del framebuffer interno / lado de la ventana)
+    float              lowestScale;
+    double             avgMs;       // Media móvil del tiempo medido de la escena
+};
+
+// Resolución dinámica: ajusta la escala del framebuffer interno entre [minScale, maxScale] para que
+// la escena quepa en budgetMs. Se mide con consultas GL_TIMESTAMP alrededor de la escena, leídas
+// sin esperar unos frames después; sin consultas de tiempo se usa el tiempo entre frames de la CPU.
+// El número de píxeles es proporcional al coste, así que la escala va con la raíz del exceso
+class DynamicResolution {
+
+    public:
+
+        typedef std::chrono::steady_clock Clock;
+
+        DynamicResolution();
+
+        void init      (double budgetMs, float minScale, float maxScale = 1.0f);
+        void beginScene();
+        void endScene  ();
+        void renderSize(int width, int height, int &renderWidth, int &renderHeight) const;
+
+        float              getScale()    const { return scale; }
+        bool               usesGpuTime() const { return gpuTiming; }
+        const DynResStats& getStats()    const { return stats; }
+        void               printReport() const;
+
+        virtual ~DynamicResolution();
+
+    private:
+
+        double            budgetMs;
+        float             minScale;
+        float             maxScale;
+        float             scale;
+        double            avgMs;             // 0: aún sin medidas
+        int               framesSinceChange;
+
+        bool              gpuTiming;
+        GLuint            queries[DYNRES_QUERIES][2];   // Inicio y fin de la escena
+        bool              pending[DYNRES_QUERIES];
+        int               next;
+        Clock::time_point lastFrame;
+
+        DynResStats       stats;
+
+        void collect();
+        void update (double ms);
+
+};
+
+#endif /* DYNAMICRESOLUTION_H */
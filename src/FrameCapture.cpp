@@ -0,0 +1,235 @@
+#include "FrameCapture.h"
+#include "Trace.h"
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+FrameCapture::FrameCapture() : active(false), file(NULL), toStdout(false), width(0), height(0), frameSize(0), next(0),
+                               calls(0), stopping(false), bytesWritten(0) {
+
+    for(int i = 0; i < FRAME_CAPTURE_BUFFERS; i++) {
+        pbos[i]   = 0;
+        fences[i] = 0;
+    }
+    stats = FrameCaptureStats();
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Empieza a grabar frames de width x height en output ("-" es la salida estándar). En ese caso los
+// mensajes de std::cout pasan a la salida de errores para no mezclarse con los píxeles
+//------------------------------------------------------------------------------------------------
+bool FrameCapture::start(const char *output, int width, int height) {
+
+    toStdout = std::strcmp(output, "-") == 0;
+    if(toStdout) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        std::cout.rdbuf(std::cerr.rdbuf());
+        file = stdout;
+    } else {
+        file = fopen(output, "wb");
+        if(!file) {
+            std::cerr << "No se puede crear el fichero de captura " << output << std::endl;
+            return false;
+        }
+    }
+
+    this->width  = width;
+    this->height = height;
+    frameSize    = (size_t)width * height * 3;
+
+    glGenBuffers(FRAME_CAPTURE_BUFFERS, pbos);
+    for(int i = 0; i < FRAME_CAPTURE_BUFFERS; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, NULL, GL_STREAM_READ);
+        MemoryRegistry::add(MEMORIA_BUFFER, pbos[i], MEMORIA_TRANSFERENCIA, frameSize, "RGB8", "FrameCapture", "lectura de frames");
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    frames.assign(FRAME_CAPTURE_QUEUE, std::vector<unsigned char>(frameSize));
+    for(auto& frame : frames) empty.push_back(&frame);
+    MemoryRegistry::add(MEMORIA_HOST, (unsigned long long)(size_t)this, MEMORIA_CPU, frameSize * FRAME_CAPTURE_QUEUE, "RGB8", "FrameCapture", "cola de frames");
+    stopping = false;
+    writer   = std::thread(&FrameCapture::writerLoop, this);
+    active   = true;
+
+    std::cout << "Capturando " << width << "x" << height << " RGB en " << (toStdout ? "la salida estandar" : output) << std::endl;
+    return true;
+
+}
+
+//---------------------------------------------------------------------------------------------------
+// Pide la lectura del frame recién dibujado en framebuffer (0: el de la ventana, antes del swap) y
+// recoge la que se pidió hace FRAME_CAPTURE_BUFFERS frames. Nunca espera: si esa lectura no ha
+// terminado, o si el escritor no tiene sitio, el frame se descarta y se cuenta
+//---------------------------------------------------------------------------------------------------
+void FrameCapture::capture(GLuint framebuffer, int width, int height) {
+
+    if(!active) return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if(width != this->width || height != this->height) {
+        stats.droppedSize++;
+    } else if(fences[next] && !collect(next, false)) {
+        stats.droppedGpu++;
+    } else {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glReadBuffer(framebuffer ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next]);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next = (next + 1) % FRAME_CAPTURE_BUFFERS;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    calls++;
+    stats.avgCostMs += (ms - stats.avgCostMs) / (double)calls;
+    stats.maxCostMs  = std::max(stats.maxCostMs, ms);
+
+}
+
+//------------------------------------------------------------------------------
+// Recoge las lecturas pendientes (esperándolas), vacía la cola y cierra la salida
+//------------------------------------------------------------------------------
+void FrameCapture::finish() {
+
+    if(!active) return;
+    for(int k = 0; k < FRAME_CAPTURE_BUFFERS; k++) {
+        int slot = (next + k) % FRAME_CAPTURE_BUFFERS;
+        if(fences[slot]) collect(slot, true);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_one();
+    writer.join();
+
+    fflush(file);
+    if(!toStdout) fclose(file);
+    file = NULL;
+    glDeleteBuffers(FRAME_CAPTURE_BUFFERS, pbos);
+    for(int i = 0; i < FRAME_CAPTURE_BUFFERS; i++) MemoryRegistry::remove(MEMORIA_BUFFER, pbos[i]);
+    stats.megabytes = bytesWritten / (1024.0 * 1024.0);
+    active = false;
+
+}
+
+void FrameCapture::printReport() const {
+
+    char line[256];
+    std::cout << "---- Captura de frames ----" << std::endl;
+    snprintf(line, sizeof(line), "Frames: %llu escritos (%.1f MB), descartados %llu por GPU, %llu por escritor, %llu por tamano",
+             stats.captured, stats.megabytes, stats.droppedGpu, stats.droppedWriter, stats.droppedSize);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "Coste en el render: media %.3f ms, max %.3f ms", stats.avgCostMs, stats.maxCostMs);
+    std::cout << line << std::endl;
+
+}
+
+//-------------------------------------------------------------------------------------------------
+// Pasa la lectura de un PBO al hilo escritor, dándole la vuelta (OpenGL lee de abajo a arriba).
+// Devuelve false si la lectura aún no ha terminado y no se ha pedido esperar
+//-------------------------------------------------------------------------------------------------
+bool FrameCapture::collect(int slot, bool block) {
+
+    GLenum result = glClientWaitSync(fences[slot], block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, block ? 1000000000 : 0);
+    while(block && result == GL_TIMEOUT_EXPIRED) result = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    if(result == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync(fences[slot]);
+    fences[slot] = 0;
+
+    std::vector<unsigned char> *frame = NULL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!empty.empty()) {
+            frame = empty.back();
+            empty.pop_back();
+        }
+    }
+    if(!frame) {
+        stats.droppedWriter++;
+        return true;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const unsigned char *pixels = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameSize, GL_MAP_READ_BIT);
+    if(pixels) {
+        const size_t row = (size_t)width * 3;
+        for(int y = 0; y < height; y++) {
+            memcpy(frame->data() + y * row, pixels + (height - 1 - y) * row, row);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(pixels) full.push_back(frame);
+        else       empty.push_back(frame);
+    }
+    if(pixels) {
+        stats.captured++;
+        frameReady.notify_one();
+    }
+    return true;
+
+}
+
+//-------------------------------------------------------------------
+// Hilo escritor: saca los frames en orden y devuelve sus buffers
+//-------------------------------------------------------------------
+void FrameCapture::writerLoop() {
+
+    TRACE_THREAD("captura");
+    for(;;) {
+        std::vector<unsigned char> *frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameReady.wait(lock, [this] { return stopping || !full.empty(); });
+            if(full.empty()) return;
+            frame = full.front();
+            full.pop_front();
+        }
+
+        {
+            TRACE_SCOPE("FrameCapture::write");
+            bytesWritten += fwrite(frame->data(), 1, frame->size(), file);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        empty.push_back(frame);
+    }
+
+}
+
+//-----------------------------------------------------------------------------------
+// Destructor: si no se llamó a finish() solo se para el escritor (puede no haber contexto)
+//-----------------------------------------------------------------------------------
+FrameCapture::~FrameCapture() {
+
+    MemoryRegistry::remove(MEMORIA_HOST, (unsigned long long)(size_t)this);
+    if(!writer.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_one();
+    writer.join();
+    if(file && !toStdout) fclose(file);
+
+}
@@ -0,0 +1,77 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <GL/glew.h>
+
+// Lecturas en vuelo: cada frame se recoge de la GPU tres frames después de pedirlo
+const int FRAME_CAPTURE_BUFFERS = 3;
+
+// Frames ya leídos que pueden esperar en memoria a que el hilo escritor los saque
+const int FRAME_CAPTURE_QUEUE = 8;
+
+struct FrameCaptureStats {
+    unsigned long long captured;       // Frames escritos
+    unsigned long long droppedGpu;     // La GPU aún no había terminado la lectura de hace 3 frames
+    unsigned long long droppedWriter;  // El escritor no daba abasto (cola llena)
+    unsigned long long droppedSize;    // El framebuffer no tenía el tamaño de la captura
+    double             avgCostMs;      // Tiempo medio de capture() en el hilo del render
+    double             maxCostMs;
+    double             megabytes;      // Datos escritos
+};
+
+// Grabación de frames sin parar la GPU: cada frame se lee a un buffer de píxeles (PBO) de un
+// anillo con un fence, y se recoge sin esperar cuando ese PBO vuelve a tocar. Un hilo aparte
+// escribe los frames como RGB de 8 bits sin cabecera (de arriba a abajo) en un fichero o en la
+// salida estándar, para pasarlos a un codificador externo (p. ej. ffmpeg -f rawvideo)
+class FrameCapture {
+
+    public:
+
+        FrameCapture();
+
+        bool start  (const char *output, int width, int height);
+        void capture(GLuint framebuffer, int width, int height);
+        void finish ();
+
+        bool                     isActive() const { return active; }
+        const FrameCaptureStats& getStats() const { return stats; }
+        void                     printReport() const;
+
+        virtual ~FrameCapture();
+
+    private:
+
+        bool                 active;
+        FILE                *file;
+        bool                 toStdout;
+        int                  width;
+        int                  height;
+        size_t               frameSize;
+        GLuint               pbos[FRAME_CAPTURE_BUFFERS];
+        GLsync               fences[FRAME_CAPTURE_BUFFERS];
+        int                  next;
+        FrameCaptureStats    stats;
+        unsigned long long   calls;
+
+     // Hilo escritor: frames llenos hacia él y buffers vacíos de vuelta
+        std::thread                         writer;
+        std::mutex                          mutex;
+        std::condition_variable             frameReady;
+        std::deque<std::vector<unsigned char> *> full;
+        std::vector<std::vector<unsigned char> *> empty;
+        std::vector<std::vector<unsigned char> > frames;
+        bool                                stopping;
+        unsigned long long                  bytesWritten;
+
+        bool collect   (int slot, bool block);
+        void writerLoop();
+
+};
+
+#endif /* FRAMECAPTURE_H */
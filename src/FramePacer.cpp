@@ -0,0 +1,197 @@
+#include "FramePacer.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <algorithm>
+
+// Margen inicial y límites del tramo final que se espera activamente en vez de dormir (ms)
+const double SPIN_MARGIN_INITIAL_MS = 1.0;
+const double SPIN_MARGIN_MIN_MS     = 0.25;
+const double SPIN_MARGIN_MAX_MS     = 4.0;
+
+static long long clockNs(FramePacer::Clock::time_point t) {
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+
+}
+
+static double elapsedMs(FramePacer::Clock::time_point from, FramePacer::Clock::time_point to) {
+
+    return std::chrono::duration<double, std::milli>(to - from).count();
+
+}
+
+FramePacer::FramePacer() : targetFps(0.0), vsync(VSYNC_ON), period(0), spinMarginMs(SPIN_MARGIN_INITIAL_MS),
+                           gpuOffsetNs(0), nextQuery(0), timerQueries(false), swapFrames(0), fps(0.0), fpsFrames(0) {
+
+    for(int i = 0; i < FRAME_PACER_QUERIES; i++) {
+        queries[i] = 0;
+        queryPending[i] = false;
+    }
+    latency = LatencyStats();
+
+}
+
+//------------------------------------------------------------------------------------------
+// Configura el intervalo de intercambio de la ventana actual y la frecuencia objetivo (0: sin
+// límite). El vsync adaptativo necesita *_EXT_swap_control_tear; si no está se usa vsync normal
+//------------------------------------------------------------------------------------------
+void FramePacer::init(double targetFps, VsyncMode vsync) {
+
+    this->targetFps = targetFps > 0.0 ? targetFps : 0.0;
+    this->vsync     = vsync;
+
+    int interval = vsync == VSYNC_OFF ? 0 : 1;
+    if(vsync == VSYNC_ADAPTIVE) {
+        if(glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+            interval = -1;
+        } else {
+            std::cout << "Vsync adaptativo no disponible, se usa vsync normal" << std::endl;
+            this->vsync = VSYNC_ON;
+        }
+    }
+    glfwSwapInterval(interval);
+
+    period   = this->targetFps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / this->targetFps)) : Clock::duration(0);
+    deadline = Clock::now();
+    fpsStart = deadline;
+
+    timerQueries = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+    if(timerQueries) {
+        glGenQueries(FRAME_PACER_QUERIES, queries);
+        syncGpuClock();
+    }
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Limitador: espera al inicio del siguiente frame. Duerme hasta spinMarginMs antes del plazo y el
+// resto lo apura cediendo el hilo; el margen se adapta a lo que se pasa el sistema al despertar.
+// Si el frame ya llega tarde más de un periodo, el calendario se reinicia en vez de acumular deuda
+//------------------------------------------------------------------------------------------------
+void FramePacer::waitFrame() {
+
+    if(period == Clock::duration(0)) return;
+
+    Clock::time_point now = Clock::now();
+    if(now >= deadline) {
+        if(now - deadline > period) deadline = now;
+    } else {
+        double sleepMs = elapsedMs(now, deadline) - spinMarginMs;
+        if(sleepMs > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(sleepMs));
+            double oversleepMs = elapsedMs(now, Clock::now()) - sleepMs;
+            spinMarginMs = std::max(spinMarginMs * 0.95, oversleepMs * 1.25);
+            spinMarginMs = std::min(std::max(spinMarginMs, SPIN_MARGIN_MIN_MS), SPIN_MARGIN_MAX_MS);
+        }
+        while(Clock::now() < deadline) std::this_thread::yield();
+    }
+    deadline += period;
+
+}
+
+//-----------------------------------------------------------------------
+// Momento en que se ha leído la entrada del frame (justo antes de la cámara)
+//-----------------------------------------------------------------------
+void FramePacer::inputRead() {
+
+    inputTime = Clock::now();
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Tras glfwSwapBuffers: marca el final del frame en la GPU y recoge las marcas ya disponibles.
+// Devuelve true cuando hay una nueva medida de fps (una vez por segundo)
+//---------------------------------------------------------------------------------------------
+bool FramePacer::framePresented() {
+
+    Clock::time_point now = Clock::now();
+    swapFrames++;
+    latency.swapMs += (elapsedMs(inputTime, now) - latency.swapMs) / (double)swapFrames;
+
+    if(timerQueries) {
+        collectQueries();
+        if(!queryPending[nextQuery]) {
+            glQueryCounter(queries[nextQuery], GL_TIMESTAMP);
+            queryInput[nextQuery]   = inputTime;
+            queryPending[nextQuery] = true;
+            nextQuery = (nextQuery + 1) % FRAME_PACER_QUERIES;
+        }
+    }
+
+    fpsFrames++;
+    double windowMs = elapsedMs(fpsStart, now);
+    if(windowMs < 1000.0) return false;
+    fps       = fpsFrames * 1000.0 / windowMs;
+    fpsFrames = 0;
+    fpsStart  = now;
+    if(timerQueries) syncGpuClock();
+    return true;
+
+}
+
+void FramePacer::printReport() const {
+
+    const char *modes[] = { "sin vsync", "vsync", "vsync adaptativo" };
+    char line[256];
+    std::cout << "---- Ritmo de frames ----" << std::endl;
+    if(targetFps > 0.0) snprintf(line, sizeof(line), "Objetivo: %.1f fps (%s)", targetFps, modes[vsync]);
+    else                snprintf(line, sizeof(line), "Objetivo: sin limite (%s)", modes[vsync]);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "Entrada -> fin en GPU: media %.2f ms, max %.2f ms (%llu frames)", latency.avgMs, latency.maxMs, latency.frames);
+    std::cout << line << std::endl;
+    snprintf(line, sizeof(line), "Entrada -> swap:       media %.2f ms", latency.swapMs);
+    std::cout << line << std::endl;
+
+}
+
+//------------------------------------------------------------------------
+// Relación entre el reloj de la GPU (GL_TIMESTAMP) y el de la CPU, en ns
+//------------------------------------------------------------------------
+void FramePacer::syncGpuClock() {
+
+    GLint64 gpuNs = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNs);
+    gpuOffsetNs = clockNs(Clock::now()) - (long long)gpuNs;
+
+}
+
+//------------------------------------------------------------------------------------
+// Latencia de cada frame cuya marca de tiempo ya tiene la GPU (sin esperar por ninguna)
+//------------------------------------------------------------------------------------
+void FramePacer::collectQueries() {
+
+    for(int i = 0; i < FRAME_PACER_QUERIES; i++) {
+        if(!queryPending[i]) continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) continue;
+
+        GLuint64 gpuNs = 0;
+        glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &gpuNs);
+        queryPending[i] = false;
+
+        double ms = ((long long)gpuNs + gpuOffsetNs - clockNs(queryInput[i])) / 1.0e6;
+        if(ms < 0.0) ms = 0.0;
+        latency.frames++;
+        latency.lastMs = ms;
+        latency.avgMs += (ms - latency.avgMs) / (double)latency.frames;
+        latency.maxMs  = std::max(latency.maxMs, ms);
+    }
+
+}
+
+//-----------------------------------------------------------
+// Lee el modo de vsync de la línea de órdenes (off/on/adaptive)
+//-----------------------------------------------------------
+bool parseVsyncMode(const char *text, VsyncMode &mode) {
+
+    if     (std::strcmp(text, "off"     ) == 0) mode = VSYNC_OFF;
+    else if(std::strcmp(text, "on"      ) == 0) mode = VSYNC_ON;
+    else if(std::strcmp(text, "adaptive") == 0) mode = VSYNC_ADAPTIVE;
+    else return false;
+    return true;
+
+}
@@ -0,0 +1,77 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <chrono>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+// Sincronización con el refresco del monitor
+enum VsyncMode {
+    VSYNC_OFF,
+    VSYNC_ON,
+    VSYNC_ADAPTIVE   // Como VSYNC_ON, pero si un frame llega tarde se presenta sin esperar (tearing)
+};
+
+// Frames cuya consulta de fin en la GPU puede estar pendiente a la vez
+const int FRAME_PACER_QUERIES = 4;
+
+// Latencia entre la lectura de la entrada y el final del frame en la GPU (ms)
+struct LatencyStats {
+    unsigned long long frames;
+    double             lastMs;
+    double             avgMs;
+    double             maxMs;
+    double             swapMs;    // Media desde la entrada hasta que vuelve glfwSwapBuffers
+};
+
+// Ritmo de frames del bucle principal: limitador a una frecuencia objetivo que duerme hasta poco
+// antes del plazo y apura el resto activamente, modo de vsync, y medida de la latencia desde que
+// se lee la entrada hasta que la GPU termina de dibujar ese frame (consultas GL_TIMESTAMP)
+class FramePacer {
+
+    public:
+
+        typedef std::chrono::steady_clock Clock;
+
+        FramePacer();
+
+        void init          (double targetFps, VsyncMode vsync);
+        void waitFrame     ();
+        void inputRead     ();
+        bool framePresented();
+
+        double              getFps()     const { return fps; }
+        VsyncMode           getVsync()   const { return vsync; }
+        const LatencyStats& getLatency() const { return latency; }
+        void                printReport() const;
+
+    private:
+
+        double             targetFps;
+        VsyncMode          vsync;
+        Clock::duration    period;          // 0: sin límite
+        Clock::time_point  deadline;        // Inicio previsto del siguiente frame
+        double             spinMarginMs;    // Lo que se deja sin dormir para no pasarse del plazo
+
+        Clock::time_point  inputTime;
+        long long          gpuOffsetNs;     // Reloj de la CPU menos reloj de la GPU
+        GLuint             queries[FRAME_PACER_QUERIES];
+        Clock::time_point  queryInput[FRAME_PACER_QUERIES];
+        bool               queryPending[FRAME_PACER_QUERIES];
+        int                nextQuery;
+        bool               timerQueries;
+
+        LatencyStats       latency;
+        unsigned long long swapFrames;
+        double             fps;
+        unsigned int       fpsFrames;
+        Clock::time_point  fpsStart;
+
+        void syncGpuClock  ();
+        void collectQueries();
+
+};
+
+bool parseVsyncMode(const char *text, VsyncMode &mode);
+
+#endif /* FRAMEPACER_H */
@@ -0,0 +1,106 @@
+#include "Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define FRUSTUM_SSE
+    #include <xmmintrin.h>
+#endif
+
+//------------------------------------------------------------------------------
+// Extrae los seis planos de la matriz proyección * vista (método Gribb-Hartmann)
+//------------------------------------------------------------------------------
+Frustum extractFrustum(const glm::mat4 &PV) {
+
+    glm::vec4 row[4];
+    for(int i = 0; i < 4; i++) row[i] = glm::vec4(PV[0][i], PV[1][i], PV[2][i], PV[3][i]);
+
+    Frustum frustum;
+    frustum.planes[0] = row[3] + row[0];
+    frustum.planes[1] = row[3] - row[0];
+    frustum.planes[2] = row[3] + row[1];
+    frustum.planes[3] = row[3] - row[1];
+    frustum.planes[4] = row[3] + row[2];
+    frustum.planes[5] = row[3] - row[2];
+    for(int i = 0; i < 6; i++) {
+        glm::vec4 &p = frustum.planes[i];
+        p = p / glm::length(glm::vec3(p.x, p.y, p.z));
+    }
+    return frustum;
+
+}
+
+//------------------------------------------------------------------------------------
+// Lleva la esfera envolvente de un modelo a espacio del mundo (radio por la mayor escala)
+//------------------------------------------------------------------------------------
+glm::vec4 transformSphere(const glm::mat4 &M, const Bounds &bounds) {
+
+    glm::vec4 center = M * glm::vec4(bounds.center, 1.0f);
+    float sx = glm::length(glm::vec3(M[0].x, M[0].y, M[0].z));
+    float sy = glm::length(glm::vec3(M[1].x, M[1].y, M[1].z));
+    float sz = glm::length(glm::vec3(M[2].x, M[2].y, M[2].z));
+    return glm::vec4(center.x, center.y, center.z, bounds.radius * glm::max(sx, glm::max(sy, sz)));
+
+}
+
+void CullBatch::clear() {
+
+    x.clear();
+    y.clear();
+    z.clear();
+    r.clear();
+    ids.clear();
+
+}
+
+void CullBatch::add(const glm::vec4 &sphere, int id) {
+
+    x.push_back(sphere.x);
+    y.push_back(sphere.y);
+    z.push_back(sphere.z);
+    r.push_back(sphere.w);
+    ids.push_back(id);
+
+}
+
+//-----------------------------------------------------------------------------------
+// Marca qué esferas tocan el frustum: una esfera queda fuera si está entera detrás de
+// algún plano. Devuelve el número de visibles y acumula los contadores del frame
+//-----------------------------------------------------------------------------------
+size_t CullBatch::cull(const Frustum &frustum, CullStats &stats) {
+
+    const size_t count = x.size();
+    visible.resize(count);
+    size_t i = 0;
+
+#ifdef FRUSTUM_SSE
+    for(; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(&x[i]);
+        __m128 py = _mm_loadu_ps(&y[i]);
+        __m128 pz = _mm_loadu_ps(&z[i]);
+        __m128 nr = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&r[i]));
+        __m128 outside = _mm_setzero_ps();
+        for(int p = 0; p < 6; p++) {
+            const glm::vec4 &plane = frustum.planes[p];
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(plane.x)), _mm_mul_ps(py, _mm_set1_ps(plane.y))),
+                                  _mm_add_ps(_mm_mul_ps(pz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, nr));
+        }
+        int mask = _mm_movemask_ps(outside);
+        for(int k = 0; k < 4; k++) visible[i + k] = (mask & (1 << k)) ? 0 : 1;
+    }
+#endif
+    for(; i < count; i++) {
+        bool inside = true;
+        for(int p = 0; p < 6 && inside; p++) {
+            const glm::vec4 &plane = frustum.planes[p];
+            inside = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= -r[i];
+        }
+        visible[i] = inside ? 1 : 0;
+    }
+
+    size_t visibleCount = 0;
+    for(size_t k = 0; k < count; k++) visibleCount += visible[k];
+    stats.visible += (unsigned int)visibleCount;
+    stats.culled  += (unsigned int)(count - visibleCount);
+    return visibleCount;
+
+}
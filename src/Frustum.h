@@ -0,0 +1,47 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+
+// Planos del volumen de visión (normal hacia dentro, normalizados): izq, der, abajo, arriba, cerca, lejos
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// Contadores de objetos visibles y descartados en el frame actual
+struct CullStats {
+    unsigned int visible;
+    unsigned int culled;
+};
+
+Frustum   extractFrustum (const glm::mat4 &PV);
+glm::vec4 transformSphere(const glm::mat4 &M, const Bounds &bounds);
+
+// Lote de esferas en formato SoA que se prueba contra el frustum de cuatro en cuatro con SSE
+class CullBatch {
+
+    public:
+
+        void   clear();
+        void   add  (const glm::vec4 &sphere, int id);
+        size_t cull (const Frustum &frustum, CullStats &stats);
+
+        size_t size()             const { return x.size(); }
+        bool   isVisible(size_t i) const { return visible[i] != 0; }
+        int    id       (size_t i) const { return ids[i]; }
+
+    private:
+
+        std::vector<float>         x;
+        std::vector<float>         y;
+        std::vector<float>         z;
+        std::vector<float>         r;
+        std::vector<int>           ids;        // Índice del objeto en su propio array
+        std::vector<unsigned char> visible;
+
+};
+
+#endif /* FRUSTUM_H */
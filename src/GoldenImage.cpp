@@ -0,0 +1,271 @@
+#include "GoldenImage.h"
+#include "RenderTarget.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+const int GOLDEN_NAME_SIZE = 32;
+
+// Una escena de la lista, con la tolerancia vigente en su línea, y lo que ha salido al probarla
+struct GoldenCase {
+    char         name[GOLDEN_NAME_SIZE];
+    unsigned int seed;
+    double       seconds;
+    std::string  scenario;
+    float        threshold;
+    float        percent;
+    int          frame;
+    const char  *result;
+    ImageDiff    diff;
+    double       ms;
+};
+
+// Error perceptual entre dos píxeles RGB (0-255)
+static float pixelError(const unsigned char *a, const unsigned char *b) {
+
+    const float dr  = (float)a[0] - b[0];
+    const float dg  = (float)a[1] - b[1];
+    const float db  = (float)a[2] - b[2];
+    const float dy  = 0.299f * dr + 0.587f * dg + 0.114f * db;
+    const float dcb = 0.564f * (db - dy);
+    const float dcr = 0.713f * (dr - dy);
+    return std::sqrt(dy * dy + 0.25f * (dcb * dcb + dcr * dcr));
+
+}
+
+ImageDiff compareImages(const unsigned char *reference, const unsigned char *image, int width, int height,
+                        float threshold, unsigned char *diff) {
+
+    ImageDiff result = ImageDiff();
+    double sumError   = 0.0;
+    double sumSquares = 0.0;
+    for(int y = 0; y < height; y++) {
+        for(int x = 0; x < width; x++) {
+            const size_t index = ((size_t)y * width + x) * 3;
+            const float error = pixelError(reference + index, image + index);
+            for(int c = 0; c < 3; c++) {
+                const double d = (double)reference[index + c] - image[index + c];
+                sumSquares += d * d;
+            }
+            sumError += error;
+            result.maxError = std::max(result.maxError, (double)error);
+
+            // Sobre el umbral: se busca el vecino de la referencia más parecido
+            float nearest = error;
+            for(int ny = std::max(0, y - 1); nearest > threshold && ny <= std::min(height - 1, y + 1); ny++) {
+                for(int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++) {
+                    nearest = std::min(nearest, pixelError(reference + ((size_t)ny * width + nx) * 3, image + index));
+                }
+            }
+            const bool different = nearest > threshold;
+            if(different) result.differentPixels++;
+
+            if(diff) {
+                const unsigned char *r = reference + index;
+                const int gray = (int)(0.299f * r[0] + 0.587f * r[1] + 0.114f * r[2]);
+                unsigned char *out = diff + index;
+                if(different) {
+                    out[0] = (unsigned char)std::min(255, 128 + (int)(error * 2.0f));
+                    out[1] = 0;
+                    out[2] = 0;
+                } else if(error > 0.0f) {
+                    out[0] = out[1] = (unsigned char)std::min(255, gray + 96);
+                    out[2] = (unsigned char)gray;
+                } else {
+                    out[0] = out[1] = out[2] = (unsigned char)gray;
+                }
+            }
+        }
+    }
+
+    const double pixels = (double)width * height;
+    result.differentPercent = pixels > 0.0 ? 100.0 * result.differentPixels / pixels : 0.0;
+    result.meanError        = pixels > 0.0 ? sumError / pixels : 0.0;
+    const double mse        = pixels > 0.0 ? sumSquares / (pixels * 3.0) : 0.0;
+    result.psnr             = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    return result;
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// Lee la lista de escenas; false (con la línea que falla) si hay alguna que no se entiende
+//-----------------------------------------------------------------------------------------------
+static bool loadGoldenList(const char *file, double dt, std::vector<GoldenCase> &cases) {
+
+    FILE *in = fopen(file, "r");
+    if(!in) {
+        std::cerr << "No se puede abrir la lista de escenas " << file << std::endl;
+        return false;
+    }
+
+    float threshold = GOLDEN_THRESHOLD;
+    float percent   = GOLDEN_PERCENT;
+    bool ok = true;
+    char line[512];
+    for(int lineNumber = 1; ok && fgets(line, sizeof(line), in); lineNumber++) {
+        char *comment = std::strchr(line, '#');
+        if(comment) *comment = '\0';
+
+        char word[GOLDEN_NAME_SIZE];
+        if(std::sscanf(line, "%31s", word) != 1) continue;   // Línea en blanco o solo comentario
+        if(std::strcmp(word, "tolerancia") == 0) {
+            ok = std::sscanf(line, "%*s %f %f", &threshold, &percent) == 2 && threshold >= 0.0f && percent >= 0.0f;
+        } else {
+            GoldenCase golden = GoldenCase();
+            char scenario[256] = "";
+            ok = std::sscanf(line, "%31s %u %lf %255s", golden.name, &golden.seed, &golden.seconds, scenario) >= 3
+                 && golden.seed > 0 && golden.seconds >= dt;
+            golden.scenario  = scenario;
+            golden.threshold = threshold;
+            golden.percent   = percent;
+            golden.frame     = (int)std::floor(golden.seconds / dt + 0.5) - 1;
+            golden.result    = "error";
+            golden.ms        = 0.0;
+            cases.push_back(golden);
+        }
+        if(!ok) {
+            std::cerr << file << ":" << lineNumber << ": línea no válida (se espera <nombre> <semilla> <segundos> [escenario]"
+                      << " o tolerancia <umbral> <porcentaje>, con semilla > 0 y al menos un frame)" << std::endl;
+        }
+    }
+    fclose(in);
+    if(ok && cases.empty()) {
+        std::cerr << "La lista de escenas " << file << " está vacía" << std::endl;
+        ok = false;
+    }
+    return ok;
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Dibuja cada escena en su proceso (una tras otra: cada una ya usa todos los núcleos al cargar y,
+// con llvmpipe, al dibujar), la compara con su referencia y muestra y guarda el informe
+//------------------------------------------------------------------------------------------------
+int runGolden(const char *program, const Options &options) {
+
+    typedef std::chrono::steady_clock Clock;
+
+    if(options.scenarioFile || options.replayFile || options.captureFile || options.batch > 0) {
+        std::cerr << "--golden fija la escena de cada prueba: no se puede usar con --scenario, --replay, --capture ni --batch" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<GoldenCase> cases;
+    if(!loadGoldenList(options.goldenFile, options.fixedDt, cases)) return EXIT_FAILURE;
+
+    // Las referencias están junto a la lista
+    std::string directory(options.goldenFile);
+    const size_t slash = directory.find_last_of("/\\");
+    directory = slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+    const char *prefix = options.goldenOut;
+
+    std::cout << "Probando " << cases.size() << " escenas de " << options.width << "x" << options.height << " ("
+              << options.goldenFile << ")" << (options.goldenUpdate ? ", actualizando las referencias" : "") << std::endl;
+
+    for(GoldenCase &golden : cases) {
+        char command[2048];
+        char scenario[512] = "";
+        if(!golden.scenario.empty()) snprintf(scenario, sizeof(scenario), " --scenario \"%s\"", golden.scenario.c_str());
+        snprintf(command, sizeof(command),
+                 "\"%s\" --headless --size %dx%d --seed %u --fixed-dt %.17g --first-frame %d --frames 1%s --dump-frames \"%s_%s\" > \"%s_%s.log\" 2>&1",
+                 program, options.width, options.height, golden.seed, options.fixedDt, golden.frame, scenario,
+                 prefix, golden.name, prefix, golden.name);
+#ifdef _WIN32
+        // cmd /c quita la primera y la última comilla de la orden: se envuelve entera
+        const std::string line = std::string("\"") + command + "\"";
+#else
+        const std::string line(command);
+#endif
+        const Clock::time_point start = Clock::now();
+        const int status = std::system(line.c_str());
+        golden.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        char imageFile[512];
+        snprintf(imageFile, sizeof(imageFile), "%s_%s_%05d.ppm", prefix, golden.name, golden.frame);
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> image;
+        if(status != 0 || !readPPM(imageFile, width, height, image)) {
+            std::cerr << "La escena " << golden.name << " no se ha podido dibujar; ver " << prefix << "_" << golden.name << ".log" << std::endl;
+            continue;
+        }
+
+        const std::string referenceFile = directory + golden.name + ".ppm";
+        if(options.goldenUpdate) {
+            golden.result = writePPM(referenceFile.c_str(), width, height, image.data()) ? "actualizada" : "error";
+            continue;
+        }
+
+        int referenceWidth = 0;
+        int referenceHeight = 0;
+        std::vector<unsigned char> reference;
+        if(!readPPM(referenceFile.c_str(), referenceWidth, referenceHeight, reference)) {
+            golden.result = "SIN REFERENCIA";
+            continue;
+        }
+        if(referenceWidth != width || referenceHeight != height) {
+            std::cerr << "La referencia " << referenceFile << " es de " << referenceWidth << "x" << referenceHeight
+                      << ": usar --size " << referenceWidth << "x" << referenceHeight << " o --golden-update" << std::endl;
+            golden.result = "otro tamano";
+            continue;
+        }
+
+        std::vector<unsigned char> diff(image.size());
+        golden.diff = compareImages(reference.data(), image.data(), width, height, golden.threshold, diff.data());
+        golden.result = golden.diff.differentPercent <= golden.percent ? "correcto" : "FALLO";
+        char diffFile[512];
+        snprintf(diffFile, sizeof(diffFile), "%s_%s_diff.ppm", prefix, golden.name);
+        writePPM(diffFile, width, height, diff.data());
+    }
+
+    // Informe: una línea por escena en pantalla y en CSV
+    bool ok = true;
+    char line[512];
+    std::cout << "---- Imagenes de referencia ----" << std::endl;
+    snprintf(line, sizeof(line), "%-20s %8s %8s %6s  %-14s %9s %8s %8s %8s %8s", "Escena", "Semilla", "Segundos", "Frame",
+             "Resultado", "Distintos", "%", "Err max", "Err medio", "PSNR");
+    std::cout << line << std::endl;
+    std::string csvFile = std::string(prefix) + ".csv";
+    FILE *csv = fopen(csvFile.c_str(), "w");
+    if(!csv) std::cerr << "No se puede crear el informe " << csvFile << std::endl;
+    if(csv) fprintf(csv, "escena,semilla,segundos,frame,escenario,umbral,porcentaje_max,resultado,pixeles_distintos,porcentaje,error_max,error_medio,psnr,ms\n");
+    int passed  = 0;
+    int missing = 0;
+    for(const GoldenCase &golden : cases) {
+        const bool pass = std::strcmp(golden.result, "correcto") == 0 || std::strcmp(golden.result, "actualizada") == 0;
+        if(pass) passed++;
+        if(std::strcmp(golden.result, "SIN REFERENCIA") == 0) missing++;
+        ok = ok && pass;
+        snprintf(line, sizeof(line), "%-20s %8u %8.3f %6d  %-14s %9d %8.3f %8.1f %8.2f %8.1f", golden.name, golden.seed, golden.seconds,
+                 golden.frame, golden.result, golden.diff.differentPixels, golden.diff.differentPercent, golden.diff.maxError,
+                 golden.diff.meanError, golden.diff.psnr);
+        std::cout << line << std::endl;
+        if(csv) {
+            fprintf(csv, "%s,%u,%.6f,%d,%s,%.2f,%.4f,%s,%d,%.4f,%.2f,%.4f,%.2f,%.1f\n", golden.name, golden.seed, golden.seconds, golden.frame,
+                    golden.scenario.c_str(), golden.threshold, golden.percent, golden.result, golden.diff.differentPixels,
+                    golden.diff.differentPercent, golden.diff.maxError, golden.diff.meanError, golden.diff.psnr, golden.ms);
+        }
+    }
+    if(csv) fclose(csv);
+    std::cout << passed << " de " << cases.size() << " escenas correctas";
+    if(!ok && !options.goldenUpdate) std::cout << " (diferencias en " << prefix << "_<escena>_diff.ppm)";
+    std::cout << std::endl;
+
+    // Una escena sin referencia no se ha comprobado: falla como las demás, pero se dice cómo crearla
+    if(missing > 0) {
+        std::cout << missing << " escenas sin referencia en " << (directory.empty() ? std::string("./") : directory)
+                  << ": se generan desde una versión que se dé por buena con --golden-update"
+                  << " (mismo --size y --fixed-dt; objetivo golden_update de CMake) y se suben junto a la lista" << std::endl;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}
@@ -0,0 +1,39 @@
+#ifndef GOLDENIMAGE_H
+#define GOLDENIMAGE_H
+
+#include "Options.h"
+
+// Tolerancia por defecto de las escenas de referencia (se cambia con "tolerancia" en la lista)
+const float GOLDEN_THRESHOLD = 16.0f;   // Error perceptual por píxel que se admite (0-255)
+const float GOLDEN_PERCENT   = 0.1f;    // Porcentaje de píxeles distintos que se admite
+
+// Diferencia entre una imagen y su referencia, las dos RGB de 8 bits del mismo tamaño
+struct ImageDiff {
+    int    differentPixels;   // Con error sobre el umbral frente al píxel y a sus 8 vecinos de la referencia
+    double differentPercent;
+    double maxError;          // Error perceptual máximo y medio, píxel a píxel (0-255)
+    double meanError;
+    double psnr;              // dB sobre RGB (infinito si son iguales)
+};
+
+// Compara píxel a píxel con un error perceptual: distancia en luminancia y crominancia con la
+// crominancia a la mitad de peso, porque el ojo nota mucho más un cambio de brillo. Un píxel solo
+// cuenta como distinto si tampoco se parece a ningún vecino de la referencia, así que un borde
+// desplazado un píxel (otra rasterización u otro driver) no cuenta. Si diff no es NULL deja ahí
+// una imagen de las diferencias: la referencia en gris, en amarillo lo distinto pero
+// tolerado y en rojo lo que cuenta
+ImageDiff compareImages(const unsigned char *reference, const unsigned char *image, int width, int height,
+                        float threshold, unsigned char *diff);
+
+// Pruebas de imagen de referencia para comprobar que una optimización no cambia lo que se ve. La
+// lista es un fichero de texto con una escena por línea, "<nombre> <semilla> <segundos>
+// [escenario]", y líneas "tolerancia <umbral> <porcentaje>" que valen para las escenas siguientes
+// ('#' para comentarios). Cada escena se dibuja sin ventana en un proceso de este mismo programa
+// (como --batch: todo el estado del render es global), con su semilla, avanzando la simulación a
+// paso fijo hasta ese tiempo simulado, y se compara con <directorio de la lista>/<nombre>.ppm.
+// Deja <prefijo>_<nombre>_NNNNN.ppm, <prefijo>_<nombre>_diff.ppm, <prefijo>_<nombre>.log y el
+// informe <prefijo>.csv. Con --golden-update copia lo dibujado como nueva referencia. Devuelve
+// EXIT_FAILURE si alguna escena falla o no tiene referencia
+int runGolden(const char *program, const Options &options);
+
+#endif /* GOLDENIMAGE_H */
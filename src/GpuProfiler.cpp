@@ -0,0 +1,220 @@
+#include "GpuProfiler.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+// Peso de cada frame en la media móvil (unos 20 frames de memoria)
+const double GPU_PROFILER_SMOOTHING = 0.05;
+
+//----------------------------------------------------------------
+// Añade una medida de un frame a las estadísticas de un tramo
+//----------------------------------------------------------------
+static void updatePassStats(GpuPassStats &stats, double ms) {
+
+    stats.lastMs = ms;
+    stats.avgMs  = stats.samples == 0 ? ms : stats.avgMs + (ms - stats.avgMs) * GPU_PROFILER_SMOOTHING;
+    stats.maxMs  = std::max(stats.maxMs, ms);
+    stats.samples++;
+
+}
+
+GpuProfiler::GpuProfiler() : enabled(false), recording(false), current(0), depth(0), frameHistogram(NULL), skipped(0), overflows(0) {
+
+    for(int i = 0; i < GPU_PROFILER_FRAMES; i++) {
+        frames[i].numScopes = 0;
+        frames[i].pending   = false;
+        for(int q = 0; q < 2 * GPU_PROFILER_MAX_SCOPES + 2; q++) frames[i].queries[q] = 0;
+    }
+    frame = GpuPassStats();
+    frame.name = "frame";
+
+}
+
+//----------------------------------------------------------------------------------
+// Activa la medida si hay consultas de tiempo (OpenGL 3.3 o ARB_timer_query)
+//----------------------------------------------------------------------------------
+void GpuProfiler::init(bool enabled) {
+
+    this->enabled = enabled && (GLEW_VERSION_3_3 || GLEW_ARB_timer_query);
+    if(enabled && !this->enabled) std::cout << "Sin consultas de tiempo de GPU: no se mide la GPU por tramos" << std::endl;
+    if(!this->enabled) return;
+
+    for(int i = 0; i < GPU_PROFILER_FRAMES; i++) glGenQueries(2 * GPU_PROFILER_MAX_SCOPES + 2, frames[i].queries);
+    lastLog = std::chrono::steady_clock::now();
+
+}
+
+//-------------------------------------------------------------------------------------------
+// Recoge los frames ya terminados y empieza a medir este si su hueco del anillo está libre
+//-------------------------------------------------------------------------------------------
+void GpuProfiler::beginFrame() {
+
+    if(!enabled) return;
+    current = (current + 1) % GPU_PROFILER_FRAMES;
+    collect();
+
+    FrameQueries &queries = frames[current];
+    recording = !queries.pending;
+    depth = 0;
+    if(!recording) {
+        skipped++;
+        return;
+    }
+    queries.numScopes = 0;
+    glQueryCounter(queries.queries[0], GL_TIMESTAMP);
+
+}
+
+void GpuProfiler::endFrame() {
+
+    if(!recording) return;
+    FrameQueries &queries = frames[current];
+    while(depth > 0) end();
+    glQueryCounter(queries.queries[1], GL_TIMESTAMP);
+    queries.pending = true;
+    recording = false;
+
+}
+
+//-----------------------------------------------------------------------------------------
+// Abre un tramo. name debe seguir siendo válido mientras exista el perfilador (un literal)
+//-----------------------------------------------------------------------------------------
+void GpuProfiler::begin(const char *name) {
+
+    if(!recording || depth == GPU_PROFILER_MAX_SCOPES) return;
+    FrameQueries &queries = frames[current];
+    if(queries.numScopes == GPU_PROFILER_MAX_SCOPES) {
+        overflows++;
+        stack[depth++] = -1;
+        return;
+    }
+
+    int index = queries.numScopes++;
+    Scope &scope = queries.scopes[index];
+    scope.pass   = passIndex(name);
+    scope.first  = 2 + 2 * index;
+    scope.second = 3 + 2 * index;
+    glQueryCounter(queries.queries[scope.first], GL_TIMESTAMP);
+    stack[depth++] = index;
+
+}
+
+//-----------------------------------
+// Cierra el último tramo abierto
+//-----------------------------------
+void GpuProfiler::end() {
+
+    if(!recording || depth == 0) return;
+    int index = stack[--depth];
+    if(index < 0) return;
+    FrameQueries &queries = frames[current];
+    glQueryCounter(queries.queries[queries.scopes[index].second], GL_TIMESTAMP);
+
+}
+
+const GpuPassStats* GpuProfiler::find(const char *name) const {
+
+    for(const auto& pass : passes) {
+        if(std::strcmp(pass.name, name) == 0) return &pass;
+    }
+    return NULL;
+
+}
+
+//----------------------------------------------------------------------------------
+// Una línea con la media de cada tramo, como mucho cada seconds segundos
+//----------------------------------------------------------------------------------
+void GpuProfiler::logPeriodically(double seconds) {
+
+    if(!enabled) return;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if(std::chrono::duration<double>(now - lastLog).count() < seconds || frame.samples == 0) return;
+    lastLog = now;
+
+    char line[1024];
+    int  length = snprintf(line, sizeof(line), "GPU %.2f ms:", frame.avgMs);
+    for(const auto& pass : passes) {
+        if(length >= (int)sizeof(line)) break;
+        length += snprintf(line + length, sizeof(line) - length, " %s %.2f", pass.name, pass.avgMs);
+    }
+    std::cout << line << std::endl;
+
+}
+
+void GpuProfiler::printReport() const {
+
+    if(!enabled) return;
+    char line[256];
+    std::cout << "---- Tiempo de GPU por tramos ----" << std::endl;
+    for(size_t i = 0; i <= passes.size(); i++) {
+        const GpuPassStats &pass = i < passes.size() ? passes[i] : frame;
+        snprintf(line, sizeof(line), "%-12s media %7.3f ms  ultimo %7.3f ms  max %7.3f ms  (%llu frames)",
+                 pass.name, pass.avgMs, pass.lastMs, pass.maxMs, pass.samples);
+        std::cout << line << std::endl;
+    }
+    if(skipped || overflows) std::cout << "Frames sin medir: " << skipped << ", tramos descartados: " << overflows << std::endl;
+
+}
+
+int GpuProfiler::passIndex(const char *name) {
+
+    for(size_t i = 0; i < passes.size(); i++) {
+        if(passes[i].name == name || std::strcmp(passes[i].name, name) == 0) return (int)i;
+    }
+    GpuPassStats pass = GpuPassStats();
+    pass.name = name;
+    passes.push_back(pass);
+    return (int)passes.size() - 1;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Lee los frames pendientes del más antiguo al más nuevo; se para en el primero sin terminar
+//------------------------------------------------------------------------------------------
+void GpuProfiler::collect() {
+
+    for(int k = 0; k < GPU_PROFILER_FRAMES; k++) {
+        FrameQueries &queries = frames[(current + k) % GPU_PROFILER_FRAMES];
+        if(!queries.pending) continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(queries.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available) return;
+        read(queries);
+    }
+
+}
+
+void GpuProfiler::read(FrameQueries &queries) {
+
+    GLuint64 times[2 * GPU_PROFILER_MAX_SCOPES + 2];
+    const int numQueries = 2 + 2 * queries.numScopes;
+    for(int q = 0; q < numQueries; q++) glGetQueryObjectui64v(queries.queries[q], GL_QUERY_RESULT, &times[q]);
+    queries.pending = false;
+
+    updatePassStats(frame, (times[1] - times[0]) / 1.0e6);
+    if(frameHistogram) frameHistogram->record(frame.lastMs);
+
+    frameMs.assign(passes.size(), -1.0);
+    for(int s = 0; s < queries.numScopes; s++) {
+        const Scope &scope = queries.scopes[s];
+        double ms = (times[scope.second] - times[scope.first]) / 1.0e6;
+        frameMs[scope.pass] = std::max(frameMs[scope.pass], 0.0) + ms;
+    }
+    for(size_t p = 0; p < passes.size(); p++) {
+        if(frameMs[p] >= 0.0) updatePassStats(passes[p], frameMs[p]);
+    }
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+GpuProfiler::~GpuProfiler() {
+
+    if(!frames[0].queries[0]) return;
+    for(int i = 0; i < GPU_PROFILER_FRAMES; i++) glDeleteQueries(2 * GPU_PROFILER_MAX_SCOPES + 2, frames[i].queries);
+
+}
@@ -0,0 +1,89 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <vector>
+#include <chrono>
+#include <GL/glew.h>
+
+#include "Histogram.h"
+
+// Frames cuyas medidas pueden estar pendientes a la vez, y tramos medidos como mucho por frame
+const int GPU_PROFILER_FRAMES = 4;
+const int GPU_PROFILER_MAX_SCOPES = 32;
+
+// Tiempo de GPU de un tramo con nombre (ms). Si el tramo se repite en un frame se suma
+struct GpuPassStats {
+    const char        *name;
+    double             lastMs;
+    double             avgMs;     // Media móvil exponencial
+    double             maxMs;
+    unsigned long long samples;
+};
+
+// Medida del tiempo de GPU por tramos con nombre (begin/end, pueden anidarse). Cada límite es una
+// consulta GL_TIMESTAMP; las de un frame se leen varios frames después y solo si ya están listas,
+// así que la CPU nunca espera a la GPU. Si un frame llega con su hueco del anillo aún pendiente,
+// ese frame no se mide. Desactivado, begin/end no hacen nada
+class GpuProfiler {
+
+    public:
+
+        GpuProfiler();
+
+        void init      (bool enabled);
+        void beginFrame();
+        void endFrame  ();
+        void begin     (const char *name);
+        void end       ();
+
+        void setFrameHistogram(Histogram *histogram) { frameHistogram = histogram; }   // Recibe el tiempo de cada frame medido
+
+        bool                             isEnabled() const { return enabled; }
+        const std::vector<GpuPassStats>& getPasses() const { return passes; }
+        const GpuPassStats*              find     (const char *name) const;
+        const GpuPassStats&              getFrame () const { return frame; }
+        unsigned long long               getSkipped() const { return skipped; }
+
+        void logPeriodically(double seconds);
+        void printReport    () const;
+
+        virtual ~GpuProfiler();
+
+    private:
+
+        // Un tramo medido: su pasada y las consultas de inicio y fin (índices en queries)
+        struct Scope {
+            int pass;
+            int first;
+            int second;
+        };
+
+        struct FrameQueries {
+            GLuint queries[2 * GPU_PROFILER_MAX_SCOPES + 2];   // 0 y 1: inicio y fin del frame
+            Scope  scopes[GPU_PROFILER_MAX_SCOPES];
+            int    numScopes;
+            bool   pending;
+        };
+
+        bool                      enabled;
+        bool                      recording;        // El frame actual se está midiendo
+        FrameQueries              frames[GPU_PROFILER_FRAMES];
+        int                       current;
+        int                       stack[GPU_PROFILER_MAX_SCOPES];
+        int                       depth;
+
+        std::vector<GpuPassStats> passes;
+        std::vector<double>       frameMs;          // Suma por pasada del frame que se está leyendo
+        GpuPassStats              frame;
+        Histogram                *frameHistogram;
+        unsigned long long        skipped;
+        unsigned long long        overflows;
+        std::chrono::steady_clock::time_point lastLog;
+
+        int  passIndex(const char *name);
+        void collect  ();
+        void read     (FrameQueries &queries);
+
+};
+
+#endif /* GPUPROFILER_H */
@@ -0,0 +1,165 @@
+#include "HeadlessContext.h"
+
+#include <iostream>
+
+#if defined(AQUARIO_HEADLESS_EGL) && !defined(EGL_PLATFORM_SURFACELESS_MESA)
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+#if defined(AQUARIO_HEADLESS_EGL)
+
+HeadlessContext::HeadlessContext() : display(EGL_NO_DISPLAY), context(EGL_NO_CONTEXT) {
+
+}
+
+//-------------------------------------------------------------------------------------------
+// Crea el contexto y lo deja activo en este hilo. Se usa la plataforma sin superficie de Mesa
+// si está disponible y, si no, la pantalla por defecto de EGL
+//-------------------------------------------------------------------------------------------
+bool HeadlessContext::create() {
+
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if(getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if(display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "EGL: no se pudo inicializar la pantalla" << std::endl;
+        return false;
+    }
+    if(!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL: OpenGL de escritorio no disponible" << std::endl;
+        destroy();
+        return false;
+    }
+
+    // Sin ventana no hay configuraciones con EGL_WINDOW_BIT, que es lo que se pide por defecto
+    const EGLint configAttribs[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config;
+    EGLint    numConfigs = 0;
+    if(!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0) {
+        std::cerr << "EGL: no hay ninguna configuración con OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if(context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "EGL: no se pudo crear un contexto OpenGL 3.3 core sin superficie" << std::endl;
+        destroy();
+        return false;
+    }
+    std::cout << "Contexto sin ventana: EGL " << major << "." << minor << std::endl;
+    return true;
+
+}
+
+void HeadlessContext::destroy() {
+
+    if(display == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+    eglTerminate(display);
+    context = EGL_NO_CONTEXT;
+    display = EGL_NO_DISPLAY;
+
+}
+
+const char* HeadlessContext::backend() const {
+
+    return "EGL";
+
+}
+
+#elif defined(AQUARIO_HEADLESS_OSMESA)
+
+HeadlessContext::HeadlessContext() : context(NULL) {
+
+}
+
+//-------------------------------------------------------------------------------------------
+// Crea el contexto y lo deja activo en este hilo. OSMesa necesita un buffer de color propio;
+// basta con uno de 1x1 porque todo se dibuja en un FBO
+//-------------------------------------------------------------------------------------------
+bool HeadlessContext::create() {
+
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    context = OSMesaCreateContextAttribs(attribs, NULL);
+    if(!context) {
+        std::cerr << "OSMesa: no se pudo crear un contexto OpenGL 3.3 core" << std::endl;
+        return false;
+    }
+    buffer.assign(4, 0);
+    if(!OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, 1, 1)) {
+        std::cerr << "OSMesa: no se pudo activar el contexto" << std::endl;
+        destroy();
+        return false;
+    }
+    std::cout << "Contexto sin ventana: OSMesa" << std::endl;
+    return true;
+
+}
+
+void HeadlessContext::destroy() {
+
+    if(!context) return;
+    OSMesaDestroyContext(context);
+    context = NULL;
+
+}
+
+const char* HeadlessContext::backend() const {
+
+    return "OSMesa";
+
+}
+
+#else
+
+HeadlessContext::HeadlessContext() {
+
+}
+
+//--------------------------------------------------------------------------
+// Sin backend compilado: hay que configurar con -DAQUARIO_HEADLESS=EGL u OSMESA
+//--------------------------------------------------------------------------
+bool HeadlessContext::create() {
+
+    std::cerr << "Este ejecutable no tiene modo sin ventana (configurar con -DAQUARIO_HEADLESS=EGL u OSMESA)" << std::endl;
+    return false;
+
+}
+
+void HeadlessContext::destroy() {
+
+}
+
+const char* HeadlessContext::backend() const {
+
+    return "ninguno";
+
+}
+
+#endif
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+HeadlessContext::~HeadlessContext() {
+
+    destroy();
+
+}
@@ -0,0 +1,40 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#include <vector>
+
+// El backend se elige al compilar (opción AQUARIO_HEADLESS de CMake)
+#if defined(AQUARIO_HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(AQUARIO_HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+// Contexto OpenGL 3.3 core sin ventana ni servidor gráfico, para dibujar en un FBO en máquinas
+// sin pantalla: EGL sin superficie (EGL_MESA_platform_surfaceless, p. ej. Mesa llvmpipe) u OSMesa
+class HeadlessContext {
+
+    public:
+
+        HeadlessContext();
+
+        bool        create ();
+        void        destroy();
+        const char* backend() const;
+
+        virtual ~HeadlessContext();
+
+    private:
+
+#if defined(AQUARIO_HEADLESS_EGL)
+        EGLDisplay                 display;
+        EGLContext                 context;
+#elif defined(AQUARIO_HEADLESS_OSMESA)
+        OSMesaContext              context;
+        std::vector<unsigned char> buffer;   // Framebuffer por defecto mínimo: se dibuja en un FBO
+#endif
+
+};
+
+#endif /* HEADLESSCONTEXT_H */
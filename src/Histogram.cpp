@@ -0,0 +1,140 @@
+#include "Histogram.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// Percentiles de los informes
+static const double REPORT_PERCENTILES[] = { 50.0, 90.0, 99.0, 99.9 };
+static const int    NUM_REPORT_PERCENTILES = 4;
+
+Histogram::Histogram() {
+
+    reset();
+
+}
+
+//----------------------------------------------------------------------------
+// Añade una medida. Solo desde un hilo: las sumas no son atómicas entre hilos
+//----------------------------------------------------------------------------
+void Histogram::record(double ms) {
+
+    const unsigned long long ns = ms > 0.0 ? (unsigned long long)(ms * 1.0e6 + 0.5) : 0;
+    std::atomic<unsigned long long> &bucket = counts[bucketOf(ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sumNs.store(sumNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    if(ns > maxNs.load(std::memory_order_relaxed)) maxNs.store(ns, std::memory_order_relaxed);
+    total.store(total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+}
+
+void Histogram::reset() {
+
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) counts[i].store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sumNs.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+
+}
+
+//------------------------------------------------------------------------------------------
+// Valor por debajo del cual queda el p % de las medidas: el límite superior de su cubo (nunca
+// más que el máximo medido)
+//------------------------------------------------------------------------------------------
+double Histogram::percentile(double p) const {
+
+    const unsigned long long n = count();
+    if(n == 0) return 0.0;
+
+    unsigned long long rank = (unsigned long long)std::ceil(std::min(std::max(p, 0.0), 100.0) / 100.0 * n);
+    rank = std::max(rank, 1ULL);
+    unsigned long long seen = 0;
+    for(int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if(seen >= rank) return std::min(bucketHigh(i), maxNs.load(std::memory_order_relaxed)) / 1.0e6;
+    }
+    return max();
+
+}
+
+double Histogram::max() const {
+
+    return maxNs.load(std::memory_order_relaxed) / 1.0e6;
+
+}
+
+double Histogram::mean() const {
+
+    const unsigned long long n = count();
+    return n ? sumNs.load(std::memory_order_relaxed) / 1.0e6 / n : 0.0;
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Por debajo de 2^SUB_BITS ns cada valor tiene su cubo; por encima, cada potencia de dos se divide
+// en 2^(SUB_BITS - 1) cubos iguales, índice = desplazamiento * 2^(SUB_BITS - 1) + (ns >> desplazamiento)
+//------------------------------------------------------------------------------------------------
+int Histogram::bucketOf(unsigned long long ns) {
+
+    const unsigned long long limit = (1ULL << HISTOGRAM_MAX_BITS) - 1;
+    if(ns > limit) ns = limit;
+    if(ns < (1ULL << HISTOGRAM_SUB_BITS)) return (int)ns;
+
+    int msb = 0;
+    for(unsigned long long v = ns >> 1; v; v >>= 1) msb++;
+    const int shift = msb - HISTOGRAM_SUB_BITS + 1;
+    return (shift << (HISTOGRAM_SUB_BITS - 1)) + (int)(ns >> shift);
+
+}
+
+unsigned long long Histogram::bucketHigh(int index) {
+
+    if(index < (1 << HISTOGRAM_SUB_BITS)) return (unsigned long long)index;
+    const int shift = (index >> (HISTOGRAM_SUB_BITS - 1)) - 1;
+    const unsigned long long sub = (unsigned long long)(index - (shift << (HISTOGRAM_SUB_BITS - 1)));
+    return ((sub + 1) << shift) - 1;
+
+}
+
+//------------------------------------------------------------------
+// Tabla con media, percentiles y máximo (ms) de cada histograma
+//------------------------------------------------------------------
+void printHistograms(const char *title, const NamedHistogram *histograms, int count) {
+
+    char line[256];
+    std::cout << "---- " << title << " ----" << std::endl;
+    snprintf(line, sizeof(line), "%-10s %9s %9s %9s %9s %9s %9s %9s", "", "muestras", "media", "p50", "p90", "p99", "p99.9", "max");
+    std::cout << line << std::endl;
+    for(int h = 0; h < count; h++) {
+        const Histogram &histogram = *histograms[h].histogram;
+        if(histogram.count() == 0) continue;
+        int length = snprintf(line, sizeof(line), "%-10s %9llu %9.3f", histograms[h].name, histogram.count(), histogram.mean());
+        for(int p = 0; p < NUM_REPORT_PERCENTILES; p++) {
+            length += snprintf(line + length, sizeof(line) - length, " %9.3f", histogram.percentile(REPORT_PERCENTILES[p]));
+        }
+        snprintf(line + length, sizeof(line) - length, " %9.3f", histogram.max());
+        std::cout << line << std::endl;
+    }
+
+}
+
+bool writeHistogramsCsv(const char *file, const NamedHistogram *histograms, int count) {
+
+    FILE *out = fopen(file, "w");
+    if(!out) {
+        std::cerr << "No se puede crear el fichero de percentiles " << file << std::endl;
+        return false;
+    }
+    fprintf(out, "metrica,muestras,media_ms,p50_ms,p90_ms,p99_ms,p99.9_ms,max_ms\n");
+    for(int h = 0; h < count; h++) {
+        const Histogram &histogram = *histograms[h].histogram;
+        fprintf(out, "%s,%llu,%.4f", histograms[h].name, histogram.count(), histogram.mean());
+        for(int p = 0; p < NUM_REPORT_PERCENTILES; p++) fprintf(out, ",%.4f", histogram.percentile(REPORT_PERCENTILES[p]));
+        fprintf(out, ",%.4f\n", histogram.max());
+    }
+    bool ok = ferror(out) == 0;
+    fclose(out);
+    return ok;
+
+}
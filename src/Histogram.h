@@ -0,0 +1,52 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+
+// Precisión y rango: 2^(HISTOGRAM_SUB_BITS - 1) subdivisiones por potencia de dos (error relativo
+// de hasta 1/64, un 1,6 %) hasta 2^HISTOGRAM_MAX_BITS ns (unos 18 minutos); lo que pase de ahí
+// cuenta en el último cubo
+const int HISTOGRAM_SUB_BITS = 7;
+const int HISTOGRAM_MAX_BITS = 40;
+const int HISTOGRAM_BUCKETS  = (HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 2) << (HISTOGRAM_SUB_BITS - 1);
+
+// Histograma de tiempos al estilo HDR: cubos lineales dentro de cada potencia de dos, así que
+// registrar es O(1) con memoria fija y los percentiles altos salen con precisión relativa
+// constante. Un solo hilo registra; los contadores son atómicos para poder leerlos desde otro
+// (p. ej. un informe a mitad de ejecución) sin parar al que escribe
+class Histogram {
+
+    public:
+
+        Histogram();
+
+        void   record    (double ms);
+        void   reset     ();
+        double percentile(double p) const;   // p en [0, 100], en ms
+
+        unsigned long long count() const { return total.load(std::memory_order_relaxed); }
+        double             max  () const;
+        double             mean () const;
+
+    private:
+
+        std::atomic<unsigned long long> counts[HISTOGRAM_BUCKETS];
+        std::atomic<unsigned long long> total;
+        std::atomic<unsigned long long> sumNs;
+        std::atomic<unsigned long long> maxNs;
+
+        static int                bucketOf  (unsigned long long ns);
+        static unsigned long long bucketHigh(int index);
+
+};
+
+// Histograma con nombre, para los informes
+struct NamedHistogram {
+    const char      *name;
+    const Histogram *histogram;
+};
+
+void printHistograms   (const char *title, const NamedHistogram *histograms, int count);
+bool writeHistogramsCsv(const char *file,  const NamedHistogram *histograms, int count);
+
+#endif /* HISTOGRAM_H */
@@ -0,0 +1,369 @@
+#include "InputRecording.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+static const char          INPUT_RECORDING_MAGIC[4] = { 'A', 'Q', 'I', 'N' };
+static const unsigned char INPUT_RECORDING_VERSION  = 2;
+static const size_t        INPUT_RECORDING_HEADER   = 16;
+
+// Enteros de bytes bytes en little endian (los float y double van por su representación)
+static void putLE(std::vector<unsigned char> &data, unsigned long long value, int bytes) {
+
+    for(int i = 0; i < bytes; i++) data.push_back((unsigned char)(value >> (8 * i)));
+
+}
+
+static unsigned long long floatBits(float value) {
+
+    unsigned int bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+
+}
+
+static unsigned long long doubleBits(double value) {
+
+    unsigned long long bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+
+}
+
+// Lectura con comprobación de límites: una grabación cortada deja ok a false
+struct InputReader {
+    const unsigned char *data;
+    size_t               size;
+    size_t               position;
+    bool                 ok;
+
+    unsigned long long le(int bytes) {
+        if(position + bytes > size) {
+            ok = false;
+            return 0;
+        }
+        unsigned long long value = 0;
+        for(int i = 0; i < bytes; i++) value |= (unsigned long long)data[position++] << (8 * i);
+        return value;
+    }
+
+    unsigned long long varint() {
+        unsigned long long value = 0;
+        for(int shift = 0; shift < 64; shift += 7) {
+            const unsigned long long byte = le(1);
+            value |= (byte & 0x7F) << shift;
+            if(!(byte & 0x80) || !ok) return value;
+        }
+        ok = false;
+        return value;
+    }
+
+    float readFloat() {
+        const unsigned int bits = (unsigned int)le(4);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double readDouble() {
+        const unsigned long long bits = le(8);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+
+// Igualdad exacta: una vista que no ha cambiado no se vuelve a grabar
+static bool sameView(const ViewState &a, const ViewState &b) {
+
+    return a.camara.alpha == b.camara.alpha && a.camara.beta == b.camara.beta && a.camara.dist == b.camara.dist
+        && a.camara.offset == b.camara.offset && a.luz.posicion == b.luz.posicion && a.luz.encendida == b.luz.encendida;
+
+}
+
+InputRecorder::InputRecorder() : fileName(NULL), active(false), lastTick(0), numRecords(0), lastViewTick(0), numViews(0) {
+
+    lastView = ViewState();
+
+}
+
+//-----------------------------------------------------------------------------------
+// Empieza a grabar en memoria; el fichero se escribe entero al terminar (finish)
+//-----------------------------------------------------------------------------------
+bool InputRecorder::start(const char *file, unsigned int seed) {
+
+    fileName   = file;
+    lastTick   = 0;
+    numRecords = 0;
+    data.clear();
+    data.reserve(64 * 1024);
+    lastViewTick = 0;
+    numViews     = 0;
+    viewData.clear();
+    viewData.reserve(64 * 1024);
+    data.insert(data.end(), INPUT_RECORDING_MAGIC, INPUT_RECORDING_MAGIC + 4);
+    data.push_back(INPUT_RECORDING_VERSION);
+    putLE(data, 0, 3);
+    putLE(data, seed, 4);
+    putLE(data, floatBits(Simulation::STEP), 4);
+    active = true;
+    return true;
+
+}
+
+void InputRecorder::record(unsigned long long tick, const InputEvent &event) {
+
+    if(!active) return;
+    AllocScope scope(ALLOC_OTROS);   // La grabación crece sola: no cuenta como reserva del paso
+    const size_t tag = beginRecord(tick, (unsigned char)(INPUT_RECORD_KEY + event.type));
+    switch(event.type) {
+        case INPUT_KEY:
+            putVarint(data, (unsigned long long)(event.code + 1));
+            data.push_back((unsigned char)event.action);
+            break;
+        case INPUT_MOUSE_BUTTON:
+            data.push_back((unsigned char)event.code);
+            data.push_back((unsigned char)event.action);
+            putCoords(tag, event.x, event.y);
+            break;
+        case INPUT_CURSOR:
+        case INPUT_SCROLL:
+            putCoords(tag, event.x, event.y);
+            break;
+    }
+
+}
+
+void InputRecorder::record(unsigned long long tick, const SimCommand &command) {
+
+    if(!active) return;
+    AllocScope scope(ALLOC_OTROS);
+    beginRecord(tick, INPUT_RECORD_COMMAND);
+    data.push_back((unsigned char)command.type);
+    putLE(data, floatBits(command.value), 4);
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Vista con la que se ha dibujado la copia del mundo del paso tick (hilo de la ventana). Solo se
+// guarda si cambia: al repetir, cada paso usa la última grabada hasta él
+//------------------------------------------------------------------------------------------------
+void InputRecorder::recordView(unsigned long long tick, const ViewState &state) {
+
+    if(!active || (numViews > 0 && sameView(state, lastView))) return;
+    AllocScope scope(ALLOC_OTROS);
+    putVarint(viewData, tick >= lastViewTick ? tick - lastViewTick : 0);
+    lastViewTick = tick > lastViewTick ? tick : lastViewTick;
+    const float values[9] = { state.camara.alpha, state.camara.beta, state.camara.dist,
+                              state.camara.offset.x, state.camara.offset.y, state.camara.offset.z,
+                              state.luz.posicion.x, state.luz.posicion.y, state.luz.posicion.z };
+    for(int i = 0; i < 9; i++) putLE(viewData, floatBits(values[i]), 4);
+    viewData.push_back(state.luz.encendida ? 1 : 0);
+    lastView = state;
+    numViews++;
+
+}
+
+//----------------------------------------------------------------------------------
+// Cierra la grabación en el paso tick (donde termina la repetición) y la escribe
+//----------------------------------------------------------------------------------
+bool InputRecorder::finish(unsigned long long tick) {
+
+    if(!active) return false;
+    active = false;
+    beginRecord(tick, INPUT_RECORD_END);
+    data.insert(data.end(), viewData.begin(), viewData.end());
+
+    FILE *out = fopen(fileName, "wb");
+    if(!out) {
+        std::cerr << "No se puede crear la grabación de entrada " << fileName << std::endl;
+        return false;
+    }
+    const bool ok = fwrite(data.data(), 1, data.size(), out) == data.size();
+    fclose(out);
+    if(!ok) {
+        std::cerr << "Error al escribir la grabación de entrada " << fileName << std::endl;
+        return false;
+    }
+
+    char line[256];
+    snprintf(line, sizeof(line), "Entrada grabada en %s: %zu eventos y %zu vistas en %llu pasos (%.1f s), %zu bytes",
+             fileName, numRecords - 1, numViews, tick, tick * Simulation::STEP, data.size());
+    std::cout << line << std::endl;
+    return true;
+
+}
+
+// Pasos desde el registro anterior y etiqueta; devuelve dónde está la etiqueta
+size_t InputRecorder::beginRecord(unsigned long long tick, unsigned char type) {
+
+    putVarint(data, tick >= lastTick ? tick - lastTick : 0);
+    lastTick = tick > lastTick ? tick : lastTick;
+    numRecords++;
+    data.push_back(type);
+    return data.size() - 1;
+
+}
+
+void InputRecorder::putVarint(std::vector<unsigned char> &out, unsigned long long value) {
+
+    while(value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+
+}
+
+//------------------------------------------------------------------------------------------
+// Coordenadas en 2 bytes cada una si son enteras y caben, marcándolo en la etiqueta; si no,
+// en double para que la repetición reciba exactamente los mismos valores
+//------------------------------------------------------------------------------------------
+void InputRecorder::putCoords(size_t tagOffset, double x, double y) {
+
+    const bool shortX = x == std::floor(x) && x >= -32768.0 && x <= 32767.0;
+    const bool shortY = y == std::floor(y) && y >= -32768.0 && y <= 32767.0;
+    if(shortX && shortY) {
+        data[tagOffset] |= INPUT_RECORD_SHORT;
+        putLE(data, (unsigned long long)(unsigned short)(short)x, 2);
+        putLE(data, (unsigned long long)(unsigned short)(short)y, 2);
+    } else {
+        putLE(data, doubleBits(x), 8);
+        putLE(data, doubleBits(y), 8);
+    }
+
+}
+
+InputPlayer::InputPlayer() : loaded(false), semilla(0), finalTick(0), position(0) {
+}
+
+//--------------------------------------------------------------------------------------------
+// Lee y decodifica la grabación entera. Se rechaza si es de otra versión o de otro paso de
+// simulación, porque entonces no se repetiría igual
+//--------------------------------------------------------------------------------------------
+bool InputPlayer::load(const char *file) {
+
+    FILE *in = fopen(file, "rb");
+    if(!in) {
+        std::cerr << "No se puede abrir la grabación de entrada " << file << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> data;
+    unsigned char buffer[64 * 1024];
+    size_t read;
+    while((read = fread(buffer, 1, sizeof(buffer), in)) > 0) data.insert(data.end(), buffer, buffer + read);
+    fclose(in);
+
+    InputReader reader = { data.data(), data.size(), 0, true };
+    if(data.size() < INPUT_RECORDING_HEADER || std::memcmp(data.data(), INPUT_RECORDING_MAGIC, 4) != 0) {
+        std::cerr << file << " no es una grabación de entrada" << std::endl;
+        return false;
+    }
+    reader.position = 4;
+    const unsigned int version = (unsigned int)reader.le(4) & 0xFF;
+    semilla = (unsigned int)reader.le(4);
+    const float step = reader.readFloat();
+    if(version != INPUT_RECORDING_VERSION || step != Simulation::STEP) {
+        std::cerr << file << ": grabación de la versión " << version << " con pasos de " << step
+                  << " s; se necesita la versión " << (int)INPUT_RECORDING_VERSION << " con pasos de " << Simulation::STEP << " s" << std::endl;
+        return false;
+    }
+
+    records.clear();
+    unsigned long long tick = 0;
+    bool end = false;
+    while(reader.ok && !end && reader.position < reader.size) {
+        tick += reader.varint();
+        const unsigned char tag = (unsigned char)reader.le(1);
+        const int  type     = tag & 0x07;
+        const bool isShort  = (tag & INPUT_RECORD_SHORT) != 0;
+
+        InputRecord record = InputRecord();
+        record.tick = tick;
+        InputEvent &event = record.event;
+        event.time = tick * (double)Simulation::STEP;
+        switch(type) {
+            case INPUT_RECORD_KEY:
+                event.type   = INPUT_KEY;
+                event.code   = (int)reader.varint() - 1;
+                event.action = (int)reader.le(1);
+                break;
+            case INPUT_RECORD_MOUSE_BUTTON:
+                event.type   = INPUT_MOUSE_BUTTON;
+                event.code   = (int)reader.le(1);
+                event.action = (int)reader.le(1);
+                break;
+            case INPUT_RECORD_CURSOR:
+                event.type = INPUT_CURSOR;
+                break;
+            case INPUT_RECORD_SCROLL:
+                event.type = INPUT_SCROLL;
+                break;
+            case INPUT_RECORD_COMMAND:
+                record.isCommand     = true;
+                record.command.type  = (SimCommandType)reader.le(1);
+                record.command.value = reader.readFloat();
+                break;
+            case INPUT_RECORD_END:
+                end = true;
+                finalTick = tick;
+                continue;
+            default:
+                reader.ok = false;
+                continue;
+        }
+        if(type == INPUT_RECORD_MOUSE_BUTTON || type == INPUT_RECORD_CURSOR || type == INPUT_RECORD_SCROLL) {
+            event.x = isShort ? (short)reader.le(2) : reader.readDouble();
+            event.y = isShort ? (short)reader.le(2) : reader.readDouble();
+        }
+        if(reader.ok) records.push_back(record);
+    }
+
+    views.clear();
+    unsigned long long viewTick = 0;
+    while(reader.ok && end && reader.position < reader.size) {
+        ViewRecord view;
+        viewTick += reader.varint();
+        view.tick = viewTick;
+        float values[9];
+        for(int i = 0; i < 9; i++) values[i] = reader.readFloat();
+        view.state.camara.alpha  = values[0];
+        view.state.camara.beta   = values[1];
+        view.state.camara.dist   = values[2];
+        view.state.camara.offset = glm::vec3(values[3], values[4], values[5]);
+        view.state.luz.posicion  = glm::vec3(values[6], values[7], values[8]);
+        view.state.luz.encendida = reader.le(1) != 0;
+        if(reader.ok) views.push_back(view);
+    }
+    if(!reader.ok || !end) {
+        std::cerr << file << ": grabación incompleta o dañada" << std::endl;
+        return false;
+    }
+
+    position = 0;
+    loaded   = true;
+    char line[256];
+    snprintf(line, sizeof(line), "Repitiendo %s: %zu eventos y %zu vistas en %llu pasos (%.1f s), semilla %u",
+             file, records.size(), views.size(), finalTick, finalTick * Simulation::STEP, semilla);
+    std::cout << line << std::endl;
+    return true;
+
+}
+
+bool InputPlayer::next(unsigned long long tick, InputRecord &record) {
+
+    if(position == records.size() || records[position].tick > tick) return false;
+    record = records[position++];
+    return true;
+
+}
+
+bool InputPlayer::nextView(unsigned long long tick, ViewState &state, size_t &cursor) const {
+
+    if(cursor == views.size() || views[cursor].tick > tick) return false;
+    state = views[cursor++].state;
+    return true;
+
+}
@@ -0,0 +1,114 @@
+#ifndef INPUTRECORDING_H
+#define INPUTRECORDING_H
+
+#include <vector>
+#include <cstddef>
+
+#include "Simulation.h"
+#include "View.h"
+
+// Grabación binaria de la entrada que recibe la simulación, para repetir una sesión exactamente
+// (p. ej. para perfilar sin conexión una sesión lenta). Cada evento y cada orden se guardan con el
+// paso de simulación en el que se aplicaron, y la cabecera lleva la semilla: como la simulación
+// solo depende de la semilla y de lo que recibe en cada paso, repetir la grabación da el mismo
+// mundo paso a paso, con ventana o sin ella y a cualquier velocidad de frames. La cámara y la luz
+// dependen del ritmo de frames de la ventana, así que de ellas se graba el resultado: la vista de
+// cada frame (si cambió) con el paso del mundo que se dibujó con ella.
+//
+// Formato (little endian): "AQIN", versión (1 byte), 3 bytes a 0, semilla (4 bytes), duración
+// del paso (float). Después un registro por evento: pasos desde el anterior (varint), etiqueta
+// (1 byte: tipo en los 3 bits bajos y INPUT_RECORD_SHORT si las coordenadas van en 16 bits) y
+// los datos del tipo. El último registro es INPUT_RECORD_END, en el paso en que se dejó de grabar.
+// Tras él y hasta el final, las vistas: pasos desde la anterior (varint), cámara (alpha, beta,
+// dist y offset: 6 float), posición de la luz (3 float) y luz encendida (1 byte)
+enum InputRecordType {
+    INPUT_RECORD_KEY          = 0,   // código + 1 (varint), acción (1 byte)
+    INPUT_RECORD_MOUSE_BUTTON = 1,   // código (1 byte), acción (1 byte), x, y
+    INPUT_RECORD_CURSOR       = 2,   // x, y
+    INPUT_RECORD_SCROLL       = 3,   // x, y
+    INPUT_RECORD_COMMAND      = 4,   // orden (1 byte), valor (float)
+    INPUT_RECORD_END          = 7
+};
+
+// Coordenadas enteras que caben en 16 bits con signo (las del cursor casi siempre); si no, double
+const unsigned char INPUT_RECORD_SHORT = 0x08;
+
+// Un evento u orden leído de una grabación
+struct InputRecord {
+    unsigned long long tick;
+    bool               isCommand;
+    InputEvent         event;
+    SimCommand         command;
+};
+
+// La vista de un frame grabado y el paso del mundo que se dibujó con ella
+struct ViewRecord {
+    unsigned long long tick;
+    ViewState          state;
+};
+
+// Graba lo que aplica la simulación (desde su hilo) y la vista de cada frame (desde el de la
+// ventana, en su propia lista) y lo escribe en el fichero al terminar
+class InputRecorder {
+
+    public:
+
+        InputRecorder();
+
+        bool start (const char *file, unsigned int seed);
+        bool isActive() const { return active; }
+        void record(unsigned long long tick, const InputEvent &event);
+        void record(unsigned long long tick, const SimCommand &command);
+        void recordView(unsigned long long tick, const ViewState &state);
+        bool finish(unsigned long long tick);
+
+    private:
+
+        const char                *fileName;
+        bool                       active;
+        unsigned long long         lastTick;
+        size_t                     numRecords;
+        std::vector<unsigned char> data;
+        unsigned long long         lastViewTick;
+        size_t                     numViews;
+        ViewState                  lastView;
+        std::vector<unsigned char> viewData;   // Las vistas, que van tras el final de los eventos
+
+        size_t beginRecord(unsigned long long tick, unsigned char type);
+        void   putVarint  (std::vector<unsigned char> &out, unsigned long long value);
+        void   putBytes   (const void *bytes, size_t size);
+        void   putCoords  (size_t tagOffset, double x, double y);
+
+};
+
+// Grabación cargada en memoria; la simulación toma en cada paso los registros de ese paso y la
+// vista, en cada frame, la grabada para el paso que muestra
+class InputPlayer {
+
+    public:
+
+        InputPlayer();
+
+        bool load(const char *file);
+        bool isLoaded() const { return loaded; }
+
+        unsigned int       seed   () const { return semilla; }
+        unsigned long long endTick() const { return finalTick; }
+
+        // Siguiente registro de un paso hasta tick (false si no quedan). Las vistas llevan un cursor
+        // aparte, del hilo de la ventana
+        bool next    (unsigned long long tick, InputRecord &record);
+        bool nextView(unsigned long long tick, ViewState &state, size_t &cursor) const;
+
+    private:
+
+        bool                     loaded;
+        unsigned int             semilla;
+        unsigned long long       finalTick;
+        std::vector<InputRecord> records;
+        std::vector<ViewRecord>  views;
+        size_t                   position;
+
+};
+
+#endif /* INPUTRECORDING_H */
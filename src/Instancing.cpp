@@ -0,0 +1,76 @@
+#include "Instancing.h"
+
+//-----------------------------------------------------------------------------------------
+// Apunta los atributos por instancia del VAO enlazado al buffer, empezando en firstInstance
+// (GL 3.3 no tiene baseInstance, así que el desplazamiento va en el propio puntero)
+//-----------------------------------------------------------------------------------------
+void bindInstanceAttributes(GLuint buffer, size_t firstInstance) {
+
+    const size_t base = firstInstance * sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for(GLuint column = 0; column < 4; column++) {
+        GLuint location = INSTANCE_ATTRIB_MODEL + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                              (void *)(base + offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+    }
+    glVertexAttribPointer(INSTANCE_ATTRIB_COLOR, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void *)(base + offsetof(InstanceData, color)));
+    glVertexAttribDivisor(INSTANCE_ATTRIB_COLOR, 1);
+    glEnableVertexAttribArray(INSTANCE_ATTRIB_COLOR);
+    glVertexAttribPointer(INSTANCE_ATTRIB_PARAMS, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void *)(base + offsetof(InstanceData, params)));
+    glVertexAttribDivisor(INSTANCE_ATTRIB_PARAMS, 1);
+    glEnableVertexAttribArray(INSTANCE_ATTRIB_PARAMS);
+
+}
+
+InstanceBuffer::InstanceBuffer() : base(0) {
+
+}
+
+//--------------------------------------------------------------------------
+// Crea el anillo con sitio para capacity instancias por frame (crece si hace falta)
+//--------------------------------------------------------------------------
+void InstanceBuffer::init(size_t capacity) {
+
+    ring.init(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), "instancias");
+
+}
+
+void InstanceBuffer::beginFrame() {
+
+    ring.beginFrame();
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Reserva count instancias en la parte del frame. La reserva se alinea al tamaño de instancia
+// para que su posición se pueda expresar como índice de la primera instancia (baseInstance)
+//--------------------------------------------------------------------------------------------
+InstanceData* InstanceBuffer::map(size_t count) {
+
+    if(count == 0) return NULL;
+    size_t offset;
+    InstanceData *data = (InstanceData *)ring.allocate(count * sizeof(InstanceData), sizeof(InstanceData), offset);
+    base = offset / sizeof(InstanceData);
+    return data;
+
+}
+
+//-----------------------------------------------
+// Termina la escritura (antes de dibujar con él)
+//-----------------------------------------------
+void InstanceBuffer::unmap() {
+
+    ring.commit();
+
+}
+
+//-------------------------------------------------------------
+// Después de los dibujos del frame: protege su parte del anillo
+//-------------------------------------------------------------
+void InstanceBuffer::endFrame() {
+
+    ring.endFrame();
+
+}
@@ -0,0 +1,56 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <cstddef>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "RingBuffer.h"
+
+// Atributos por instancia del vertex shader (la matriz ocupa cuatro posiciones seguidas)
+const GLuint INSTANCE_ATTRIB_MODEL  = 3;
+const GLuint INSTANCE_ATTRIB_COLOR  = 7;
+const GLuint INSTANCE_ATTRIB_PARAMS = 8;
+
+// Datos de una instancia: matriz de modelo, color y parámetros de animación y material
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;
+    glm::vec4 params;   // x: tiempo de animación, y: animar cola, z: capa de textura, w: usar textura
+};
+
+// Rango de instancias consecutivas de un mismo dibujo dentro del buffer del frame
+struct InstanceRange {
+    size_t first;
+    size_t count;
+};
+
+void bindInstanceAttributes(GLuint buffer, size_t firstInstance);
+
+// Buffer de instancias que se vuelve a rellenar cada frame: es un anillo de RING_BUFFER_FRAMES
+// partes proyectado en memoria, así que los hilos de trabajo escriben directamente en él sin
+// pisar datos que la GPU todavía está leyendo
+class InstanceBuffer {
+
+    public:
+
+        InstanceBuffer();
+
+        void          init      (size_t capacity);
+        void          beginFrame();
+        InstanceData* map       (size_t count);
+        void          unmap     ();
+        void          endFrame  ();
+
+        GLuint                 getId()        const { return ring.getId(); }
+        size_t                 baseInstance() const { return base; }
+        const RingBufferStats& getStats()     const { return ring.getStats(); }
+
+    private:
+
+        RingBuffer ring;
+        size_t     base;    // Primera instancia de la reserva del frame dentro del buffer
+
+};
+
+#endif /* INSTANCING_H */
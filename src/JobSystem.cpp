@@ -0,0 +1,447 @@
+#include "JobSystem.h"
+#include "Trace.h"
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+
+// Tareas de una cola. Solo el dueño de la cola las toma (busy a true); las suelta quien las ejecute
+struct JobSystem::JobPool {
+    Job jobs[JOB_POOL_SIZE];
+    int next;
+
+    JobPool() : next(0) {}
+};
+
+// Cola que usa el hilo actual en cada sistema (los hilos de trabajo la reciben al arrancar)
+struct ThreadQueue {
+    const JobSystem *system;
+    int              index;
+};
+
+static thread_local ThreadQueue threadQueue = { NULL, -1 };
+
+// Tareas en ejecución anidadas en el hilo actual (para no contar dos veces el tiempo ocupado)
+static thread_local int nestedJobs = 0;
+
+// Intentos de encontrar trabajo antes de dormir un hilo ocioso
+const int JOB_SPINS_BEFORE_SLEEP = 64;
+
+JobSystem::Queue::Queue() : top(0), bottom(0) {
+
+    for(int i = 0; i < JOB_QUEUE_SIZE; i++) jobs[i].store(NULL, std::memory_order_relaxed);
+
+}
+
+//------------------------------------------------------------------
+// Mete una tarea por abajo (solo el dueño). false si la cola está llena
+//------------------------------------------------------------------
+bool JobSystem::Queue::push(Job *job) {
+
+    long long b = bottom.load(std::memory_order_relaxed);
+    long long t = top.load(std::memory_order_acquire);
+    if(b - t >= JOB_QUEUE_SIZE) return false;
+    jobs[b & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+
+}
+
+//----------------------------------------------------------------------------------
+// Saca la última tarea metida (solo el dueño); compite con los ladrones por la última
+//----------------------------------------------------------------------------------
+Job* JobSystem::Queue::pop() {
+
+    long long b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long t = top.load(std::memory_order_relaxed);
+
+    Job *job = NULL;
+    if(t <= b) {
+        job = jobs[b & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+        if(t == b) {
+            if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) job = NULL;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+    } else {
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+
+}
+
+//---------------------------------------------------------------------
+// Roba la tarea más antigua (cualquier hilo). NULL si está vacía o perdió
+//---------------------------------------------------------------------
+Job* JobSystem::Queue::steal() {
+
+    long long t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long b = bottom.load(std::memory_order_acquire);
+    if(t >= b) return NULL;
+
+    Job *job = jobs[t & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+    if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return NULL;
+    return job;
+
+}
+
+bool JobSystem::Queue::empty() const {
+
+    return bottom.load(std::memory_order_acquire) <= top.load(std::memory_order_acquire);
+
+}
+
+//-------------------------------------------------------------------------
+// Por defecto un hilo por núcleo salvo uno, para el hilo que envía el trabajo
+//-------------------------------------------------------------------------
+JobSystem::JobSystem(unsigned int numWorkers) : numWorkers(0), queues(NULL), counters(NULL), pools(NULL), externalThreads(0), stopping(false), sleeping(0) {
+
+    startWorkers(numWorkers);
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Cambia el número de hilos de trabajo (0: uno menos que núcleos). Solo sin tareas en curso y sin
+// que lo haya usado otro hilo que el que llama: en el arranque, una vez leídas las opciones
+//------------------------------------------------------------------------------------------------
+void JobSystem::resize(unsigned int numWorkers) {
+
+    stopWorkers();
+    if(threadQueue.system == this) threadQueue.system = NULL;
+    externalThreads.store(0);
+    stopping.store(false);
+    startWorkers(numWorkers);
+
+}
+
+void JobSystem::startWorkers(unsigned int numWorkers) {
+
+    this->numWorkers = numWorkers;
+    if(this->numWorkers == 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        this->numWorkers = cores > 1 ? cores - 1 : 1;
+    }
+    queues   = new Queue[this->numWorkers + JOB_MAX_EXTERNAL_THREADS];
+    counters = new WorkerCounters[this->numWorkers + JOB_MAX_EXTERNAL_THREADS];
+    pools    = new JobPool[this->numWorkers + JOB_MAX_EXTERNAL_THREADS];
+    resetStats();
+    MemoryRegistry::add(MEMORIA_HOST, (unsigned long long)(size_t)this, MEMORIA_CPU,
+                        (sizeof(Queue) + sizeof(WorkerCounters) + sizeof(JobPool)) * (this->numWorkers + JOB_MAX_EXTERNAL_THREADS),
+                        "Job", "JobSystem", "colas y reservas de tareas");
+
+    for(unsigned int i = 0; i < this->numWorkers; i++) {
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, (int)i));
+    }
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Tarea libre de la reserva de la cola del hilo actual. Si no tiene cola o están todas ocupadas,
+// se crea una nueva en el heap
+//---------------------------------------------------------------------------------------------
+Job* JobSystem::allocateJob() {
+
+    int index = queueIndex();
+    if(index >= 0) {
+        JobPool &pool = pools[index];
+        for(int k = 0; k < JOB_POOL_SIZE; k++) {
+            Job &job = pool.jobs[pool.next];
+            pool.next = (pool.next + 1) & (JOB_POOL_SIZE - 1);
+            if(!job.busy.load(std::memory_order_acquire)) {
+                job.busy.store(true, std::memory_order_relaxed);
+                job.pooled = true;
+                return &job;
+            }
+        }
+    }
+    return new Job;
+
+}
+
+// Parte común de submit(), con la tarea ya guardada en el Job
+void JobSystem::submitJob(Job *job, JobCounter *counter, JobCounter *dependency) {
+
+    job->counter   = counter;
+    job->next      = NULL;
+    job->subsystem = AllocStats::threadSubsystem();
+    if(counter) counter->count.fetch_add(1, std::memory_order_relaxed);
+
+    if(dependency) {
+        while(dependency->lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+        bool pending = dependency->count.load(std::memory_order_acquire) != 0;
+        if(pending) {
+            job->next = dependency->waiting;
+            dependency->waiting = job;
+        }
+        dependency->lock.clear(std::memory_order_release);
+        if(pending) return;
+    }
+    schedule(job);
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Espera a que el contador llegue a cero ejecutando mientras tanto tareas propias o robadas, así
+// que se puede llamar desde dentro de otra tarea sin bloquear un hilo de trabajo
+//---------------------------------------------------------------------------------------------
+void JobSystem::wait(JobCounter &counter) {
+
+    int index = queueIndex();
+    unsigned int seed = (unsigned int)index * 2654435761u + 1u;
+    while(!counter.done()) {
+        bool stolen = false;
+        Job *job = index >= 0 ? findJob(index, seed, stolen) : NULL;
+        if(job) execute(job, index, stolen);
+        else std::this_thread::yield();
+    }
+
+ // La última tarea deja el contador a cero con su cerrojo cogido: hasta que lo suelte no se
+ // puede devolver el control (el contador suele estar en la pila de quien espera)
+    while(counter.lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+    counter.lock.clear(std::memory_order_release);
+
+}
+
+// Tamaño de los trozos de parallelFor(): unos cuatro por hilo, y no menos de minChunk
+size_t JobSystem::grainSize(size_t count, size_t minChunk) const {
+
+    if(minChunk == 0) minChunk = 1;
+    const size_t pieces = (size_t)(numWorkers + 1) * 4;
+    return std::max(minChunk, (count + pieces - 1) / pieces);
+
+}
+
+//---------------------------------------------------------------------------------
+// Uso de los hilos de trabajo (y de los hilos ajenos que han enviado o esperado tareas)
+//---------------------------------------------------------------------------------
+void JobSystem::getStats(std::vector<JobWorkerStats> &stats) const {
+
+    const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - statsStart).count();
+    stats.resize(numQueues());
+    for(size_t i = 0; i < stats.size(); i++) {
+        stats[i].jobs        = counters[i].jobs.load(std::memory_order_relaxed);
+        stats[i].steals      = counters[i].steals.load(std::memory_order_relaxed);
+        stats[i].busyMs      = counters[i].busyNs.load(std::memory_order_relaxed) / 1.0e6;
+        stats[i].utilization = elapsedMs > 0.0 ? stats[i].busyMs / elapsedMs : 0.0;
+    }
+
+}
+
+void JobSystem::resetStats() {
+
+    for(unsigned int i = 0; i < numWorkers + JOB_MAX_EXTERNAL_THREADS; i++) {
+        counters[i].jobs.store(0, std::memory_order_relaxed);
+        counters[i].steals.store(0, std::memory_order_relaxed);
+        counters[i].busyNs.store(0, std::memory_order_relaxed);
+    }
+    statsStart = std::chrono::steady_clock::now();
+
+}
+
+void JobSystem::printStats() const {
+
+    std::vector<JobWorkerStats> stats;
+    getStats(stats);
+
+    char line[256];
+    std::cout << "---- Sistema de tareas (" << numWorkers << " hilos) ----" << std::endl;
+    for(size_t i = 0; i < stats.size(); i++) {
+        snprintf(line, sizeof(line), "%-8s %2u  %8llu tareas  %8llu robadas  %10.1f ms  %5.1f %%",
+                 i < numWorkers ? "Hilo" : "Externo", (unsigned int)(i < numWorkers ? i : i - numWorkers),
+                 stats[i].jobs, stats[i].steals, stats[i].busyMs, stats[i].utilization * 100.0);
+        std::cout << line << std::endl;
+    }
+
+}
+
+//------------------------------------------------------------------------------------------
+// Cola del hilo actual. Los hilos ajenos reciben una la primera vez; si ya no quedan, -1
+//------------------------------------------------------------------------------------------
+int JobSystem::queueIndex() {
+
+    if(threadQueue.system == this) return threadQueue.index;
+
+    int external = externalThreads.fetch_add(1);
+    threadQueue.system = this;
+    threadQueue.index  = external < JOB_MAX_EXTERNAL_THREADS ? (int)numWorkers + external : -1;
+    return threadQueue.index;
+
+}
+
+int JobSystem::numQueues() const {
+
+    return (int)numWorkers + std::min(externalThreads.load(std::memory_order_acquire), JOB_MAX_EXTERNAL_THREADS);
+
+}
+
+//------------------------------------------------------------------------------------------
+// Mete la tarea en la cola del hilo actual y despierta a un hilo si hay alguno dormido. Sin
+// cola (o con ella llena) la tarea se ejecuta directamente
+//------------------------------------------------------------------------------------------
+void JobSystem::schedule(Job *job) {
+
+    int index = queueIndex();
+    if(index < 0 || !queues[index].push(job)) {
+        execute(job, index, false);
+        return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeUp.notify_one();
+    }
+
+}
+
+//---------------------------------------------------------------------------------
+// Tarea siguiente: primero de la cola propia y si está vacía, robada a otra al azar
+//---------------------------------------------------------------------------------
+Job* JobSystem::findJob(int index, unsigned int &seed, bool &stolen) {
+
+    Job *job = queues[index].pop();
+    stolen = false;
+    if(job) return job;
+
+    const int total = numQueues();
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    const int start = (int)(seed % (unsigned int)total);
+    for(int k = 0; k < total; k++) {
+        int victim = (start + k) % total;
+        if(victim == index) continue;
+        job = queues[victim].steal();
+        if(job) {
+            stolen = true;
+            return job;
+        }
+    }
+    return NULL;
+
+}
+
+void JobSystem::execute(Job *job, int index, bool stolen) {
+
+ // Las tareas que se ejecutan dentro de un wait() de otra ya cuentan en el tiempo de esta
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    nestedJobs++;
+    {
+        AllocScope scope(job->subsystem);
+        job->run(job);
+    }
+    nestedJobs--;
+    long long ns = nestedJobs == 0 ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() : 0;
+
+    if(index >= 0) {
+        WorkerCounters &counter = counters[index];
+        counter.jobs.store(counter.jobs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if(stolen) counter.steals.store(counter.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        counter.busyNs.store(counter.busyNs.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+    }
+
+    JobCounter *counter = job->counter;
+    if(job->pooled) job->busy.store(false, std::memory_order_release);
+    else delete job;
+    if(counter) finish(counter);
+
+}
+
+//--------------------------------------------------------------------------------------
+// Una tarea menos en el contador; al llegar a cero se encolan las tareas que dependían de él
+//--------------------------------------------------------------------------------------
+void JobSystem::finish(JobCounter *counter) {
+
+    Job *released = NULL;
+    while(counter->lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+    if(counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        released = counter->waiting;
+        counter->waiting = NULL;
+    }
+    counter->lock.clear(std::memory_order_release);
+
+    while(released) {
+        Job *next = released->next;
+        schedule(released);
+        released = next;
+    }
+
+}
+
+bool JobSystem::anyWork() const {
+
+    const int total = numQueues();
+    for(int i = 0; i < total; i++) {
+        if(!queues[i].empty()) return true;
+    }
+    return false;
+
+}
+
+//----------------------------------------------------------------------------------------
+// Bucle de cada hilo: ejecuta tareas propias o robadas; tras un rato sin trabajo se duerme
+//----------------------------------------------------------------------------------------
+void JobSystem::workerLoop(int index) {
+
+    threadQueue.system = this;
+    threadQueue.index  = index;
+    TRACE_THREAD(Trace::intern("tareas " + std::to_string(index)));
+
+    unsigned int seed = (unsigned int)index * 2654435761u + 1u;
+    int spins = 0;
+    for(;;) {
+        bool stolen = false;
+        Job *job = findJob(index, seed, stolen);
+        if(job) {
+            execute(job, index, stolen);
+            spins = 0;
+            continue;
+        }
+        if(stopping.load(std::memory_order_acquire)) return;
+        if(++spins < JOB_SPINS_BEFORE_SLEEP) {
+            std::this_thread::yield();
+            continue;
+        }
+
+     // Dormir: se vuelve a mirar con sleeping ya incrementado para no perder un aviso
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(!anyWork() && !stopping.load(std::memory_order_acquire)) wakeUp.wait(lock);
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+        spins = 0;
+    }
+
+}
+
+//------------------------------------------------------------
+// Destructor: termina las tareas pendientes y une los hilos
+//------------------------------------------------------------
+JobSystem::~JobSystem() {
+
+    stopWorkers();
+
+}
+
+void JobSystem::stopWorkers() {
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true, std::memory_order_release);
+    }
+    wakeUp.notify_all();
+    for(auto& worker : workers) worker.join();
+    workers.clear();
+
+    delete[] queues;
+    delete[] counters;
+    delete[] pools;
+    queues   = NULL;
+    counters = NULL;
+    pools    = NULL;
+    MemoryRegistry::remove(MEMORIA_HOST, (unsigned long long)(size_t)this);
+
+}
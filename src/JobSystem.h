@@ -0,0 +1,241 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+#include "AllocStats.h"
+
+// Capacidad de la cola de cada hilo (potencia de 2). Si se llena, la tarea se ejecuta en el acto
+const int JOB_QUEUE_SIZE = 4096;
+
+// Hilos ajenos al sistema (ventana, simulación...) que pueden enviar tareas con su propia cola
+const int JOB_MAX_EXTERNAL_THREADS = 8;
+
+// Bytes de captura que caben dentro de la tarea; las lambdas mayores se guardan aparte (en el heap)
+const size_t JOB_TASK_SIZE = 64;
+
+// Tareas preparadas de antemano por cola: enviar una no reserva memoria mientras queden libres
+const int JOB_POOL_SIZE = 256;
+
+class JobCounter;
+
+// Tarea pendiente. La lambda se construye dentro de storage y run() la ejecuta y la destruye. Se
+// toma de la reserva de la cola del hilo que la envía y la devuelve el hilo que la ejecuta
+struct Job {
+    alignas(std::max_align_t) unsigned char storage[JOB_TASK_SIZE];
+    void             (*run)(Job *job);
+    JobCounter        *counter;
+    Job               *next;        // Siguiente en la lista de espera de una dependencia
+    AllocSubsystem     subsystem;   // La del hilo que la envió, para atribuirle sus reservas
+    bool               pooled;      // De una reserva (si no, se borra con delete)
+    std::atomic<bool>  busy;
+
+    Job() : run(NULL), counter(NULL), next(NULL), subsystem(ALLOC_OTROS), pooled(false), busy(false) {}
+};
+
+// Contador de tareas pendientes: submit() lo incrementa, cada tarea al terminar lo decrementa y
+// wait() vuelve cuando llega a cero. Otras tareas pueden depender de él (no empiezan hasta que
+// llegue a cero). Debe seguir vivo hasta que termine el wait() sobre él
+class JobCounter {
+
+    public:
+
+        JobCounter() : count(0), waiting(NULL) { lock.clear(); }
+
+        bool done() const { return count.load(std::memory_order_acquire) == 0; }
+
+    private:
+
+        friend class JobSystem;
+
+        std::atomic<int>  count;
+        std::atomic_flag  lock;       // Protege la lista de tareas en espera (no hay cerrojo global)
+        Job              *waiting;    // Tareas que dependen de este contador
+
+        JobCounter(const JobCounter &);
+        JobCounter& operator=(const JobCounter &);
+
+};
+
+// Uso de cada hilo de trabajo desde el último resetStats()
+struct JobWorkerStats {
+    unsigned long long jobs;          // Tareas ejecutadas
+    unsigned long long steals;        // De ellas, robadas a la cola de otro hilo
+    double             busyMs;        // Tiempo ejecutando tareas
+    double             utilization;   // busyMs / tiempo transcurrido
+};
+
+// Planificador de tareas con robo de trabajo: cada hilo tiene su propia cola (deque de Chase-Lev),
+// mete y saca tareas por un extremo y los hilos sin trabajo roban por el otro. Enviar y ejecutar
+// tareas no pasa por ningún cerrojo común; solo se usa uno para dormir a los hilos ociosos
+class JobSystem {
+
+    public:
+
+        explicit JobSystem(unsigned int numWorkers = 0);
+
+        template <class Task>
+        void submit     (Task &&task, JobCounter *counter = NULL, JobCounter *dependency = NULL);
+        void wait       (JobCounter &counter);
+        template <class Body>
+        void parallelFor(size_t count, size_t minChunk, const Body &body);
+
+        unsigned int size() const { return numWorkers; }
+        void         resize(unsigned int numWorkers);
+
+        void getStats  (std::vector<JobWorkerStats> &stats) const;
+        void resetStats();
+        void printStats() const;
+
+        virtual ~JobSystem();
+
+    private:
+
+        // Cola de doble extremo sin cerrojos: solo su dueño llama a push() y pop(); steal() desde cualquiera
+        class Queue {
+
+            public:
+
+                Queue();
+
+                bool push (Job *job);
+                Job* pop  ();
+                Job* steal();
+                bool empty() const;
+
+            private:
+
+             // Separados por relleno para que dueño y ladrones no se peleen por la misma línea de caché
+                std::atomic<long long> top;
+                char                   padTop[64 - sizeof(std::atomic<long long>)];
+                std::atomic<long long> bottom;
+                char                   padBottom[64 - sizeof(std::atomic<long long>)];
+                std::atomic<Job *>     jobs[JOB_QUEUE_SIZE];
+
+        };
+
+        // Contadores de un hilo: solo los escribe él, los demás los leen para las estadísticas
+        struct WorkerCounters {
+            std::atomic<unsigned long long> jobs;
+            std::atomic<unsigned long long> steals;
+            std::atomic<long long>          busyNs;
+            char                            pad[64 - 3 * sizeof(long long)];   // Una línea de caché por hilo
+        };
+
+        struct JobPool;
+
+        unsigned int                 numWorkers;
+        std::vector<std::thread>     workers;
+        Queue                       *queues;      // numWorkers de trabajo + JOB_MAX_EXTERNAL_THREADS ajenas
+        WorkerCounters              *counters;    // Una por cola
+        JobPool                     *pools;       // Una por cola
+        std::atomic<int>             externalThreads;
+        std::atomic<bool>            stopping;
+        std::atomic<int>             sleeping;
+        std::mutex                   sleepMutex;
+        std::condition_variable      wakeUp;
+        std::chrono::steady_clock::time_point statsStart;
+
+        void   startWorkers(unsigned int numWorkers);
+        void   stopWorkers ();
+        int    queueIndex ();
+        Job*   allocateJob();
+        void   submitJob  (Job *job, JobCounter *counter, JobCounter *dependency);
+        size_t grainSize  (size_t count, size_t minChunk) const;
+        void   schedule   (Job *job);
+        Job*   findJob    (int index, unsigned int &seed, bool &stolen);
+        void   execute    (Job *job, int index, bool stolen);
+        void   finish     (JobCounter *counter);
+        bool   anyWork    () const;
+        int    numQueues  () const;
+        template <class Body>
+        void   splitRange (size_t begin, size_t end, size_t grain, const Body &body, JobCounter *counter);
+        void   workerLoop (int index);
+
+        JobSystem(const JobSystem &);
+        JobSystem& operator=(const JobSystem &);
+
+};
+
+// Ejecuta y destruye una tarea guardada dentro del Job o en el heap
+template <class Task>
+void runInlineJob(Job *job) {
+
+    Task &task = *reinterpret_cast<Task *>(job->storage);
+    task();
+    task.~Task();
+
+}
+
+template <class Task>
+void runHeapJob(Job *job) {
+
+    Task *task = *reinterpret_cast<Task **>(job->storage);
+    (*task)();
+    delete task;
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Envía una tarea. Si hay contador, se cuenta en él hasta que termine; si hay dependencia, no se
+// empieza hasta que esta llegue a cero (entonces la encola el hilo que acabe la última tarea)
+//----------------------------------------------------------------------------------------------
+template <class Task>
+void JobSystem::submit(Task &&task, JobCounter *counter, JobCounter *dependency) {
+
+    typedef typename std::decay<Task>::type Stored;
+    Job *job = allocateJob();
+    if(sizeof(Stored) <= JOB_TASK_SIZE && alignof(Stored) <= alignof(std::max_align_t)) {
+        new (job->storage) Stored(std::forward<Task>(task));
+        job->run = &runInlineJob<Stored>;
+    } else {
+        *reinterpret_cast<Stored **>(job->storage) = new Stored(std::forward<Task>(task));
+        job->run = &runHeapJob<Stored>;
+    }
+    submitJob(job, counter, dependency);
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Reparte [0, count) en trozos de al menos minChunk elementos, ejecuta body(inicio, fin) sobre
+// cada uno y espera. El rango se parte por la mitad recursivamente: los ladrones se llevan las
+// mitades grandes y el reparto se equilibra solo. Con pocos elementos no se reparte
+//---------------------------------------------------------------------------------------------
+template <class Body>
+void JobSystem::parallelFor(size_t count, size_t minChunk, const Body &body) {
+
+    if(count == 0) return;
+    const size_t grain = grainSize(count, minChunk);
+    if(count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    splitRange(0, count, grain, body, &counter);
+    wait(counter);
+
+}
+
+template <class Body>
+void JobSystem::splitRange(size_t begin, size_t end, size_t grain, const Body &body, JobCounter *counter) {
+
+    while(end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        submit([this, mid, end, grain, &body, counter] { splitRange(mid, end, grain, body, counter); }, counter);
+        end = mid;
+    }
+    body(begin, end);
+
+}
+
+#endif /* JOBSYSTEM_H */
@@ -0,0 +1,23 @@
+#include "Lod.h"
+
+//--------------------------------------------------------------------------------------------
+// projection[1][1] es cot(fovY / 2): el radio a distancia d ocupa r * cot / d en NDC (alto 2)
+//--------------------------------------------------------------------------------------------
+float projectedSize(const glm::vec4 &sphere, const glm::vec3 &eye, const glm::mat4 &projection) {
+
+    float distance = glm::max(glm::distance(glm::vec3(sphere.x, sphere.y, sphere.z), eye), 1e-4f);
+    return sphere.w * projection[1][1] / distance;
+
+}
+
+//----------------------------------------------------------------------------------
+// Se parte del nivel actual y se mueve un nivel cada vez mientras se salga del margen
+//----------------------------------------------------------------------------------
+int selectLod(float size, int currentLod, const float *thresholds, int levels, float hysteresis) {
+
+    int lod = glm::clamp(currentLod, 0, levels - 1);
+    while(lod < levels - 1 && size < thresholds[lod] * (1.0f - hysteresis)) lod++;
+    while(lod > 0 && size > thresholds[lod - 1] * (1.0f + hysteresis)) lod--;
+    return lod;
+
+}
@@ -0,0 +1,14 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <glm/glm.hpp>
+
+// Tamaño proyectado de una esfera (centro y radio en mundo) en NDC (1 = media altura de pantalla)
+float projectedSize(const glm::vec4 &sphere, const glm::vec3 &eye, const glm::mat4 &projection);
+
+// Nivel de detalle para un tamaño proyectado: thresholds[i] es el tamaño por debajo del cual se
+// pasa del nivel i al i + 1 (decreciente). La histéresis evita que el nivel oscile en el umbral:
+// para bajar de detalle hay que quedar un margen por debajo y para subir un margen por encima
+int selectLod(float size, int currentLod, const float *thresholds, int levels, float hysteresis);
+
+#endif /* LOD_H */
@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+    #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : bytes(NULL), length(0), handle(NULL) {
+}
+
+MappedFile::MappedFile(MappedFile &&other) : bytes(other.bytes), length(other.length), handle(other.handle) {
+
+    other.bytes  = NULL;
+    other.length = 0;
+    other.handle = NULL;
+
+}
+
+MappedFile& MappedFile::operator=(MappedFile &&other) {
+
+    if(this != &other) {
+        close();
+        bytes  = other.bytes;
+        length = other.length;
+        handle = other.handle;
+        other.bytes  = NULL;
+        other.length = 0;
+        other.handle = NULL;
+    }
+    return *this;
+
+}
+
+//-----------------------------------------------------
+// Proyecta el fichero completo en memoria (solo lectura)
+//-----------------------------------------------------
+bool MappedFile::open(const char *fileName) {
+
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if(!mapping) return false;
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    bytes  = (const unsigned char *)view;
+    length = (size_t)fileSize.QuadPart;
+    handle = mapping;
+#else
+    int fd = ::open(fileName, O_RDONLY);
+    if(fd < 0) return false;
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void *view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(view == MAP_FAILED) return false;
+    bytes  = (const unsigned char *)view;
+    length = (size_t)info.st_size;
+#endif
+
+    return true;
+}
+
+//--------------------------
+// Deshace la proyección
+//--------------------------
+void MappedFile::close() {
+
+    if(!bytes) return;
+#ifdef _WIN32
+    UnmapViewOfFile(bytes);
+    CloseHandle((HANDLE)handle);
+#else
+    munmap((void *)bytes, length);
+#endif
+    bytes  = NULL;
+    length = 0;
+    handle = NULL;
+
+}
+
+MappedFile::~MappedFile() {
+
+    close();
+
+}
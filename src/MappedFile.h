@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+
+// Fichero proyectado en memoria de solo lectura (mmap en POSIX, MapViewOfFile en Windows)
+class MappedFile {
+
+    public:
+
+        MappedFile();
+        MappedFile(MappedFile &&other);
+        MappedFile& operator=(MappedFile &&other);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile& operator=(const MappedFile &) = delete;
+
+        bool open (const char *fileName);
+        void close();
+
+        const unsigned char* data() const { return bytes; }
+        size_t               size() const { return length; }
+        bool                 isOpen() const { return bytes != NULL; }
+
+        virtual ~MappedFile();
+
+    private:
+
+        const unsigned char *bytes;
+        size_t               length;
+        void                *handle;   // Solo en Windows: objeto de proyección
+
+};
+
+#endif /* MAPPEDFILE_H */
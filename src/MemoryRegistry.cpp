@@ -0,0 +1,248 @@
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <GL/glew.h>
+
+// Tamaño del nombre de recurso que se guarda (de rutas largas se queda el final)
+const size_t MEMORY_ASSET_SIZE = 48;
+
+// Entradas para las que se reserva sitio de una vez: registrar un objeto no suele reservar memoria
+const size_t MEMORY_RESERVED_ENTRIES = 256;
+
+// Líneas del desglose por recurso en el informe
+const int MEMORY_REPORT_ASSETS = 40;
+
+struct MemoryEntry {
+    MemoryObject        object;
+    unsigned long long  id;
+    MemoryCategory      category;
+    size_t              bytes;
+    const char         *format;
+    const char         *owner;
+    char                asset[MEMORY_ASSET_SIZE];
+};
+
+struct MemoryState {
+    std::mutex               mutex;
+    std::vector<MemoryEntry> entries;
+    MemoryUsage              categories[MEMORIA_CATEGORIES];
+    MemoryUsage              gpu;
+    MemoryUsage              cpu;
+};
+
+// Estado en una variable local estática: existe antes del primer uso aunque se registre desde el
+// constructor de un objeto global de otro fichero
+static MemoryState& state() {
+
+    static MemoryState memory;
+    return memory;
+
+}
+
+// Suma (o resta) un objeto en su categoría y en el total de su memoria, actualizando los máximos
+static void account(MemoryState &memory, MemoryCategory category, long long bytes, int objects) {
+
+    MemoryUsage *usages[2] = { &memory.categories[category], category == MEMORIA_CPU ? &memory.cpu : &memory.gpu };
+    for(MemoryUsage *usage : usages) {
+        usage->bytes    = (size_t)((long long)usage->bytes + bytes);
+        usage->objects += objects;
+        usage->peak     = std::max(usage->peak, usage->bytes);
+    }
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Añade un objeto, o le cambia el tamaño si ya estaba (p. ej. un buffer que se vuelve a crear
+// más grande con el mismo nombre). format y owner deben ser cadenas fijas; asset se copia
+//---------------------------------------------------------------------------------------------
+void MemoryRegistry::add(MemoryObject object, unsigned long long id, MemoryCategory category, size_t bytes,
+                         const char *format, const char *owner, const char *asset) {
+
+    MemoryState &memory = state();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    if(memory.entries.capacity() == 0) memory.entries.reserve(MEMORY_RESERVED_ENTRIES);
+
+    MemoryEntry *entry = NULL;
+    for(MemoryEntry &existing : memory.entries) {
+        if(existing.object == object && existing.id == id) entry = &existing;
+    }
+    if(entry) {
+        account(memory, entry->category, -(long long)entry->bytes, -1);
+    } else {
+        memory.entries.push_back(MemoryEntry());
+        entry = &memory.entries.back();
+        entry->object = object;
+        entry->id     = id;
+    }
+    entry->category = category;
+    entry->bytes    = bytes;
+    entry->format   = format ? format : "";
+    entry->owner    = owner ? owner : "";
+    const char *text   = asset ? asset : "";
+    const size_t length = std::strlen(text);
+    std::strcpy(entry->asset, text + (length >= MEMORY_ASSET_SIZE ? length - (MEMORY_ASSET_SIZE - 1) : 0));
+    account(memory, category, (long long)bytes, 1);
+
+}
+
+void MemoryRegistry::remove(MemoryObject object, unsigned long long id) {
+
+    MemoryState &memory = state();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    for(size_t i = 0; i < memory.entries.size(); i++) {
+        if(memory.entries[i].object != object || memory.entries[i].id != id) continue;
+        account(memory, memory.entries[i].category, -(long long)memory.entries[i].bytes, -1);
+        memory.entries[i] = memory.entries.back();
+        memory.entries.pop_back();
+        return;
+    }
+
+}
+
+MemoryUsage MemoryRegistry::usage(MemoryCategory category) {
+
+    MemoryState &memory = state();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    return memory.categories[category];
+
+}
+
+MemoryUsage MemoryRegistry::gpuUsage() {
+
+    MemoryState &memory = state();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    return memory.gpu;
+
+}
+
+MemoryUsage MemoryRegistry::cpuUsage() {
+
+    MemoryState &memory = state();
+    std::lock_guard<std::mutex> lock(memory.mutex);
+    return memory.cpu;
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Memoria en uso y máxima por categoría y después por recurso (los objetos sin recurso cuentan
+// con el nombre de su dueño), de mayor a menor
+//--------------------------------------------------------------------------------------------
+void MemoryRegistry::printReport() {
+
+    MemoryState &memory = state();
+    std::vector<MemoryEntry> assets;
+    MemoryUsage categories[MEMORIA_CATEGORIES];
+    MemoryUsage gpu, cpu;
+    {
+        std::lock_guard<std::mutex> lock(memory.mutex);
+        for(const MemoryEntry &entry : memory.entries) {
+            const char *key = entry.asset[0] ? entry.asset : entry.owner;
+            auto same = [&](const MemoryEntry &other) {
+                return other.category == entry.category && std::strcmp(other.asset[0] ? other.asset : other.owner, key) == 0;
+            };
+            auto found = std::find_if(assets.begin(), assets.end(), same);
+            if(found == assets.end()) {
+                assets.push_back(entry);
+            } else {
+                found->bytes += entry.bytes;
+                if(std::strcmp(found->format, entry.format) != 0) found->format = "varios";
+            }
+        }
+        std::copy(memory.categories, memory.categories + MEMORIA_CATEGORIES, categories);
+        gpu = memory.gpu;
+        cpu = memory.cpu;
+    }
+
+    char line[256];
+    std::cout << "---- Memoria ----" << std::endl;
+    snprintf(line, sizeof(line), "%-14s %12s %12s %8s", "Categoria", "Actual (KB)", "Maximo (KB)", "Objetos");
+    std::cout << line << std::endl;
+    for(int c = 0; c < MEMORIA_CATEGORIES; c++) {
+        snprintf(line, sizeof(line), "%-14s %12.1f %12.1f %8d", name((MemoryCategory)c),
+                 categories[c].bytes / 1024.0, categories[c].peak / 1024.0, categories[c].objects);
+        std::cout << line << std::endl;
+    }
+    snprintf(line, sizeof(line), "GPU: %.2f MB (maximo %.2f MB)  CPU: %.2f MB (maximo %.2f MB)",
+             gpu.bytes / 1048576.0, gpu.peak / 1048576.0, cpu.bytes / 1048576.0, cpu.peak / 1048576.0);
+    std::cout << line << std::endl;
+
+    std::sort(assets.begin(), assets.end(), [](const MemoryEntry &a, const MemoryEntry &b) { return a.bytes > b.bytes; });
+    snprintf(line, sizeof(line), "%-48s %-14s %-14s %-16s %10s", "Recurso", "Categoria", "Dueno", "Formato", "KB");
+    std::cout << line << std::endl;
+    for(size_t i = 0; i < assets.size() && i < (size_t)MEMORY_REPORT_ASSETS; i++) {
+        const MemoryEntry &asset = assets[i];
+        snprintf(line, sizeof(line), "%-48s %-14s %-14s %-16s %10.1f", asset.asset[0] ? asset.asset : asset.owner,
+                 name(asset.category), asset.owner, asset.format, asset.bytes / 1024.0);
+        std::cout << line << std::endl;
+    }
+    if(assets.size() > (size_t)MEMORY_REPORT_ASSETS) std::cout << "(" << assets.size() - MEMORY_REPORT_ASSETS << " recursos mas)" << std::endl;
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Los formatos comprimidos ocupan un bloque de 4x4 por cada 4x4 píxeles (aunque el nivel sea más
+// pequeño). RGB8 se cuenta con 4 bytes por píxel porque así lo guardan los drivers
+//------------------------------------------------------------------------------------------------
+size_t MemoryRegistry::textureBytes(int width, int height, int layers, unsigned int format, int levels) {
+
+    size_t blockBytes = 0;
+    size_t pixelBytes = 4;
+    switch(format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: blockBytes = 8;  break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: blockBytes = 16; break;
+        case GL_RED:
+        case GL_R8:                            pixelBytes = 1;  break;
+        default:                               pixelBytes = 4;  break;
+    }
+
+    size_t bytes = 0;
+    for(int level = 0; levels <= 0 || level < levels; level++) {
+        bytes += blockBytes ? (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes
+                            : (size_t)width * height * pixelBytes;
+        if(width == 1 && height == 1) break;
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return bytes * (size_t)std::max(1, layers);
+
+}
+
+const char* MemoryRegistry::formatName(unsigned int format) {
+
+    switch(format) {
+        case GL_RED:
+        case GL_R8:                            return "R8";
+        case GL_RGB:
+        case GL_RGB8:                          return "RGB8";
+        case GL_RGBA:
+        case GL_RGBA8:                         return "RGBA8";
+        case GL_DEPTH24_STENCIL8:              return "D24S8";
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "BC1";
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: return "BC2";
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+        default:                               return "?";
+    }
+
+}
+
+const char* MemoryRegistry::name(MemoryCategory category) {
+
+    switch(category) {
+        case MEMORIA_MALLAS:        return "mallas";
+        case MEMORIA_TEXTURAS:      return "texturas";
+        case MEMORIA_DINAMICA:      return "dinamica";
+        case MEMORIA_DESTINOS:      return "destinos";
+        case MEMORIA_TRANSFERENCIA: return "transferencia";
+        case MEMORIA_CPU:           return "cpu";
+        default:                    return "?";
+    }
+
+}
@@ -0,0 +1,59 @@
+#ifndef MEMORYREGISTRY_H
+#define MEMORYREGISTRY_H
+
+#include <cstddef>
+
+// Para qué se usa cada bloque de memoria. Todas están en la GPU salvo MEMORIA_CPU
+enum MemoryCategory {
+    MEMORIA_MALLAS,          // Vértices e índices de los modelos y del fondo
+    MEMORIA_TEXTURAS,        // Texturas, array de texturas y atlas del texto (con sus mipmaps)
+    MEMORIA_DINAMICA,        // Anillos de instancias y uniformes, vértices del texto
+    MEMORIA_DESTINOS,        // Color y profundidad de los framebuffers propios
+    MEMORIA_TRANSFERENCIA,   // PBOs de subida de texturas y de captura de frames
+    MEMORIA_CPU,             // Bloques grandes en memoria principal (colas, copias del mundo...)
+    MEMORIA_CATEGORIES
+};
+
+// Tipo de objeto: los nombres de OpenGL solo son únicos dentro de cada tipo. Los bloques de
+// memoria principal se identifican por su dirección
+enum MemoryObject {
+    MEMORIA_BUFFER,
+    MEMORIA_TEXTURA,
+    MEMORIA_RENDERBUFFER,
+    MEMORIA_HOST
+};
+
+// Bytes en uso y máximo alcanzado
+struct MemoryUsage {
+    size_t bytes;
+    size_t peak;
+    int    objects;
+};
+
+// Registro de la memoria que ocupa cada buffer, textura o bloque grande, con su formato, el
+// módulo que lo creó (dueño) y el recurso al que pertenece. Quien crea el objeto lo añade con su
+// tamaño (volver a añadirlo cambia el tamaño) y lo quita al borrarlo. Los tamaños de GPU son los
+// pedidos a OpenGL: el driver puede añadir relleno o alineación. Se puede llamar desde cualquier
+// hilo, también desde constructores de objetos globales
+class MemoryRegistry {
+
+    public:
+
+        static void add   (MemoryObject object, unsigned long long id, MemoryCategory category, size_t bytes,
+                           const char *format, const char *owner, const char *asset = NULL);
+        static void remove(MemoryObject object, unsigned long long id);
+
+        static MemoryUsage usage   (MemoryCategory category);
+        static MemoryUsage gpuUsage();   // Todas las categorías salvo MEMORIA_CPU
+        static MemoryUsage cpuUsage();
+
+        static void printReport();
+
+        // Bytes de una textura de width x height x layers con levels niveles (0: todos los mipmaps)
+        static size_t      textureBytes(int width, int height, int layers, unsigned int format, int levels);
+        static const char* formatName  (unsigned int format);
+        static const char* name        (MemoryCategory category);
+
+};
+
+#endif /* MEMORYREGISTRY_H */
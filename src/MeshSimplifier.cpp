@@ -0,0 +1,404 @@
+#include "MeshSimplifier.h"
+#include "MappedFile.h"
+
+#include <queue>
+#include <unordered_map>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace {
+
+    // Cuádrica simétrica 4x4 guardada como su triángulo superior (a², ab, ac, ad, b², bc, bd, c², cd, d²)
+    struct Quadric {
+        double q[10];
+    };
+
+    void addPlane(Quadric &Q, double a, double b, double c, double d, double weight) {
+        Q.q[0] += weight * a * a; Q.q[1] += weight * a * b; Q.q[2] += weight * a * c; Q.q[3] += weight * a * d;
+        Q.q[4] += weight * b * b; Q.q[5] += weight * b * c; Q.q[6] += weight * b * d;
+        Q.q[7] += weight * c * c; Q.q[8] += weight * c * d;
+        Q.q[9] += weight * d * d;
+    }
+
+    void addQuadric(Quadric &dst, const Quadric &src) {
+        for(int i = 0; i < 10; i++) dst.q[i] += src.q[i];
+    }
+
+    // Error de colocar el vértice en p: pᵀ Q p con p = (x, y, z, 1)
+    double evaluate(const Quadric &A, const Quadric &B, const glm::vec3 &p) {
+        double q[10];
+        for(int i = 0; i < 10; i++) q[i] = A.q[i] + B.q[i];
+        double x = p.x, y = p.y, z = p.z;
+        return q[0]*x*x + 2.0*q[1]*x*y + 2.0*q[2]*x*z + 2.0*q[3]*x
+             + q[4]*y*y + 2.0*q[5]*y*z + 2.0*q[6]*y
+             + q[7]*z*z + 2.0*q[8]*z
+             + q[9];
+    }
+
+    // Colapso candidato de la clase from a la clase to; las versiones detectan candidatos caducados
+    struct Collapse {
+        double   cost;
+        unsigned from;
+        unsigned to;
+        unsigned fromVersion;
+        unsigned toVersion;
+        bool operator<(const Collapse &other) const { return cost > other.cost; }
+    };
+
+    struct PositionKey {
+        uint32_t x, y, z;
+        bool operator==(const PositionKey &other) const { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct PositionHash {
+        size_t operator()(const PositionKey &k) const { return (k.x * 73856093u) ^ (k.y * 19349663u) ^ (k.z * 83492791u); }
+    };
+
+    // Peso de los planos que sujetan los bordes abiertos de la malla
+    const double BOUNDARY_WEIGHT = 10.0;
+
+    const uint32_t LOD_MAGIC   = 0x31444f4c;   // "LOD1"
+    const uint32_t LOD_VERSION = 1;
+
+    // Lectura secuencial con comprobación de límites sobre el fichero proyectado
+    struct Reader {
+        const unsigned char *data;
+        size_t               size;
+        size_t               offset;
+
+        bool read(void *dst, size_t bytes) {
+            if(bytes > size - offset) return false;
+            std::memcpy(dst, data + offset, bytes);
+            offset += bytes;
+            return true;
+        }
+
+        // Cuántos elementos de itemBytes caben en lo que queda: una cuenta mayor es un fichero dañado
+        size_t fits(size_t itemBytes) const { return (size - offset) / itemBytes; }
+    };
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Reduce una submesh hasta targetTriangles. Los vértices con la misma posición se tratan como uno
+// (clase) para no abrir grietas en las costuras de normales/UV; las clases de costura no se mueven.
+// No se colapsan aristas que crucen el plano z = lockPlaneZ, de forma que el anillo de la bisagra
+// de la cola y todo lo que queda a cada lado se mantiene
+//----------------------------------------------------------------------------------------------
+void MeshSimplifier::simplify(const SubMeshData &src, size_t targetTriangles, float lockPlaneZ, SubMeshData &dst) {
+
+    const size_t numVertices  = src.positions.size();
+    const size_t numTriangles = src.indices.size() / 3;
+    if(numTriangles <= targetTriangles || numVertices == 0) {
+        dst = src;
+        return;
+    }
+
+ // Clases de vértices por posición
+    std::vector<unsigned> classOf(numVertices);
+    std::vector<glm::vec3> classPos;
+    std::vector<unsigned> classVertex;          // Primer vértice de la clase
+    std::vector<unsigned> classVertexCount;
+    {
+        std::unordered_map<PositionKey, unsigned, PositionHash> lookup;
+        lookup.reserve(numVertices);
+        for(size_t v = 0; v < numVertices; v++) {
+            PositionKey key;
+            std::memcpy(&key.x, &src.positions[v].x, 4);
+            std::memcpy(&key.y, &src.positions[v].y, 4);
+            std::memcpy(&key.z, &src.positions[v].z, 4);
+            auto it = lookup.find(key);
+            if(it == lookup.end()) {
+                it = lookup.emplace(key, (unsigned)classPos.size()).first;
+                classPos.push_back(src.positions[v]);
+                classVertex.push_back((unsigned)v);
+                classVertexCount.push_back(0);
+            }
+            classOf[v] = it->second;
+            classVertexCount[it->second]++;
+        }
+    }
+    const size_t numClasses = classPos.size();
+
+    std::vector<unsigned> corners(src.indices.begin(), src.indices.end());
+    std::vector<char> triangleAlive(numTriangles, 1);
+    std::vector<std::vector<unsigned>> classTriangles(numClasses);
+    std::vector<Quadric> quadrics(numClasses, Quadric());
+    size_t liveTriangles = numTriangles;
+
+    auto cornerClass = [&](size_t t, int k) { return classOf[corners[t * 3 + k]]; };
+
+ // Cuádricas de los planos de las caras, ponderadas por el área
+    for(size_t t = 0; t < numTriangles; t++) {
+        glm::vec3 p0 = classPos[cornerClass(t, 0)], p1 = classPos[cornerClass(t, 1)], p2 = classPos[cornerClass(t, 2)];
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(n);
+        for(int k = 0; k < 3; k++) classTriangles[cornerClass(t, k)].push_back((unsigned)t);
+        if(length <= 0.0f) continue;
+        n /= length;
+        for(int k = 0; k < 3; k++) addPlane(quadrics[cornerClass(t, k)], n.x, n.y, n.z, -glm::dot(n, p0), 0.5 * length);
+    }
+
+ // Bordes abiertos: plano perpendicular a la cara que pasa por la arista
+    std::unordered_map<uint64_t, int> edgeUses;
+    for(size_t t = 0; t < numTriangles; t++) {
+        for(int k = 0; k < 3; k++) {
+            uint64_t a = cornerClass(t, k), b = cornerClass(t, (k + 1) % 3);
+            edgeUses[std::min(a, b) << 32 | std::max(a, b)]++;
+        }
+    }
+    for(size_t t = 0; t < numTriangles; t++) {
+        glm::vec3 p0 = classPos[cornerClass(t, 0)], p1 = classPos[cornerClass(t, 1)], p2 = classPos[cornerClass(t, 2)];
+        glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+        if(glm::length(faceNormal) <= 0.0f) continue;
+        faceNormal = glm::normalize(faceNormal);
+        for(int k = 0; k < 3; k++) {
+            uint64_t a = cornerClass(t, k), b = cornerClass(t, (k + 1) % 3);
+            if(edgeUses[std::min(a, b) << 32 | std::max(a, b)] != 1) continue;
+            glm::vec3 edge = classPos[b] - classPos[a];
+            glm::vec3 n = glm::cross(edge, faceNormal);
+            if(glm::length(n) <= 0.0f) continue;
+            n = glm::normalize(n);
+            double weight = BOUNDARY_WEIGHT * glm::dot(edge, edge);
+            addPlane(quadrics[a], n.x, n.y, n.z, -glm::dot(n, classPos[a]), weight);
+            addPlane(quadrics[b], n.x, n.y, n.z, -glm::dot(n, classPos[a]), weight);
+        }
+    }
+
+    std::vector<unsigned> version(numClasses, 0);
+    std::vector<char> removed(numClasses, 0);
+    std::priority_queue<Collapse> heap;
+
+    auto side = [&](unsigned c) { return classPos[c].z < lockPlaneZ; };
+
+ // Mejor dirección de colapso de la arista (a, b): solo se mueven clases que no son costura
+    auto pushEdge = [&](unsigned a, unsigned b) {
+        if(side(a) != side(b)) return;
+        Collapse best;
+        bool found = false;
+        if(classVertexCount[a] == 1) {
+            best.cost = evaluate(quadrics[a], quadrics[b], classPos[b]);
+            best.from = a;
+            best.to   = b;
+            found = true;
+        }
+        if(classVertexCount[b] == 1) {
+            double cost = evaluate(quadrics[a], quadrics[b], classPos[a]);
+            if(!found || cost < best.cost) {
+                best.cost = cost;
+                best.from = b;
+                best.to   = a;
+                found = true;
+            }
+        }
+        if(!found) return;
+        best.fromVersion = version[best.from];
+        best.toVersion   = version[best.to];
+        heap.push(best);
+    };
+
+    for(const auto& edge : edgeUses) pushEdge((unsigned)(edge.first >> 32), (unsigned)(edge.first & 0xffffffffu));
+
+    while(liveTriangles > targetTriangles && !heap.empty()) {
+        Collapse collapse = heap.top();
+        heap.pop();
+        const unsigned from = collapse.from, to = collapse.to;
+        if(removed[from] || removed[to] || version[from] != collapse.fromVersion || version[to] != collapse.toVersion) continue;
+
+     // La arista tiene que seguir existiendo y ninguna cara que sobrevive puede darse la vuelta
+        unsigned toVertex = classVertex[to];
+        bool adjacent = false, flips = false;
+        for(unsigned t : classTriangles[from]) {
+            if(!triangleAlive[t]) continue;
+            int fromCorner = -1, toCorner = -1;
+            for(int k = 0; k < 3; k++) {
+                if(cornerClass(t, k) == from) fromCorner = k;
+                if(cornerClass(t, k) == to)   toCorner = k;
+            }
+            if(toCorner >= 0) {
+                adjacent = true;
+                toVertex = corners[t * 3 + toCorner];
+                continue;
+            }
+            glm::vec3 p[3];
+            for(int k = 0; k < 3; k++) p[k] = classPos[cornerClass(t, k)];
+            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            p[fromCorner] = classPos[to];
+            glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if(glm::dot(before, after) <= 0.0f) {
+                flips = true;
+                break;
+            }
+        }
+        if(!adjacent || flips) continue;
+
+     // Colapso: las caras de la arista desaparecen y el resto pasa a usar el vértice destino
+        for(unsigned t : classTriangles[from]) {
+            if(!triangleAlive[t]) continue;
+            bool hasTo = false;
+            for(int k = 0; k < 3; k++) hasTo = hasTo || cornerClass(t, k) == to;
+            if(hasTo) {
+                triangleAlive[t] = 0;
+                liveTriangles--;
+                continue;
+            }
+            for(int k = 0; k < 3; k++) {
+                if(cornerClass(t, k) == from) corners[t * 3 + k] = toVertex;
+            }
+            classTriangles[to].push_back(t);
+        }
+        addQuadric(quadrics[to], quadrics[from]);
+        removed[from] = 1;
+        std::vector<unsigned>().swap(classTriangles[from]);
+        version[to]++;
+
+     // Compacta las caras del destino y recalcula los colapsos de sus vecinos
+        std::vector<unsigned> &triangles = classTriangles[to];
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(), [&](unsigned t) { return !triangleAlive[t]; }), triangles.end());
+        std::sort(triangles.begin(), triangles.end());
+        triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+        std::vector<unsigned> neighbours;
+        for(unsigned t : triangles) {
+            for(int k = 0; k < 3; k++) {
+                unsigned c = cornerClass(t, k);
+                if(c != to) neighbours.push_back(c);
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+        for(unsigned c : neighbours) pushEdge(to, c);
+    }
+
+ // Resultado: solo los vértices que siguen en uso, con sus atributos originales
+    std::vector<int> remap(numVertices, -1);
+    dst.materialName = src.materialName;
+    dst.positions.clear();
+    dst.normals.clear();
+    dst.textureCoords.clear();
+    dst.indices.clear();
+    dst.indices.reserve(liveTriangles * 3);
+    for(size_t t = 0; t < numTriangles; t++) {
+        if(!triangleAlive[t]) continue;
+        for(int k = 0; k < 3; k++) {
+            unsigned v = corners[t * 3 + k];
+            if(remap[v] < 0) {
+                remap[v] = (int)dst.positions.size();
+                dst.positions.push_back(src.positions[v]);
+                dst.normals.push_back(src.normals[v]);
+                dst.textureCoords.push_back(src.textureCoords[v]);
+            }
+            dst.indices.push_back((unsigned short)remap[v]);
+        }
+    }
+    dst.bounds = Model::computeBounds(dst.positions);
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Cadena de niveles: cada uno tiene la mitad de triángulos que el anterior y se obtiene de él
+//--------------------------------------------------------------------------------------------
+void MeshSimplifier::buildLods(const ModelData &model, int levels, float lockPlaneZ, std::vector<ModelData> &lods) {
+
+    lods.assign(levels, ModelData());
+    const ModelData *previous = &model;
+    for(int level = 0; level < levels; level++) {
+        lods[level].subMeshes.resize(previous->subMeshes.size());
+        for(size_t i = 0; i < previous->subMeshes.size(); i++) {
+            size_t target = model.subMeshes[i].indices.size() / 3 >> (level + 1);
+            simplify(previous->subMeshes[i], std::max<size_t>(target, 1), lockPlaneZ, lods[level].subMeshes[i]);
+        }
+        previous = &lods[level];
+    }
+
+}
+
+//--------------------------------------------------------------------------
+// Guarda los niveles en un fichero binario que se carga sin volver a simplificar
+//--------------------------------------------------------------------------
+bool MeshSimplifier::saveLods(const char *file, const std::vector<ModelData> &lods) {
+
+    FILE *out = std::fopen(file, "wb");
+    if(!out) {
+        std::cerr << "El fichero " << file << " no se puede crear." << std::endl;
+        return false;
+    }
+
+    uint32_t header[3] = { LOD_MAGIC, LOD_VERSION, (uint32_t)lods.size() };
+    bool ok = std::fwrite(header, sizeof(header), 1, out) == 1;
+    for(const auto& lod : lods) {
+        uint32_t count = (uint32_t)lod.subMeshes.size();
+        ok = ok && std::fwrite(&count, 4, 1, out) == 1;
+        for(const auto& subMesh : lod.subMeshes) {
+            uint32_t sizes[3] = { (uint32_t)subMesh.materialName.size(), (uint32_t)subMesh.positions.size(), (uint32_t)subMesh.indices.size() };
+            ok = ok && std::fwrite(sizes, sizeof(sizes), 1, out) == 1;
+            ok = ok && std::fwrite(subMesh.materialName.data(), 1, sizes[0], out) == sizes[0];
+            ok = ok && std::fwrite(subMesh.positions.data(), sizeof(glm::vec3), sizes[1], out) == sizes[1];
+            ok = ok && std::fwrite(subMesh.normals.data(), sizeof(glm::vec3), sizes[1], out) == sizes[1];
+            ok = ok && std::fwrite(subMesh.textureCoords.data(), sizeof(glm::vec2), sizes[1], out) == sizes[1];
+            ok = ok && std::fwrite(subMesh.indices.data(), sizeof(unsigned short), sizes[2], out) == sizes[2];
+        }
+    }
+    std::fclose(out);
+    return ok;
+
+}
+
+//----------------------------------------------------------------------------
+// Lee los niveles cocinados; devuelve false si el fichero no existe o es inválido
+//----------------------------------------------------------------------------
+bool MeshSimplifier::loadLods(const char *file, std::vector<ModelData> &lods) {
+
+    lods.clear();
+    MappedFile mapped;
+    if(!mapped.open(file)) return false;
+
+    Reader reader = { mapped.data(), mapped.size(), 0 };
+    uint32_t header[3];
+    if(!reader.read(header, sizeof(header)) || header[0] != LOD_MAGIC || header[1] != LOD_VERSION) return false;
+
+    // Las cuentas se comprueban contra lo que queda del fichero antes de reservar nada: cada nivel
+    // ocupa al menos su cuenta de submeshes y cada submesh al menos sus tres tamaños
+    if(header[2] > reader.fits(4)) return false;
+    lods.resize(header[2]);
+    for(auto& lod : lods) {
+        uint32_t count;
+        if(!reader.read(&count, 4) || count > reader.fits(3 * 4)) return false;
+        lod.subMeshes.resize(count);
+        for(auto& subMesh : lod.subMeshes) {
+            uint32_t sizes[3];
+            if(!reader.read(sizes, sizeof(sizes))) return false;
+            if(sizes[0] > reader.fits(1) || sizes[1] > reader.fits(2 * sizeof(glm::vec3) + sizeof(glm::vec2)) ||
+               sizes[2] > reader.fits(sizeof(unsigned short))) return false;
+            subMesh.materialName.resize(sizes[0]);
+            subMesh.positions.resize(sizes[1]);
+            subMesh.normals.resize(sizes[1]);
+            subMesh.textureCoords.resize(sizes[1]);
+            subMesh.indices.resize(sizes[2]);
+            if(!reader.read(&subMesh.materialName[0], sizes[0]) ||
+               !reader.read(subMesh.positions.data(), sizeof(glm::vec3) * sizes[1]) ||
+               !reader.read(subMesh.normals.data(), sizeof(glm::vec3) * sizes[1]) ||
+               !reader.read(subMesh.textureCoords.data(), sizeof(glm::vec2) * sizes[1]) ||
+               !reader.read(subMesh.indices.data(), sizeof(unsigned short) * sizes[2])) return false;
+            for(unsigned short index : subMesh.indices) {
+                if(index >= sizes[1]) return false;
+            }
+            subMesh.bounds = Model::computeBounds(subMesh.positions);
+        }
+    }
+    return true;
+
+}
+
+//----------------------------------------------------------
+// Nombre del fichero de niveles: el del modelo con extensión .lod
+//----------------------------------------------------------
+std::string MeshSimplifier::lodFile(const std::string &modelFile) {
+
+    size_t dot = modelFile.find_last_of('.');
+    size_t slash = modelFile.find_last_of("/\\");
+    if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) return modelFile + ".lod";
+    return modelFile.substr(0, dot) + ".lod";
+
+}
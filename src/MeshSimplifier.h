@@ -0,0 +1,29 @@
+#ifndef MESHSIMPLIFIER_H
+#define MESHSIMPLIFIER_H
+
+#include <vector>
+#include <string>
+#include <cfloat>
+
+#include "Model.h"
+
+// Valor de lockPlaneZ que no bloquea ningún colapso (todos los vértices quedan al mismo lado)
+const float NO_LOCK_PLANE = -FLT_MAX;
+
+// Simplificación por métrica de error cuadrático (QEM, Garland-Heckbert) con colapsos de arista
+// a uno de sus extremos: los vértices que quedan conservan su posición, normal y coordenadas de
+// textura originales, así que cualquier animación por vértice del shader sigue funcionando igual
+class MeshSimplifier {
+
+    public:
+
+        static void simplify (const SubMeshData &src, size_t targetTriangles, float lockPlaneZ, SubMeshData &dst);
+        static void buildLods(const ModelData &model, int levels, float lockPlaneZ, std::vector<ModelData> &lods);
+
+        static bool        saveLods(const char *file, const std::vector<ModelData> &lods);
+        static bool        loadLods(const char *file, std::vector<ModelData> &lods);
+        static std::string lodFile (const std::string &modelFile);
+
+};
+
+#endif /* MESHSIMPLIFIER_H */
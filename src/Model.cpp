@@ -1,9 +1,27 @@
 #include "Model.h"
+#include "Instancing.h"
+#include "RenderStats.h"
+#include "MemoryRegistry.h"
 
 //-----------------------------------------------------------------------------------------------------
 // Lee los atributos del modelo de un fichero de texto y los almacena creando submeshes por material
 //-----------------------------------------------------------------------------------------------------
 void Model::initModel(const char *modelFile) {
+
+    ModelData data;
+    if(!loadModelData(modelFile, data)) {
+        std::cout << "El fichero " << modelFile << " no se puede abrir." << std::endl;
+        std::cin.get();
+        exit(1);
+    }
+    uploadModel(data, modelFile);
+
+}
+
+//-----------------------------------------------------------------------------------------
+// Importa el modelo en memoria de CPU (no usa OpenGL, se puede llamar desde cualquier hilo)
+//-----------------------------------------------------------------------------------------
+bool Model::loadModelData(const char *modelFile, ModelData &data) {
    
  // Importa el modelo mediante la librería Assimp
     Assimp::Importer importer;
@@ -14,18 +32,13 @@ void Model::initModel(const char *modelFile) {
         aiProcess_GenSmoothNormals | 
         aiProcess_CalcTangentSpace | 
         aiProcess_GenUVCoords);
-    if(!scene) {
-        std::cout << "El fichero " << modelFile << " no se puede abrir." << std::endl;
-        std::cin.get();
-        exit(1);
-    }
+    if(!scene) return false;
   
  // Extraer cada mesh con su material
+    data.subMeshes.resize(scene->mNumMeshes);
     for (unsigned int meshIdx = 0; meshIdx < scene->mNumMeshes; meshIdx++) {
         aiMesh *mesh = scene->mMeshes[meshIdx];
-        
-        // Crear submesh
-        SubMesh subMesh;
+        SubMeshData &subMesh = data.subMeshes[meshIdx];
         
         // Obtener nombre del material
         if (mesh->mMaterialIndex >= 0 && mesh->mMaterialIndex < scene->mNumMaterials) {
@@ -37,31 +50,47 @@ void Model::initModel(const char *modelFile) {
             subMesh.materialName = "default";
         }
         
-        // Vectores temporales para esta submesh
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec3> normals;
-        std::vector<glm::vec2> textureCoords;
-        std::vector<unsigned short> indices;
-        
         // Cargar vértices, normales y coordenadas de textura
+        subMesh.positions.reserve(mesh->mNumVertices);
+        subMesh.normals.reserve(mesh->mNumVertices);
+        subMesh.textureCoords.reserve(mesh->mNumVertices);
         for(unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            positions.push_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
-            normals.push_back(glm::normalize(glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)));
+            subMesh.positions.push_back(glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z));
+            subMesh.normals.push_back(glm::normalize(glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z)));
             if(mesh->mTextureCoords[0]) 
-                textureCoords.push_back(glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y));
+                subMesh.textureCoords.push_back(glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y));
             else 
-                textureCoords.push_back(glm::vec2(0.0f, 0.0f));
+                subMesh.textureCoords.push_back(glm::vec2(0.0f, 0.0f));
         }
         
         // Cargar índices
+        subMesh.indices.reserve(mesh->mNumFaces * 3);
         for(unsigned int i = 0; i < mesh->mNumFaces; i++) {
             aiFace face = mesh->mFaces[i];
             for(unsigned int j = 0; j < face.mNumIndices; j++) {
-                indices.push_back(face.mIndices[j]);
+                subMesh.indices.push_back(face.mIndices[j]);
             }
         }
         
-        subMesh.indexCount = indices.size();
+        subMesh.bounds = computeBounds(subMesh.positions);
+    }
+    
+    return true;
+}
+
+//--------------------------------------------------------------------------------------------
+// Crea los VAO/VBO de cada submesh (debe llamarse desde el hilo del contexto). name es el
+// fichero del modelo, con el que sus buffers aparecen en el registro de memoria
+//--------------------------------------------------------------------------------------------
+void Model::uploadModel(const ModelData &data, const char *name) {
+
+    for(const auto& meshData : data.subMeshes) {
+        
+        // Crear submesh
+        SubMesh subMesh;
+        subMesh.materialName = meshData.materialName;
+        subMesh.indexCount = meshData.indices.size();
+        subMesh.bounds = meshData.bounds;
 
         // Crear VAO y VBOs para esta submesh
         glGenVertexArrays(1, &subMesh.vao);
@@ -73,26 +102,69 @@ void Model::initModel(const char *modelFile) {
         glBindVertexArray(subMesh.vao);
          // Posiciones
             glBindBuffer(GL_ARRAY_BUFFER, subMesh.vboPositions);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*positions.size(), &(positions.front()), GL_STATIC_DRAW);  
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*meshData.positions.size(), meshData.positions.data(), GL_STATIC_DRAW);  
             glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0); 
             glEnableVertexAttribArray(0);
          // Normales   
             glBindBuffer(GL_ARRAY_BUFFER, subMesh.vboNormals);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*normals.size(), &(normals.front()), GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*meshData.normals.size(), meshData.normals.data(), GL_STATIC_DRAW);
             glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0); 
             glEnableVertexAttribArray(1);
          // Texturas
             glBindBuffer(GL_ARRAY_BUFFER, subMesh.vboTextureCoords);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2)*textureCoords.size(), &(textureCoords.front()), GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec2)*meshData.textureCoords.size(), meshData.textureCoords.data(), GL_STATIC_DRAW);
             glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0); 
             glEnableVertexAttribArray(2);
          // Índices
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, subMesh.eboIndices);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short)*indices.size(), &(indices.front()), GL_STATIC_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned short)*meshData.indices.size(), meshData.indices.data(), GL_STATIC_DRAW);
         glBindVertexArray(0);
+        MemoryRegistry::add(MEMORIA_BUFFER, subMesh.vboPositions,     MEMORIA_MALLAS, sizeof(glm::vec3)*meshData.positions.size(),     "posiciones vec3", "Model", name);
+        MemoryRegistry::add(MEMORIA_BUFFER, subMesh.vboNormals,       MEMORIA_MALLAS, sizeof(glm::vec3)*meshData.normals.size(),       "normales vec3",   "Model", name);
+        MemoryRegistry::add(MEMORIA_BUFFER, subMesh.vboTextureCoords, MEMORIA_MALLAS, sizeof(glm::vec2)*meshData.textureCoords.size(), "uv vec2",         "Model", name);
+        MemoryRegistry::add(MEMORIA_BUFFER, subMesh.eboIndices,       MEMORIA_MALLAS, sizeof(unsigned short)*meshData.indices.size(),  "indices u16",     "Model", name);
+        RenderStats::countBufferBytes(sizeof(glm::vec3)*(meshData.positions.size() + meshData.normals.size()) +
+                                      sizeof(glm::vec2)*meshData.textureCoords.size() + sizeof(unsigned short)*meshData.indices.size());
         
         subMeshes.push_back(subMesh);
     }
+    
+ // Volumen de todo el modelo: unión de las cajas y esfera que contiene las de todas las submeshes
+    if(subMeshes.empty()) return;
+    bounds.min = subMeshes[0].bounds.min;
+    bounds.max = subMeshes[0].bounds.max;
+    for(const auto& subMesh : subMeshes) {
+        bounds.min = glm::min(bounds.min, subMesh.bounds.min);
+        bounds.max = glm::max(bounds.max, subMesh.bounds.max);
+    }
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    bounds.radius = 0.0f;
+    for(const auto& subMesh : subMeshes) {
+        bounds.radius = glm::max(bounds.radius, glm::distance(bounds.center, subMesh.bounds.center) + subMesh.bounds.radius);
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+// Caja envolvente de los vértices y esfera centrada en la caja que contiene todos los vértices
+//-----------------------------------------------------------------------------------------
+Bounds Model::computeBounds(const std::vector<glm::vec3> &positions) {
+
+    Bounds result;
+    result.min = result.max = result.center = glm::vec3(0.0f);
+    result.radius = 0.0f;
+    if(positions.empty()) return result;
+
+    result.min = result.max = positions[0];
+    for(const auto& position : positions) {
+        result.min = glm::min(result.min, position);
+        result.max = glm::max(result.max, position);
+    }
+    result.center = (result.min + result.max) * 0.5f;
+    for(const auto& position : positions) {
+        result.radius = glm::max(result.radius, glm::distance(result.center, position));
+    }
+    return result;
+
 }
 
 //--------------------------------
@@ -104,6 +176,24 @@ void Model::renderModel(unsigned long mode) {
         glBindVertexArray(subMesh.vao);
         glDrawElements(GL_TRIANGLES, subMesh.indexCount, GL_UNSIGNED_SHORT, (void *)0);
         glBindVertexArray(0);
+        RenderStats::countVao();
+        RenderStats::countDraw(subMesh.indexCount);
+    }
+}
+
+//---------------------------------------------------------------------------------------
+// Renderiza count instancias de todas las submeshes con los datos de instancia del buffer
+//---------------------------------------------------------------------------------------
+void Model::renderModelInstanced(unsigned long mode, GLuint instanceBuffer, size_t firstInstance, size_t count) {
+    if(count == 0) return;
+    glPolygonMode(GL_FRONT_AND_BACK, mode);
+    for(auto& subMesh : subMeshes) {
+        glBindVertexArray(subMesh.vao);
+        bindInstanceAttributes(instanceBuffer, firstInstance);
+        glDrawElementsInstanced(GL_TRIANGLES, subMesh.indexCount, GL_UNSIGNED_SHORT, (void *)0, (GLsizei)count);
+        glBindVertexArray(0);
+        RenderStats::countVao();
+        RenderStats::countDraw(subMesh.indexCount, count);
     }
 }
 
@@ -117,5 +207,9 @@ Model::~Model() {
         glDeleteBuffers(1, &subMesh.vboNormals);
         glDeleteBuffers(1, &subMesh.vboTextureCoords);
         glDeleteBuffers(1, &subMesh.eboIndices);
+        MemoryRegistry::remove(MEMORIA_BUFFER, subMesh.vboPositions);
+        MemoryRegistry::remove(MEMORIA_BUFFER, subMesh.vboNormals);
+        MemoryRegistry::remove(MEMORIA_BUFFER, subMesh.vboTextureCoords);
+        MemoryRegistry::remove(MEMORIA_BUFFER, subMesh.eboIndices);
     }
 }
@@ -13,6 +13,14 @@
 
 #define I glm::mat4(1.0)
 
+// Volúmenes envolventes en espacio del modelo: caja alineada con los ejes y esfera
+struct Bounds {
+    glm::vec3 min;
+    glm::vec3 max;
+    glm::vec3 center;
+    float     radius;
+};
+
 // Estructura para almacenar información de cada submesh con su material
 struct SubMesh {
     unsigned int vao;
@@ -22,6 +30,21 @@ struct SubMesh {
     unsigned int eboIndices;
     unsigned int indexCount;
     std::string materialName;
+    Bounds bounds;
+};
+
+// Datos de una submesh en memoria de CPU, antes de subirlos a la GPU
+struct SubMeshData {
+    std::string                 materialName;
+    std::vector<glm::vec3>      positions;
+    std::vector<glm::vec3>      normals;
+    std::vector<glm::vec2>      textureCoords;
+    std::vector<unsigned short> indices;
+    Bounds                      bounds;
+};
+
+struct ModelData {
+    std::vector<SubMeshData> subMeshes;
 };
 
 class Model {
@@ -29,14 +52,20 @@ class Model {
     public:
                         
         void initModel  (const char *modelFile);
+        void uploadModel(const ModelData &data, const char *name = NULL);
         void renderModel(unsigned long mode);
+        void renderModelInstanced(unsigned long mode, GLuint instanceBuffer, size_t firstInstance, size_t count);
+        static bool loadModelData(const char *modelFile, ModelData &data);
         std::vector<SubMesh>& getSubMeshes() { return subMeshes; }
+        const Bounds& getBounds() const { return bounds; }
+        static Bounds computeBounds(const std::vector<glm::vec3> &positions);
                
         virtual ~Model();
                
     private:
         
         std::vector<SubMesh> subMeshes;
+        Bounds               bounds;
 
 };
 
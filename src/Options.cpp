@@ -0,0 +1,168 @@
+#include "Options.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+
+//------------------------------------------------------------------
+// Lee las opciones; devuelve false si hay alguna que no se reconoce
+//------------------------------------------------------------------
+bool parseOptions(int argc, char **argv, Options &options) {
+
+    options.cookTextures     = false;
+    options.compressTextures = false;
+    options.cookModels       = false;
+    options.targetFps        = 0.0;
+    options.vsync            = VSYNC_ON;
+    options.captureFile      = NULL;
+    options.headless         = false;
+    options.width            = 1280;
+    options.height           = 720;
+    options.frames           = 300;
+    options.framesGiven      = false;
+    options.fixedDt          = 1.0 / 60.0;
+    options.seed             = 0;
+    options.dumpFrames       = NULL;
+    options.timingFile       = NULL;
+    options.firstFrame       = 0;
+    options.batch            = 0;
+    options.workers          = 0;
+    options.dynresBudgetMs   = 0.0;
+    options.dynresMinScale   = 0.5f;
+    options.upscale          = UPSCALE_SHARPEN;
+    options.gpuProfile       = false;
+    options.traceFile        = NULL;
+    options.traceSeconds     = 10.0;
+    options.percentiles      = false;
+    options.percentilesFile  = NULL;
+    options.hud              = false;
+    options.scenarioFile     = NULL;
+    options.scenarioCsv      = NULL;
+    options.recordFile       = NULL;
+    options.replayFile       = NULL;
+    options.allocCheck       = ALLOC_CHECK_OFF;
+    options.goldenFile       = NULL;
+    options.goldenUpdate     = false;
+    options.goldenOut        = "golden";
+
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if     (std::strcmp(arg, "--cook-textures") == 0) options.cookTextures = true;
+        else if(std::strcmp(arg, "--bc"           ) == 0) options.compressTextures = true;
+        else if(std::strcmp(arg, "--cook-models"  ) == 0) options.cookModels = true;
+        else if(std::strcmp(arg, "--fps"          ) == 0 && i + 1 < argc) options.targetFps = std::atof(argv[++i]);
+        else if(std::strcmp(arg, "--capture"      ) == 0 && i + 1 < argc) options.captureFile = argv[++i];
+        else if(std::strcmp(arg, "--headless"     ) == 0) options.headless = true;
+        else if(std::strcmp(arg, "--frames"       ) == 0 && i + 1 < argc) {
+            options.frames      = std::atoi(argv[++i]);
+            options.framesGiven = true;
+        }
+        else if(std::strcmp(arg, "--fixed-dt"     ) == 0 && i + 1 < argc) options.fixedDt = std::atof(argv[++i]);
+        else if(std::strcmp(arg, "--seed"         ) == 0 && i + 1 < argc) options.seed = (unsigned int)std::strtoul(argv[++i], NULL, 10);
+        else if(std::strcmp(arg, "--dump-frames"  ) == 0 && i + 1 < argc) options.dumpFrames = argv[++i];
+        else if(std::strcmp(arg, "--timing"       ) == 0 && i + 1 < argc) options.timingFile = argv[++i];
+        else if(std::strcmp(arg, "--first-frame"  ) == 0 && i + 1 < argc) options.firstFrame = std::max(0, std::atoi(argv[++i]));
+        else if(std::strcmp(arg, "--batch"        ) == 0 && i + 1 < argc) options.batch = std::max(0, std::atoi(argv[++i]));
+        else if(std::strcmp(arg, "--workers"      ) == 0 && i + 1 < argc) options.workers = std::max(0, std::atoi(argv[++i]));
+        else if(std::strcmp(arg, "--gpu-profile"  ) == 0) options.gpuProfile = true;
+        else if(std::strcmp(arg, "--trace"        ) == 0 && i + 1 < argc) options.traceFile = argv[++i];
+        else if(std::strcmp(arg, "--trace-seconds") == 0 && i + 1 < argc) options.traceSeconds = std::atof(argv[++i]);
+        else if(std::strcmp(arg, "--percentiles"  ) == 0) options.percentiles = true;
+        else if(std::strcmp(arg, "--hud"          ) == 0) options.hud = true;
+        else if(std::strcmp(arg, "--scenario"     ) == 0 && i + 1 < argc) options.scenarioFile = argv[++i];
+        else if(std::strcmp(arg, "--scenario-csv" ) == 0 && i + 1 < argc) options.scenarioCsv = argv[++i];
+        else if(std::strcmp(arg, "--record"       ) == 0 && i + 1 < argc) options.recordFile = argv[++i];
+        else if(std::strcmp(arg, "--replay"       ) == 0 && i + 1 < argc) options.replayFile = argv[++i];
+        else if(std::strcmp(arg, "--golden"       ) == 0 && i + 1 < argc) options.goldenFile = argv[++i];
+        else if(std::strcmp(arg, "--golden-update") == 0) options.goldenUpdate = true;
+        else if(std::strcmp(arg, "--golden-out"   ) == 0 && i + 1 < argc) options.goldenOut = argv[++i];
+        else if(std::strcmp(arg, "--percentiles-csv") == 0 && i + 1 < argc) options.percentilesFile = argv[++i];
+        else if(std::strcmp(arg, "--dynres"       ) == 0 && i + 1 < argc) options.dynresBudgetMs = std::atof(argv[++i]);
+        else if(std::strcmp(arg, "--res-min"      ) == 0 && i + 1 < argc) options.dynresMinScale = (float)std::atof(argv[++i]);
+        else if(std::strcmp(arg, "--upscale"      ) == 0 && i + 1 < argc) {
+            if(!parseUpscaleFilter(argv[++i], options.upscale)) {
+                std::cerr << "Filtro de escalado desconocido: " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if(std::strcmp(arg, "--size"         ) == 0 && i + 1 < argc) {
+            if(std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0) {
+                std::cerr << "Tamaño no válido (se espera <ancho>x<alto>): " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if(std::strcmp(arg, "--alloc-check"  ) == 0 && i + 1 < argc) {
+            if(!parseAllocCheckMode(argv[++i], options.allocCheck)) {
+                std::cerr << "Modo de comprobación de reservas desconocido: " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if(std::strcmp(arg, "--vsync"        ) == 0 && i + 1 < argc) {
+            if(!parseVsyncMode(argv[++i], options.vsync)) {
+                std::cerr << "Modo de vsync desconocido: " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else {
+            std::cerr << "Opción desconocida: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+
+}
+
+//-----------------------------
+// Muestra las opciones válidas
+//-----------------------------
+void printUsage(const char *program) {
+
+    std::cout << "Uso: " << program << " [opciones]" << std::endl
+              << "  --cook-textures   Genera las texturas cocinadas (.dds con mipmaps) y termina" << std::endl
+              << "  --bc              Comprime las texturas cocinadas en BC1/BC3 (S3TC)" << std::endl
+              << "  --cook-models     Genera los niveles de detalle simplificados (.lod) y termina" << std::endl
+              << "  --fps <n>         Limita los frames por segundo (0: sin limite, por defecto)" << std::endl
+              << "  --vsync <modo>    off, on (por defecto) o adaptive" << std::endl
+              << "  --capture <fich>  Graba los frames como RGB de 8 bits sin cabecera ('-': salida estandar)" << std::endl
+              << "  --seed <n>        Semilla de la simulacion (por defecto la hora; 1 sin ventana)" << std::endl
+              << "  --headless        Sin ventana: dibuja en un framebuffer propio (EGL u OSMesa) y termina" << std::endl
+              << "  --size <WxH>      Tamano del framebuffer sin ventana (por defecto 1280x720)" << std::endl
+              << "  --frames <n>      Frames que se dibujan sin ventana (por defecto 300; con escenario o" << std::endl
+              << "                    repeticion, como mucho n)" << std::endl
+              << "  --fixed-dt <s>    Tiempo simulado por frame sin ventana o con escenario (por defecto 1/60)" << std::endl
+              << "  --dump-frames <p> Guarda cada frame sin ventana como <p>_NNNNN.ppm" << std::endl
+              << "  --timing <fich>   Guarda el tiempo de cada frame sin ventana en CSV" << std::endl
+              << "  --first-frame <n> Sin ventana: avanza la simulacion hasta el frame n antes de dibujar" << std::endl
+              << "  --batch <n>       Reparte los frames entre n contextos sin ventana en paralelo y guarda" << std::endl
+              << "                    las imagenes numeradas (--dump-frames, por defecto 'frame')" << std::endl
+              << "  --workers <n>     Hilos del sistema de tareas (por defecto uno menos que nucleos; con" << std::endl
+              << "                    --batch, por defecto los nucleos repartidos entre los contextos)" << std::endl
+              << "  --dynres <ms>     Baja la resolucion interna para que la escena quepa en <ms> (0: no)" << std::endl
+              << "  --res-min <s>     Escala minima de la resolucion dinamica (por defecto 0.5)" << std::endl
+              << "  --upscale <f>     Escalado a la ventana: bilinear o sharpen (por defecto)" << std::endl
+              << "  --gpu-profile     Mide el tiempo de GPU de cada parte de la escena (una linea por segundo)" << std::endl
+              << "  --trace <fich>    Al salir guarda la traza de CPU en JSON de Chrome (compilado con AQUARIO_TRACE)" << std::endl
+              << "  --trace-seconds <s> Segundos de traza que se guardan, al salir o con F12 (por defecto 10)" << std::endl
+              << "  --percentiles     Al salir muestra p50/p90/p99/p99.9/max de frame, simulacion, render, swap" << std::endl
+              << "                    y GPU (en cualquier momento con F11)" << std::endl
+              << "  --percentiles-csv <fich> Guarda esos percentiles en CSV al salir" << std::endl
+              << "  --hud             Muestra los contadores de render, fps y tiempo simulado (se alterna con F3;" << std::endl
+              << "                    sin ventana se dibujan en cada frame)" << std::endl
+              << "  --scenario <fich> Reproduce un escenario con guion (camara, comida, peces, luz, ventilador)" << std::endl
+              << "                    a paso fijo y con semilla fija (1 por defecto), con o sin ventana, y" << std::endl
+              << "                    muestra el tiempo de frame de cada tramo (con ventana, mejor --vsync off)" << std::endl
+              << "  --scenario-csv <fich> Guarda esos tiempos por tramos en CSV" << std::endl
+              << "  --record <fich>   Graba en binario la entrada de la sesion, paso a paso, y la semilla" << std::endl
+              << "  --replay <fich>   Repite una grabacion con su semilla: el mismo mundo en cada paso, con" << std::endl
+              << "                    ventana o sin ella (termina donde termino la grabacion)" << std::endl
+              << "  --alloc-check <m> Reservas de memoria del render o la simulacion pasados los primeros" << std::endl
+              << "                    frames: log (una linea por frame) o assert (aborta en la reserva)" << std::endl
+              << "  --golden <fich>   Dibuja sin ventana cada escena de la lista (semilla, tiempo simulado y" << std::endl
+              << "                    escenario fijos) y la compara con su imagen de referencia; guarda las" << std::endl
+              << "                    diferencias y un informe, y falla si alguna se pasa de la tolerancia" << std::endl
+              << "  --golden-update   Con --golden, reescribe las imagenes de referencia con las dibujadas" << std::endl
+              << "  --golden-out <p>  Prefijo de las imagenes, diferencias, logs e informe (por defecto 'golden')" << std::endl;
+
+}
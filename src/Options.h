@@ -0,0 +1,50 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "FramePacer.h"
+#include "Upscaler.h"
+#include "AllocStats.h"
+
+// Opciones de la línea de órdenes
+struct Options {
+    bool cookTextures;       // --cook-textures: genera los .dds y termina
+    bool compressTextures;   // --bc: comprime los .dds en BC1/BC3
+    bool cookModels;         // --cook-models: genera los niveles de detalle (.lod) y termina
+    double    targetFps;     // --fps <n>: limita los frames por segundo (0: sin límite)
+    VsyncMode vsync;         // --vsync <off|on|adaptive>
+    const char *captureFile; // --capture <fichero|->: graba los frames en RGB sin cabecera (NULL: no)
+    bool headless;           // --headless: sin ventana, dibuja en un FBO con tiempo simulado fijo
+    int  width;              // --size <ancho>x<alto>: tamaño del FBO sin ventana
+    int  height;
+    int  frames;             // --frames <n>: frames que se dibujan sin ventana
+    bool framesGiven;        // --frames dado: limita también la duración de un escenario o repetición
+    double fixedDt;          // --fixed-dt <s>: tiempo simulado por frame sin ventana o con escenario
+    unsigned int seed;       // --seed <n>: semilla de la simulación (0: la hora, salvo sin ventana)
+    const char *dumpFrames;  // --dump-frames <prefijo>: guarda cada frame como <prefijo>_NNNNN.ppm
+    const char *timingFile;  // --timing <fichero>: tiempos por frame en CSV
+    int  firstFrame;         // --first-frame <n>: sin ventana, avanza hasta el frame n sin dibujarlo
+    int  batch;              // --batch <n>: reparte los frames entre n procesos sin ventana (0: no)
+    int  workers;            // --workers <n>: hilos del sistema de tareas (0: uno menos que núcleos)
+    double dynresBudgetMs;   // --dynres <ms>: resolución interna dinámica para ese tiempo de escena (0: no)
+    float  dynresMinScale;   // --res-min <escala>: escala mínima de la resolución dinámica
+    UpscaleFilter upscale;   // --upscale <bilinear|sharpen>: filtro al escalar a la ventana
+    bool gpuProfile;         // --gpu-profile: mide el tiempo de GPU de cada parte de la escena
+    const char *traceFile;   // --trace <fichero>: al salir vuelca la traza de CPU (JSON de Chrome)
+    double traceSeconds;     // --trace-seconds <s>: segundos de traza que se vuelcan (también con F12)
+    bool percentiles;        // --percentiles: al salir, percentiles de los tiempos de frame (también con F11)
+    const char *percentilesFile; // --percentiles-csv <fichero>: los mismos percentiles en CSV al salir
+    bool hud;                // --hud: contadores de render en pantalla desde el principio (también con F3)
+    const char *scenarioFile;    // --scenario <fichero>: reproduce un escenario con guion a paso fijo
+    const char *scenarioCsv;     // --scenario-csv <fichero>: percentiles de frame del escenario por tramos
+    const char *recordFile;      // --record <fichero>: graba la entrada de la sesión y su semilla
+    const char *replayFile;      // --replay <fichero>: repite una grabación de entrada (con o sin ventana)
+    AllocCheckMode allocCheck;   // --alloc-check <log|assert>: reservas de memoria en frames estables
+    const char *goldenFile;      // --golden <fichero>: compara escenas fijas con sus imágenes de referencia
+    bool goldenUpdate;           // --golden-update: reescribe las imágenes de referencia
+    const char *goldenOut;       // --golden-out <prefijo>: imágenes, diferencias, logs e informe de --golden
+};
+
+bool parseOptions(int argc, char **argv, Options &options);
+void printUsage  (const char *program);
+
+#endif /* OPTIONS_H */
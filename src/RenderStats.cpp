@@ -0,0 +1,16 @@
+#include "RenderStats.h"
+
+RenderCounters RenderStats::current  = RenderCounters();
+RenderCounters RenderStats::previous = RenderCounters();
+
+void RenderStats::beginFrame() {
+
+    current = RenderCounters();
+
+}
+
+void RenderStats::endFrame() {
+
+    previous = current;
+
+}
@@ -0,0 +1,50 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <cstddef>
+
+// Trabajo enviado a la GPU en un frame
+struct RenderCounters {
+    unsigned int       drawCalls;
+    unsigned long long triangles;
+    unsigned long long vertices;      // Vértices procesados (índices por instancias)
+    unsigned int       uniforms;      // Llamadas glUniform*
+    unsigned int       programBinds;
+    unsigned int       textureBinds;
+    unsigned int       vaoBinds;
+    unsigned long long bufferBytes;   // Bytes escritos en buffers (anillos, mallas, texturas)
+    unsigned int       culled;        // Objetos descartados por el volumen de visión
+};
+
+// Contadores de render por frame. Los incrementan Model, Shaders y los dibujos de main.cpp en el
+// momento de llamar a OpenGL, así que solo se usan desde el hilo del contexto. endFrame() guarda
+// el frame terminado, que es el que se muestra (el actual aún está a medias)
+class RenderStats {
+
+    public:
+
+        static void beginFrame();
+        static void endFrame  ();
+
+        static const RenderCounters& last() { return previous; }
+
+        static void countDraw  (unsigned int vertices, size_t instances = 1) {
+            current.drawCalls++;
+            current.vertices  += (unsigned long long)vertices * instances;
+            current.triangles += (unsigned long long)(vertices / 3) * instances;
+        }
+        static void countUniforms   (unsigned int count = 1) { current.uniforms += count; }
+        static void countProgram    ()                       { current.programBinds++; }
+        static void countTexture    (unsigned int count = 1) { current.textureBinds += count; }
+        static void countVao        ()                       { current.vaoBinds++; }
+        static void countBufferBytes(size_t bytes)           { current.bufferBytes += bytes; }
+        static void countCulled     (unsigned int count)     { current.culled += count; }
+
+    private:
+
+        static RenderCounters current;
+        static RenderCounters previous;
+
+};
+
+#endif /* RENDERSTATS_H */
@@ -0,0 +1,171 @@
+#include "RenderTarget.h"
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+RenderTarget::RenderTarget() : framebuffer(0), color(0), depth(0), width(0), height(0) {
+
+}
+
+//--------------------------------------------------------------------------
+// Crea (o vuelve a crear) el FBO con sus adjuntos; false si no queda completo
+//--------------------------------------------------------------------------
+bool RenderTarget::init(int width, int height) {
+
+    destroy();
+    this->width  = width;
+    this->height = height;
+
+    glGenTextures(1, &color);
+    glBindTexture(GL_TEXTURE_2D, color);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    char name[64];
+    snprintf(name, sizeof(name), "destino %dx%d", width, height);
+    MemoryRegistry::add(MEMORIA_TEXTURA,      color, MEMORIA_DESTINOS, MemoryRegistry::textureBytes(width, height, 1, GL_RGBA8, 1), "RGBA8", "RenderTarget", name);
+    MemoryRegistry::add(MEMORIA_RENDERBUFFER, depth, MEMORIA_DESTINOS, (size_t)width * height * 4, "D24S8", "RenderTarget", name);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "El framebuffer de " << width << "x" << height << " no está completo (0x" << std::hex << status << std::dec << ")" << std::endl;
+        destroy();
+        return false;
+    }
+    return true;
+
+}
+
+//------------------------------------------------------------
+// Dibuja a partir de ahora en este FBO, ocupándolo entero
+//------------------------------------------------------------
+void RenderTarget::bind() const {
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+
+}
+
+//--------------------------------------------------------------------------------------
+// Copia el color a memoria como RGB de 8 bits con la primera fila arriba (lectura síncrona)
+//--------------------------------------------------------------------------------------
+void RenderTarget::readPixels(std::vector<unsigned char> &rgb) const {
+
+    const size_t row = (size_t)width * 3;
+    std::vector<unsigned char> pixels(row * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+    rgb.resize(pixels.size());
+    for(int y = 0; y < height; y++) {
+        memcpy(rgb.data() + y * row, pixels.data() + (height - 1 - y) * row, row);
+    }
+
+}
+
+bool RenderTarget::savePPM(const char *file) const {
+
+    std::vector<unsigned char> rgb;
+    readPixels(rgb);
+    return writePPM(file, width, height, rgb.data());
+
+}
+
+void RenderTarget::destroy() {
+
+    if(framebuffer) glDeleteFramebuffers(1, &framebuffer);
+    if(depth) {
+        glDeleteRenderbuffers(1, &depth);
+        MemoryRegistry::remove(MEMORIA_RENDERBUFFER, depth);
+    }
+    if(color) {
+        glDeleteTextures(1, &color);
+        MemoryRegistry::remove(MEMORIA_TEXTURA, color);
+    }
+    framebuffer = 0;
+    depth = 0;
+    color = 0;
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+RenderTarget::~RenderTarget() {
+
+    destroy();
+
+}
+
+//------------------------------------------------------------------------
+// Guarda una imagen RGB de 8 bits (primera fila arriba) en formato PPM binario
+//------------------------------------------------------------------------
+bool writePPM(const char *file, int width, int height, const unsigned char *rgb) {
+
+    FILE *out = fopen(file, "wb");
+    if(!out) {
+        std::cerr << "No se puede crear la imagen " << file << std::endl;
+        return false;
+    }
+    fprintf(out, "P6\n%d %d\n255\n", width, height);
+    const size_t size = (size_t)width * height * 3;
+    bool ok = fwrite(rgb, 1, size, out) == size;
+    fclose(out);
+    return ok;
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Lee una imagen PPM binaria (P6) de 8 bits, admitiendo comentarios en la cabecera. false si no
+// existe o no tiene ese formato
+//---------------------------------------------------------------------------------------------
+bool readPPM(const char *file, int &width, int &height, std::vector<unsigned char> &rgb) {
+
+    FILE *in = fopen(file, "rb");
+    if(!in) return false;
+
+    int fields[3] = {0, 0, 0};
+    bool ok = fgetc(in) == 'P' && fgetc(in) == '6';
+    for(int f = 0; ok && f < 3; f++) {
+        int c = fgetc(in);
+        while(c == '#' || isspace(c)) {
+            if(c == '#') while(c != '\n' && c != EOF) c = fgetc(in);
+            c = fgetc(in);
+        }
+        ungetc(c, in);
+        ok = fscanf(in, "%d", &fields[f]) == 1 && fields[f] > 0;
+    }
+    ok = ok && fields[2] == 255 && isspace(fgetc(in));
+
+    if(ok) {
+        width  = fields[0];
+        height = fields[1];
+        rgb.resize((size_t)width * height * 3);
+        ok = fread(rgb.data(), 1, rgb.size(), in) == rgb.size();
+    }
+    fclose(in);
+    if(!ok) std::cerr << "La imagen " << file << " no es un PPM binario de 8 bits" << std::endl;
+    return ok;
+
+}
@@ -0,0 +1,42 @@
+#ifndef RENDERTARGET_H
+#define RENDERTARGET_H
+
+#include <vector>
+#include <GL/glew.h>
+
+// Framebuffer propio (FBO) de tamaño fijo: color RGBA8 en una textura y profundidad/stencil en un
+// renderbuffer. Permite dibujar la escena sin ventana o a una resolución distinta de la de esta
+class RenderTarget {
+
+    public:
+
+        RenderTarget();
+
+        bool init      (int width, int height);
+        void bind      () const;
+        void readPixels(std::vector<unsigned char> &rgb) const;
+        bool savePPM   (const char *file) const;
+
+        GLuint getFramebuffer() const { return framebuffer; }
+        GLuint getTexture()     const { return color; }
+        int    getWidth()       const { return width; }
+        int    getHeight()      const { return height; }
+
+        virtual ~RenderTarget();
+
+    private:
+
+        GLuint framebuffer;
+        GLuint color;
+        GLuint depth;
+        int    width;
+        int    height;
+
+        void destroy();
+
+};
+
+bool writePPM(const char *file, int width, int height, const unsigned char *rgb);
+bool readPPM (const char *file, int &width, int &height, std::vector<unsigned char> &rgb);
+
+#endif /* RENDERTARGET_H */
@@ -0,0 +1,161 @@
+#include "RingBuffer.h"
+#include "RenderStats.h"
+#include "MemoryRegistry.h"
+
+#include <chrono>
+#include <algorithm>
+
+RingBuffer::RingBuffer() : target(GL_ARRAY_BUFFER), name(NULL), buffer(0), frameSize(0), frame(0), used(0), persistentPtr(NULL), mapped(false) {
+
+    for(int i = 0; i < RING_BUFFER_FRAMES; i++) fences[i] = 0;
+    stats = RingBufferStats();
+
+}
+
+//--------------------------------------------------------------------
+// Crea el buffer con frameSize bytes por frame (hilo del contexto)
+//--------------------------------------------------------------------
+void RingBuffer::init(GLenum target, size_t frameSize, const char *name) {
+
+    this->target = target;
+    this->name   = name;
+    stats.persistent = GLEW_ARB_buffer_storage != 0;
+    create(frameSize);
+
+}
+
+//---------------------------------------------------------------------------------------------
+// Pasa a la siguiente parte. Con persistencia espera (midiendo el tiempo) a que la GPU termine
+// con lo que se escribió en ella hace RING_BUFFER_FRAMES frames; sin ella, al volver a la primera
+// parte el buffer se deja huérfano y el driver da memoria nueva sin esperar
+//---------------------------------------------------------------------------------------------
+void RingBuffer::beginFrame() {
+
+    frame = (frame + 1) % RING_BUFFER_FRAMES;
+    used  = 0;
+    stats.lastStallMs = 0.0;
+
+    if(stats.persistent) {
+        GLsync fence = fences[frame];
+        if(!fence) return;
+        fences[frame] = 0;
+        if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+            stats.lastStallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            stats.maxStallMs = std::max(stats.maxStallMs, stats.lastStallMs);
+            stats.totalStallMs += stats.lastStallMs;
+            stats.stalls++;
+        }
+        glDeleteSync(fence);
+    } else if(frame == 0) {
+        glBindBuffer(target, buffer);
+        glBufferData(target, frameSize * RING_BUFFER_FRAMES, NULL, GL_STREAM_DRAW);
+        glBindBuffer(target, 0);
+    }
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Reserva size bytes alineados en la parte del frame y devuelve dónde escribirlos; offset recibe
+// su posición en el buffer. Si la parte se queda pequeña el buffer se vuelve a crear con el doble
+// (esperando a la GPU), así que los offsets anteriores del mismo frame dejan de ser válidos
+//------------------------------------------------------------------------------------------------
+void* RingBuffer::allocate(size_t size, size_t alignment, size_t &offset) {
+
+    if(alignment == 0) alignment = 1;
+    size_t start = (used + alignment - 1) / alignment * alignment;
+    if(start + size > frameSize) {
+        if(mapped) commit();
+        glFinish();
+        destroy();
+        create(std::max(frameSize * 2, size + alignment));
+        stats.resizes++;
+        start = 0;
+    }
+    used   = start + size;
+    offset = frame * frameSize + start;
+    RenderStats::countBufferBytes(size);
+
+    if(stats.persistent) return persistentPtr + offset;
+
+    glBindBuffer(target, buffer);
+    void *data = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    glBindBuffer(target, 0);
+    mapped = data != NULL;
+    return data;
+
+}
+
+//----------------------------------------------------------------------
+// Termina la escritura de la última reserva (sin persistencia, desproyecta)
+//----------------------------------------------------------------------
+void RingBuffer::commit() {
+
+    if(!mapped) return;
+    glBindBuffer(target, buffer);
+    glUnmapBuffer(target);
+    glBindBuffer(target, 0);
+    mapped = false;
+
+}
+
+//--------------------------------------------------------------------------
+// Marca con un fence el final de los dibujos que leen la parte de este frame
+//--------------------------------------------------------------------------
+void RingBuffer::endFrame() {
+
+    commit();
+    if(!stats.persistent) return;
+    if(fences[frame]) glDeleteSync(fences[frame]);
+    fences[frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+}
+
+void RingBuffer::create(size_t frameSize) {
+
+    this->frameSize = frameSize;
+    frame = 0;
+    used  = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    const GLsizeiptr total = (GLsizeiptr)(frameSize * RING_BUFFER_FRAMES);
+    if(stats.persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, total, NULL, flags);
+        persistentPtr = (unsigned char *)glMapBufferRange(target, 0, total, flags);
+    } else {
+        glBufferData(target, total, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(target, 0);
+    MemoryRegistry::add(MEMORIA_BUFFER, buffer, MEMORIA_DINAMICA, (size_t)total, stats.persistent ? "persistente" : "huerfano", "RingBuffer", name);
+
+}
+
+void RingBuffer::destroy() {
+
+    for(int i = 0; i < RING_BUFFER_FRAMES; i++) {
+        if(fences[i]) glDeleteSync(fences[i]);
+        fences[i] = 0;
+    }
+    if(!buffer) return;
+    if(persistentPtr) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+        persistentPtr = NULL;
+    }
+    glDeleteBuffers(1, &buffer);
+    MemoryRegistry::remove(MEMORIA_BUFFER, buffer);
+    buffer = 0;
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+RingBuffer::~RingBuffer() {
+
+    destroy();
+
+}
@@ -0,0 +1,59 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <cstddef>
+#include <GL/glew.h>
+
+// Número de frames que la CPU puede adelantarse a la GPU con datos en vuelo
+const int RING_BUFFER_FRAMES = 3;
+
+// Tiempo que la CPU ha esperado a la GPU antes de poder reutilizar una parte del anillo
+struct RingBufferStats {
+    double       lastStallMs;    // En el último beginFrame()
+    double       maxStallMs;
+    double       totalStallMs;
+    unsigned int stalls;         // Frames en los que hubo que esperar
+    unsigned int resizes;        // Veces que una parte se ha quedado pequeña y el buffer ha crecido
+    bool         persistent;     // true: GL_ARB_buffer_storage; false: huérfano + mapeo sin sincronizar
+};
+
+// Buffer de datos dinámicos que se escriben cada frame dividido en RING_BUFFER_FRAMES partes. Con
+// GL_ARB_buffer_storage se proyecta una sola vez (persistente y coherente) y cada parte se protege
+// con un fence; sin la extensión el buffer se deja huérfano al volver al principio y cada reserva
+// se proyecta con GL_MAP_UNSYNCHRONIZED_BIT
+class RingBuffer {
+
+    public:
+
+        RingBuffer();
+
+        void  init      (GLenum target, size_t frameSize, const char *name = NULL);
+        void  beginFrame();
+        void* allocate  (size_t size, size_t alignment, size_t &offset);
+        void  commit    ();
+        void  endFrame  ();
+
+        GLuint                 getId()     const { return buffer; }
+        const RingBufferStats& getStats()  const { return stats; }
+
+        virtual ~RingBuffer();
+
+    private:
+
+        GLenum          target;
+        const char     *name;          // Para el registro de memoria
+        GLuint          buffer;
+        size_t          frameSize;     // Tamaño de cada parte
+        int             frame;         // Parte en uso
+        size_t          used;          // Bytes reservados en la parte en uso
+        unsigned char  *persistentPtr;
+        bool            mapped;        // Solo sin persistencia: hay una reserva proyectada
+        GLsync          fences[RING_BUFFER_FRAMES];
+        RingBufferStats stats;
+
+        void create (size_t frameSize);
+        void destroy();
+
+};
+
+#endif /* RINGBUFFER_H */
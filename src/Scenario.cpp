@@ -0,0 +1,333 @@
+#include "Scenario.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// Nombre de cada orden en el guion y cuántos valores numéricos admite
+struct ScenarioCommand {
+    const char     *name;
+    ScenarioAction  action;
+    int             minValues;
+    int             maxValues;
+};
+
+static const ScenarioCommand SCENARIO_COMMANDS[] = {
+    { "camara",        ESCENARIO_CAMARA,        3, 3 },
+    { "orbita",        ESCENARIO_ORBITA,        3, 3 },
+    { "zoom",          ESCENARIO_ZOOM,          2, 2 },
+    { "comida",        ESCENARIO_COMIDA,        0, 1 },
+    { "quitar_comida", ESCENARIO_QUITAR_COMIDA, 0, 0 },
+    { "peces",         ESCENARIO_PECES,         1, 1 },
+    { "luz",           ESCENARIO_LUZ,           0, 0 },   // Seguida de on u off
+    { "ventilador",    ESCENARIO_VENTILADOR,    1, 2 },
+    { "pausa",         ESCENARIO_PAUSA,         0, 0 },
+    { "marca",         ESCENARIO_MARCA,         0, 0 },   // Seguida del nombre del tramo
+    { "fin",           ESCENARIO_FIN,           0, 0 }
+};
+static const int NUM_SCENARIO_COMMANDS = sizeof(SCENARIO_COMMANDS) / sizeof(SCENARIO_COMMANDS[0]);
+
+// Margen al comparar tiempos acumulados frame a frame
+static const double SCENARIO_EPSILON = 1.0e-9;
+
+Scenario::Scenario() : fileName(NULL), loaded(false), next(0), tiempo(0.0), duracion(0.0), camaraLeida(false), camaraCambiada(false), numSegments(1) {
+
+    camara[0] = camara[1] = camara[2] = 0.0f;
+    std::strcpy(segmentNames[0], "inicio");
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Lee el guion. Las órdenes con el mismo tiempo se aplican en el orden del fichero. Sin "fin",
+// el escenario dura hasta que termina la última orden
+//--------------------------------------------------------------------------------------------
+bool Scenario::load(const char *file) {
+
+    FILE *in = fopen(file, "r");
+    if(!in) {
+        std::cerr << "No se puede abrir el escenario " << file << std::endl;
+        return false;
+    }
+
+    events.clear();
+    bool ok = true;
+    bool fin = false;
+    char line[512];
+    for(int lineNumber = 1; ok && fgets(line, sizeof(line), in); lineNumber++) {
+        char *comment = std::strchr(line, '#');
+        if(comment) *comment = '\0';
+
+        ScenarioEvent event = ScenarioEvent();
+        char word[SCENARIO_NAME_SIZE];
+        int  consumed = 0;
+        const int fields = std::sscanf(line, "%lf %31s%n", &event.time, word, &consumed);
+        if(fields <= 0) continue;   // Línea en blanco o solo comentario
+
+        const ScenarioCommand *command = NULL;
+        for(int c = 0; c < NUM_SCENARIO_COMMANDS && fields == 2; c++) {
+            if(std::strcmp(word, SCENARIO_COMMANDS[c].name) == 0) command = &SCENARIO_COMMANDS[c];
+        }
+        if(!command || event.time < 0.0) {
+            std::cerr << file << ":" << lineNumber << ": orden no válida (se espera <segundos> <orden> [valores])" << std::endl;
+            ok = false;
+            break;
+        }
+        event.action = command->action;
+
+        // Argumento de texto (luz, marca) o hasta tres números
+        const char *rest = line + consumed;
+        int numValues = 0;
+        if(event.action == ESCENARIO_LUZ || event.action == ESCENARIO_MARCA) {
+            char extra[2];
+            if(std::sscanf(rest, "%31s %1s", event.name, extra) != 1) numValues = -1;
+            else if(event.action == ESCENARIO_LUZ) {
+                if(std::strcmp(event.name, "on") == 0) event.values[0] = 1.0f;
+                else if(std::strcmp(event.name, "off") != 0) numValues = -1;
+            }
+        } else {
+            char *end = NULL;
+            for(;;) {
+                const float value = std::strtof(rest, &end);
+                if(end == rest) break;
+                if(numValues == 3) {
+                    numValues = -1;
+                    break;
+                }
+                event.values[numValues++] = value;
+                rest = end;
+            }
+            while(*rest == ' ' || *rest == '\t' || *rest == '\r' || *rest == '\n') rest++;
+            if(*rest != '\0' || numValues < command->minValues || numValues > command->maxValues) numValues = -1;
+        }
+        if(numValues < 0) {
+            std::cerr << file << ":" << lineNumber << ": valores no válidos para '" << command->name << "'" << std::endl;
+            ok = false;
+            break;
+        }
+
+        switch(event.action) {
+            case ESCENARIO_ORBITA:     event.duration = event.values[2]; break;
+            case ESCENARIO_ZOOM:       event.duration = event.values[1]; break;
+            case ESCENARIO_VENTILADOR: event.duration = numValues == 2 ? event.values[1] : 0.0; break;
+            case ESCENARIO_COMIDA:     if(numValues == 0) event.values[0] = 1.0f; break;
+            default: break;
+        }
+        event.duration = std::max(event.duration, 0.0);
+
+        if(event.action == ESCENARIO_FIN) {
+            duracion = fin ? std::min(duracion, event.time) : event.time;
+            fin = true;
+        } else {
+            events.push_back(event);
+        }
+    }
+    fclose(in);
+    if(!ok) return false;
+
+    std::stable_sort(events.begin(), events.end(), [](const ScenarioEvent &a, const ScenarioEvent &b) { return a.time < b.time; });
+    if(!fin) {
+        duracion = 0.0;
+        for(const ScenarioEvent &event : events) duracion = std::max(duracion, event.time + event.duration);
+    }
+    if(duracion <= 0.0) {
+        std::cerr << "El escenario " << file << " no dura nada: falta una orden 'fin' con su tiempo" << std::endl;
+        return false;
+    }
+
+    animations.reserve(events.size());   // Empezar una animación no reserva memoria a mitad de escenario
+    fileName = file;
+    loaded   = true;
+    std::cout << "Escenario " << file << ": " << events.size() << " ordenes, " << duracion << " s" << std::endl;
+    return true;
+
+}
+
+int Scenario::frames(double dt) const {
+
+    return dt > 0.0 ? (int)std::ceil(duracion / dt - SCENARIO_EPSILON) : 0;
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Un frame: envía el avance de las animaciones y las órdenes que ya tocan y después avanza la
+// simulación dt segundos (se aplican en su primer paso). Las animaciones van antes para que una
+// orden que empieza justo cuando acaba otra parta de su valor final
+//------------------------------------------------------------------------------------------------
+void Scenario::advance(Simulation &simulation, View &view, double dt) {
+
+    if(!camaraLeida) {
+        const Camara &actual = view.getCamara();
+        camara[0] = actual.alpha;
+        camara[1] = actual.beta;
+        camara[2] = actual.dist;
+        camaraLeida = true;
+    }
+
+    animate(simulation);
+    while(next < events.size() && events[next].time <= tiempo + SCENARIO_EPSILON) start(simulation, view, events[next++]);
+    if(camaraCambiada) {
+        postView(simulation, view, SIM_CAMARA_ALPHA, camara[0]);
+        postView(simulation, view, SIM_CAMARA_BETA,  camara[1]);
+        postView(simulation, view, SIM_CAMARA_DIST,  camara[2]);
+        camaraCambiada = false;
+    }
+
+    simulation.advance(dt);
+    tiempo += dt;
+
+}
+
+//------------------------------------------------------
+// Tiempo de un frame, en su tramo y en el total
+//------------------------------------------------------
+void Scenario::recordFrame(double ms) {
+
+    total.record(ms);
+    segments[numSegments - 1].record(ms);
+
+}
+
+void Scenario::printReport() const {
+
+    if(!loaded) return;
+    NamedHistogram histograms[SCENARIO_MAX_SEGMENTS + 1];
+    const int count = namedHistograms(histograms);
+    char title[256];
+    snprintf(title, sizeof(title), "Escenario %s: tiempo de frame por tramos (ms)", fileName);
+    printHistograms(title, histograms, count);
+
+}
+
+bool Scenario::writeCsv(const char *file) const {
+
+    NamedHistogram histograms[SCENARIO_MAX_SEGMENTS + 1];
+    const int count = namedHistograms(histograms);
+    return writeHistogramsCsv(file, histograms, count);
+
+}
+
+// El total y después cada tramo, en el orden del guion
+int Scenario::namedHistograms(NamedHistogram histograms[SCENARIO_MAX_SEGMENTS + 1]) const {
+
+    histograms[0].name      = "total";
+    histograms[0].histogram = &total;
+    for(int s = 0; s < numSegments; s++) {
+        histograms[s + 1].name      = segmentNames[s];
+        histograms[s + 1].histogram = &segments[s];
+    }
+    return numSegments + 1;
+
+}
+
+void Scenario::start(Simulation &simulation, View &view, const ScenarioEvent &event) {
+
+    switch(event.action) {
+        case ESCENARIO_CAMARA:
+            camara[0] = event.values[0];
+            camara[1] = event.values[1];
+            camara[2] = event.values[2];
+            camaraCambiada = true;
+            break;
+        case ESCENARIO_ORBITA:
+        case ESCENARIO_ZOOM:
+        case ESCENARIO_VENTILADOR: {
+            Animation animation;
+            animation.event   = event;
+            animation.start   = tiempo;
+            animation.applied = 0.0;
+            animation.delta[0] = animation.delta[1] = animation.delta[2] = 0.0f;
+            if(event.action == ESCENARIO_ORBITA) {
+                animation.delta[0] = event.values[0];
+                animation.delta[1] = event.values[1];
+            } else if(event.action == ESCENARIO_ZOOM) {
+                animation.delta[2] = event.values[0] - camara[2];
+            } else {
+                animation.delta[0] = event.values[0];
+            }
+            if(event.duration > 0.0) animations.push_back(animation);
+            else apply(simulation, animation, 1.0f);
+            break;
+        }
+        case ESCENARIO_COMIDA:
+            for(int i = 0; i < (int)event.values[0]; i++) simulation.post(SIM_ECHAR_COMIDA);
+            break;
+        case ESCENARIO_QUITAR_COMIDA:
+            simulation.post(SIM_QUITAR_COMIDA);
+            break;
+        case ESCENARIO_PECES:
+            simulation.post(SIM_PECES_VISIBLES, event.values[0]);
+            break;
+        case ESCENARIO_LUZ:
+            postView(simulation, view, SIM_LUZ, event.values[0]);
+            break;
+        case ESCENARIO_PAUSA:
+            simulation.post(SIM_PAUSAR);
+            break;
+        case ESCENARIO_MARCA:
+            marca(event.name);
+            break;
+        case ESCENARIO_FIN:
+            break;
+    }
+
+}
+
+//-------------------------------------------------------------------------------------------------
+// Orden de cámara o luz: la vista la aplica ya, para este frame, y la simulación solo la graba
+//-------------------------------------------------------------------------------------------------
+void Scenario::postView(Simulation &simulation, View &view, SimCommandType type, float value) {
+
+    view.post(type, value);
+    simulation.post(type, value);
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Aplica a cada animación la parte que le toca desde el frame anterior. Todas son incrementos,
+// así que varias a la vez sobre la misma cámara se suman
+//----------------------------------------------------------------------------------------------
+void Scenario::animate(Simulation &simulation) {
+
+    for(size_t i = 0; i < animations.size();) {
+        Animation &animation = animations[i];
+        const double fraction = std::min(1.0, (tiempo - animation.start) / animation.event.duration + SCENARIO_EPSILON);
+        apply(simulation, animation, (float)(fraction - animation.applied));
+        animation.applied = fraction;
+
+        if(animation.applied >= 1.0) animations.erase(animations.begin() + i);
+        else i++;
+    }
+
+}
+
+void Scenario::apply(Simulation &simulation, const Animation &animation, float fraction) {
+
+    if(fraction == 0.0f) return;
+    if(animation.event.action == ESCENARIO_VENTILADOR) {
+        simulation.post(SIM_MOVER_VENTILADOR, animation.delta[0] * fraction);
+    } else {
+        for(int k = 0; k < 3; k++) camara[k] += animation.delta[k] * fraction;
+        camaraCambiada = true;
+    }
+
+}
+
+//----------------------------------------------------------------------------------------
+// Empieza un tramo. Si el actual aún no tiene frames (p. ej. una marca en 0 s) se renombra
+//----------------------------------------------------------------------------------------
+void Scenario::marca(const char *name) {
+
+    if(segments[numSegments - 1].count() > 0) {
+        if(numSegments == SCENARIO_MAX_SEGMENTS) {
+            std::cerr << "Escenario: demasiados tramos, '" << name << "' cuenta en el anterior" << std::endl;
+            return;
+        }
+        numSegments++;
+    }
+    std::strncpy(segmentNames[numSegments - 1], name, SCENARIO_NAME_SIZE - 1);
+    segmentNames[numSegments - 1][SCENARIO_NAME_SIZE - 1] = '\0';
+
+}
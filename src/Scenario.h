@@ -0,0 +1,95 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <vector>
+
+#include "Simulation.h"
+#include "View.h"
+#include "Histogram.h"
+
+// Tramos con nombre (marca) en los que se reparten los tiempos de frame de un escenario
+const int SCENARIO_MAX_SEGMENTS = 16;
+const int SCENARIO_NAME_SIZE    = 32;
+
+enum ScenarioAction {
+    ESCENARIO_CAMARA,          // alpha beta dist: cámara fija
+    ESCENARIO_ORBITA,          // grados_alpha grados_beta segundos: giro relativo de la cámara
+    ESCENARIO_ZOOM,            // dist segundos: distancia final de la cámara
+    ESCENARIO_COMIDA,          // [n]: echa comida n veces (1 por defecto)
+    ESCENARIO_QUITAR_COMIDA,
+    ESCENARIO_PECES,           // n: peces visibles
+    ESCENARIO_LUZ,             // on|off: luz móvil
+    ESCENARIO_VENTILADOR,      // grados [segundos]: desplaza el ventilador alrededor de la pecera
+    ESCENARIO_PAUSA,           // pausa/reanuda los peces
+    ESCENARIO_MARCA,           // nombre: los frames siguientes cuentan en un tramo nuevo
+    ESCENARIO_FIN              // el escenario termina en este instante
+};
+
+struct ScenarioEvent {
+    double         time;       // Tiempo simulado (s)
+    ScenarioAction action;
+    float          values[3];
+    double         duration;   // Segundos de las animaciones (0: de golpe)
+    char           name[SCENARIO_NAME_SIZE];
+};
+
+// Escenario con guion para comparar el tiempo de frame entre versiones y máquinas. Un fichero de
+// texto con una orden por línea, "<segundos> <orden> [valores]" ('#' para comentarios), ordenadas
+// por tiempo. El escenario avanza la simulación a paso fijo (sin su hilo ni el reloj) y envía las
+// órdenes al llegar a su tiempo, así que con la misma semilla cada frame ve el mismo mundo con
+// ventana y sin ella. La cámara se envía a la vista cada frame que cambia como valores absolutos
+class Scenario {
+
+    public:
+
+        Scenario();
+
+        bool load(const char *file);
+        bool isLoaded() const { return loaded; }
+        int  frames  (double dt) const;   // Frames de dt segundos que dura el escenario
+        bool finished() const { return tiempo >= duracion - 1.0e-9; }
+
+        void advance    (Simulation &simulation, View &view, double dt);
+        void recordFrame(double ms);
+
+        void printReport() const;
+        bool writeCsv   (const char *file) const;
+
+    private:
+
+        // Animación en curso: cuánto cambia en total y qué fracción se ha aplicado ya
+        struct Animation {
+            ScenarioEvent event;
+            double        start;
+            float         delta[3];
+            double        applied;
+        };
+
+        const char                *fileName;
+        bool                       loaded;
+        std::vector<ScenarioEvent> events;
+        std::vector<Animation>     animations;
+        size_t                     next;
+        double                     tiempo;
+        double                     duracion;
+
+        // Cámara según el escenario (alpha, beta, dist); se lee del mundo en el primer avance
+        bool                       camaraLeida;
+        bool                       camaraCambiada;
+        float                      camara[3];
+
+        Histogram                  total;
+        Histogram                  segments[SCENARIO_MAX_SEGMENTS];
+        char                       segmentNames[SCENARIO_MAX_SEGMENTS][SCENARIO_NAME_SIZE];
+        int                        numSegments;
+
+        void start   (Simulation &simulation, View &view, const ScenarioEvent &event);
+        void postView(Simulation &simulation, View &view, SimCommandType type, float value);
+        void animate (Simulation &simulation);
+        void apply   (Simulation &simulation, const Animation &animation, float fraction);
+        void marca   (const char *name);
+        int  namedHistograms(NamedHistogram histograms[SCENARIO_MAX_SEGMENTS + 1]) const;
+
+};
+
+#endif /* SCENARIO_H */
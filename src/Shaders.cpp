@@ -1,4 +1,8 @@
 #include "Shaders.h"
+#include "RenderStats.h"
+
+#include <cstdio>
+#include <cstring>
 
 //--------------------------------------------------------------------------------------
 // Crea los shaders de vértices y fragmentos a partir del código fuente correspondiente
@@ -82,48 +86,62 @@ unsigned int Shaders::createProgram(unsigned int vShader, unsigned int fShader)
     return program;    
 }
 
+//-----------------------------------------------------
+// Fija el valor de una variable uniforme de tipo vec2
+//-----------------------------------------------------
+void Shaders::setVec2(const char *name, glm::vec2 value) {
+    
+   glUniform2fv(location(name), 1, glm::value_ptr(value));
+   RenderStats::countUniforms();
+    
+}
+
 //-----------------------------------------------------
 // Fija el valor de una variable uniforme de tipo vec3
 //-----------------------------------------------------
-void Shaders::setVec3(const std::string &name, glm::vec3 value) {
+void Shaders::setVec3(const char *name, glm::vec3 value) {
     
-   glUniform3fv(glGetUniformLocation(program,name.c_str()), 1, glm::value_ptr(value));
+   glUniform3fv(location(name), 1, glm::value_ptr(value));
+   RenderStats::countUniforms();
     
 }
 
 //-----------------------------------------------------
 // Fija el valor de una variable uniforme de tipo vec4
 //-----------------------------------------------------
-void Shaders::setVec4(const std::string &name, glm::vec4 value) {
+void Shaders::setVec4(const char *name, glm::vec4 value) {
     
-   glUniform4fv(glGetUniformLocation(program,name.c_str()), 1, glm::value_ptr(value));
+   glUniform4fv(location(name), 1, glm::value_ptr(value));
+   RenderStats::countUniforms();
     
 }
 
 //-----------------------------------------------------
 // Fija el valor de una variable uniforme de tipo mat4
 //-----------------------------------------------------
-void Shaders::setMat4(const std::string &name, glm::mat4 value) {
+void Shaders::setMat4(const char *name, glm::mat4 value) {
     
-   glUniformMatrix4fv(glGetUniformLocation(program,name.c_str()), 1, GL_FALSE, glm::value_ptr(value)); 
+   glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(value)); 
+   RenderStats::countUniforms();
     
 }
 
 //------------------------------------------------------
 // Fija el valor de una variable uniforme de tipo Light
 //------------------------------------------------------
-void Shaders::setLight(const std::string &name, Light value) {
-    
-    glUniform3fv(glGetUniformLocation(program,(name+".position"   ).c_str()), 1, glm::value_ptr(value.position ));
-    glUniform3fv(glGetUniformLocation(program,(name+".direction"  ).c_str()), 1, glm::value_ptr(value.direction));
-    glUniform3fv(glGetUniformLocation(program,(name+".ambient"    ).c_str()), 1, glm::value_ptr(value.ambient  ));
-    glUniform3fv(glGetUniformLocation(program,(name+".diffuse"    ).c_str()), 1, glm::value_ptr(value.diffuse  ));
-    glUniform3fv(glGetUniformLocation(program,(name+".specular"   ).c_str()), 1, glm::value_ptr(value.specular ));
-    glUniform1f (glGetUniformLocation(program,(name+".innerCutOff").c_str()), glm::cos(glm::radians(value.innerCutOff)));
-    glUniform1f (glGetUniformLocation(program,(name+".outerCutOff").c_str()), glm::cos(glm::radians(value.outerCutOff)));
-    glUniform1f (glGetUniformLocation(program,(name+".c0"         ).c_str()), value.c0);
-    glUniform1f (glGetUniformLocation(program,(name+".c1"         ).c_str()), value.c1);
-    glUniform1f (glGetUniformLocation(program,(name+".c2"         ).c_str()), value.c2);
+void Shaders::setLight(const char *name, Light value) {
+    
+    glUniform3fv(location(name, "position"   ), 1, glm::value_ptr(value.position ));
+    glUniform3fv(location(name, "direction"  ), 1, glm::value_ptr(value.direction));
+    glUniform3fv(location(name, "ambient"    ), 1, glm::value_ptr(value.ambient  ));
+    glUniform3fv(location(name, "diffuse"    ), 1, glm::value_ptr(value.diffuse  ));
+    glUniform3fv(location(name, "specular"   ), 1, glm::value_ptr(value.specular ));
+    glUniform1f (location(name, "innerCutOff"), glm::cos(glm::radians(value.innerCutOff)));
+    glUniform1f (location(name, "outerCutOff"), glm::cos(glm::radians(value.outerCutOff)));
+    glUniform1f (location(name, "c0"         ), value.c0);
+    glUniform1f (location(name, "c1"         ), value.c1);
+    glUniform1f (location(name, "c2"         ), value.c2);
+    RenderStats::countUniforms(10);
             
 }
 
@@ -136,67 +154,86 @@ std::string toString(const int &i) {
 //---------------------------------------------------------
 // Fija el valor de una variable uniforme de tipo Material
 //---------------------------------------------------------
-void Shaders::setMaterial(const std::string &name, Material value) {
+void Shaders::setMaterial(const char *name, Material value) {
     
-    glUniform4fv(glGetUniformLocation(program,(name+".ambient"  ).c_str()), 1, glm::value_ptr(value.ambient ));
-    glUniform4fv(glGetUniformLocation(program,(name+".diffuse"  ).c_str()), 1, glm::value_ptr(value.diffuse ));
-    glUniform4fv(glGetUniformLocation(program,(name+".specular" ).c_str()), 1, glm::value_ptr(value.specular));
-    glUniform4fv(glGetUniformLocation(program,(name+".emissive" ).c_str()), 1, glm::value_ptr(value.emissive));
-    glUniform1f (glGetUniformLocation(program,(name+".shininess").c_str()), value.shininess);
+    glUniform4fv(location(name, "ambient"    ), 1, glm::value_ptr(value.ambient ));
+    glUniform4fv(location(name, "diffuse"    ), 1, glm::value_ptr(value.diffuse ));
+    glUniform4fv(location(name, "specular"   ), 1, glm::value_ptr(value.specular));
+    glUniform4fv(location(name, "emissive"   ), 1, glm::value_ptr(value.emissive));
+    glUniform1f (location(name, "shininess"  ), value.shininess);
+    RenderStats::countUniforms(5);
             
 }
 
 //--------------------------------------------------------------------
 // Fija el valor de una variable uniforme (sampler2D) de tipo Texture
+// (cada mapa usa una unidad de textura fija, independiente de su id)
 //--------------------------------------------------------------------
-void Shaders::setTextures(const std::string &name, Textures value) {
+void Shaders::setTextures(const char *name, Textures value) {
    
-    glActiveTexture(GL_TEXTURE0 + value.diffuse);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_DIFFUSE);
     glBindTexture(GL_TEXTURE_2D,value.diffuse);
-    glUniform1i(glGetUniformLocation(program,(name+".diffuse").c_str()), value.diffuse);
+    glUniform1i(location(name, "diffuse"    ), TEXTURE_UNIT_DIFFUSE);
     
-    glActiveTexture(GL_TEXTURE0 + value.specular);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_SPECULAR);
     glBindTexture(GL_TEXTURE_2D,value.specular);
-    glUniform1i(glGetUniformLocation(program,(name+".specular").c_str()), value.specular);
+    glUniform1i(location(name, "specular"   ), TEXTURE_UNIT_SPECULAR);
     
-    glActiveTexture(GL_TEXTURE0 + value.emissive);
+    glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_EMISSIVE);
     glBindTexture(GL_TEXTURE_2D,value.emissive);
-    glUniform1i(glGetUniformLocation(program,(name+".emissive").c_str()), value.emissive);
+    glUniform1i(location(name, "emissive"   ), TEXTURE_UNIT_EMISSIVE);
     
     if(value.normal!=0) {
-        glActiveTexture(GL_TEXTURE0 + value.normal);
+        glActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT_NORMAL);
         glBindTexture(GL_TEXTURE_2D,value.normal);
-        glUniform1i(glGetUniformLocation(program,(name+".normal"  ).c_str()), value.normal);
+        glUniform1i(location(name, "normal"     ), TEXTURE_UNIT_NORMAL);
+        RenderStats::countTexture();
+        RenderStats::countUniforms();
     }
     
-    glUniform1f (glGetUniformLocation(program,(name+".shininess").c_str()), value.shininess);
+    glUniform1f (location(name, "shininess"  ), value.shininess);
+    RenderStats::countTexture(3);
+    RenderStats::countUniforms(4);
             
 }
 
 //------------------------------------------------------
 // Fija el valor de una variable uniforme de tipo float
 //------------------------------------------------------
-void Shaders::setFloat(const std::string &name, float value) {
+void Shaders::setFloat(const char *name, float value) {
     
-    glUniform1f(glGetUniformLocation(program,name.c_str()),value);
+    glUniform1f(location(name),value);
+    RenderStats::countUniforms();
             
 }
 
 //------------------------------------------------------
 // Fija el valor de una variable uniforme de tipo int
 //------------------------------------------------------
-void Shaders::setInt(const std::string &name, int value) {
+void Shaders::setInt(const char *name, int value) {
     
-    glUniform1i(glGetUniformLocation(program,name.c_str()),value);
+    glUniform1i(location(name),value);
+    RenderStats::countUniforms();
             
 }
 
 //------------------------------------------------------
 // Fija el valor de una variable uniforme de tipo bool
 //------------------------------------------------------
-void Shaders::setBool(const std::string &name, int value) {
+void Shaders::setBool(const char *name, int value) {
+    
+    glUniform1i(location(name),value);
+    RenderStats::countUniforms();
+            
+}
+
+//------------------------------------------------------------------
+// Asocia un bloque uniforme del programa a un punto de enlace fijo
+//------------------------------------------------------------------
+void Shaders::setUniformBlock(const char *name, unsigned int binding) {
     
-    glUniform1i(glGetUniformLocation(program,name.c_str()),value);
+    unsigned int index = glGetUniformBlockIndex(program,name);
+    if(index != GL_INVALID_INDEX) glUniformBlockBinding(program,index,binding);
             
 }
 
@@ -206,9 +243,44 @@ void Shaders::setBool(const std::string &name, int value) {
 void Shaders::useShaders() {
     
     glUseProgram(program);
+    RenderStats::countProgram();
     
 }
 
+//----------------------------------------------------------------------------------------------
+// Localización de un uniforme. Se pide a OpenGL solo la primera vez: después se busca entre las
+// guardadas, sin construir cadenas ni reservar memoria en cada frame
+//----------------------------------------------------------------------------------------------
+int Shaders::location(const char *name) {
+
+    for(const UniformLocation &cached : locations) {
+        if(std::strcmp(cached.name, name) == 0) return cached.location;
+    }
+    const int location = glGetUniformLocation(program, name);
+    if(std::strlen(name) < sizeof(UniformLocation::name)) {
+        UniformLocation cached;
+        std::strcpy(cached.name, name);
+        cached.location = location;
+        locations.push_back(cached);
+    }
+    return location;
+
+}
+
+// Localización del campo de un uniforme de tipo estructura ("name.field"). Un nombre que no cabe
+// se queda en -1 (OpenGL ignora ese uniforme) en lugar de buscar y guardar uno cortado
+int Shaders::location(const char *name, const char *field) {
+
+    char full[sizeof(UniformLocation::name)];
+    const int length = snprintf(full, sizeof(full), "%s.%s", name, field);
+    if(length < 0 || (size_t)length >= sizeof(full)) {
+        std::cout << "El uniforme " << name << "." << field << " tiene un nombre demasiado largo." << std::endl;
+        return -1;
+    }
+    return location(full);
+
+}
+
 //-----------------------------------
 // Destructor de la clasede la clase 
 //-----------------------------------
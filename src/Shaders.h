@@ -8,6 +8,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <sstream>
+#include <vector>
 std::string toString(const int &i);
 
 struct Light {
@@ -31,6 +32,23 @@ struct Material {
     float     shininess;
 };
 
+// Unidades de textura reservadas para cada mapa de Textures (la 0 es la del array de la escena)
+const unsigned int TEXTURE_UNIT_DIFFUSE  = 1;
+const unsigned int TEXTURE_UNIT_SPECULAR = 2;
+const unsigned int TEXTURE_UNIT_EMISSIVE = 3;
+const unsigned int TEXTURE_UNIT_NORMAL   = 4;
+
+// Bloque uniforme de iluminación (std140), compartido por todos los dibujos del frame
+const unsigned int LIGHTING_BLOCK_BINDING = 0;
+
+struct LightingBlock {
+    glm::vec4 ambientLight;
+    glm::vec4 dirLightDir;          // Normalizada
+    glm::vec4 dirLightColor;
+    glm::vec4 movingLightPos;
+    glm::vec4 movingLightColor;     // w: 1 si la luz móvil está encendida
+};
+
 struct Textures {
     unsigned int diffuse;
     unsigned int specular;
@@ -46,22 +64,34 @@ class Shaders {
         void initShaders(const char *vShaderFile, const char *fShaderFile);
         void useShaders();
         
-        void setVec3    (const std::string &name, glm::vec3 value);
-        void setVec4    (const std::string &name, glm::vec4 value);
-        void setMat4    (const std::string &name, glm::mat4 value);
-        void setLight   (const std::string &name, Light     value);
-        void setMaterial(const std::string &name, Material  value);
-        void setTextures(const std::string &name, Textures  value);
-        void setFloat   (const std::string &name, float     value);
-        void setInt     (const std::string &name, int       value);
-        void setBool    (const std::string &name, int       value);
+        void setVec2    (const char *name, glm::vec2 value);
+        void setVec3    (const char *name, glm::vec3 value);
+        void setVec4    (const char *name, glm::vec4 value);
+        void setMat4    (const char *name, glm::mat4 value);
+        void setLight   (const char *name, Light     value);
+        void setMaterial(const char *name, Material  value);
+        void setTextures(const char *name, Textures  value);
+        void setFloat   (const char *name, float     value);
+        void setInt     (const char *name, int       value);
+        void setBool    (const char *name, int       value);
+        void setUniformBlock(const char *name, unsigned int binding);
         
         virtual ~Shaders();
                 
     private:
                    
-        unsigned int program;
+        // Localización de cada uniforme ya pedida (también las que no existen, con -1)
+        struct UniformLocation {
+            char name[64];
+            int  location;
+        };
+
+        unsigned int                 program;
+        std::vector<UniformLocation> locations;
                 
+        int location(const char *name);
+        int location(const char *name, const char *field);
+
         unsigned int createShader (unsigned long shader , const char *shaderFile);
         unsigned int createProgram(unsigned int  vShader, unsigned int fShader);
 
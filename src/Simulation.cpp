@@ -0,0 +1,704 @@
+#include "Simulation.h"
+#include "Trace.h"
+#include "InputRecording.h"
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+const float  Simulation::STEP   = 1.0f / 120.0f;
+const double Simulation::STEP_D = 1.0 / 120.0;
+
+// Pasos que se pueden encadenar para recuperar retraso antes de descartarlo
+const int MAX_CATCH_UP = 8;
+
+// Elementos por tarea al actualizar comida y burbujas en paralelo
+const size_t SIM_CHUNK = 64;
+
+// Órdenes por paso para las que se reserva sitio al crear la simulación (un escenario puede echar
+// toda la comida de golpe)
+const size_t SIM_COMMANDS_RESERVED = 2 * MAX_COMIDA;
+
+// Velocidad del ventilador con tecla mantenida (grados por segundo)
+const float FAN_ANGULAR_SPEED = 18.0f;
+
+Simulation::Simulation(JobSystem &jobs) : jobs(jobs), tiempoUltimaBurbuja(0.0f), tiempoAvanzado(0.0), running(false), recorder(NULL), player(NULL) {
+
+    world = WorldSnapshot();
+    for (int i = 0; i <= GLFW_KEY_LAST; i++) teclas[i] = false;
+
+    // Sitio de sobra para las órdenes de un paso: encolarlas no reserva memoria
+    commands.reserve(SIM_COMMANDS_RESERVED);
+    pendingCommands.reserve(SIM_COMMANDS_RESERVED);
+    replayedInput.reserve(SIM_COMMANDS_RESERVED);
+    MemoryRegistry::add(MEMORIA_HOST, (unsigned long long)(size_t)this, MEMORIA_CPU, sizeof(*this), "WorldSnapshot", "Simulation", "mundo y sus copias");
+
+}
+
+//-------------------------------------------------------------------------------------
+// Estado inicial del acuario; publica la primera copia para que el render ya tenga una
+//-------------------------------------------------------------------------------------
+void Simulation::init(unsigned int seed) {
+
+    rng.seed(seed);
+    tiempoAvanzado = 0.0;
+    world = WorldSnapshot();
+    world.peces_visibles = 5;
+    world.peces_pausados = false;
+    tiempoUltimaBurbuja  = 0.0f;
+
+    // Inicializar peces
+    world.peces[0] = {glm::vec3(-2.0f, -0.3f, -11.2f), glm::vec3(0.6f, 0.1f, 0.25f), glm::vec3(0.6f, 0.1f, 0.25f), glm::vec4(0.2f, 0.6f, 0.8f, 1.0f), 0.0f, 0.37f};
+    world.peces[1] = {glm::vec3(2.0f, -2.8f, -12.8f), glm::vec3(-0.4f, -0.15f, 0.35f), glm::vec3(-0.4f, -0.15f, 0.35f), glm::vec4(0.9f, 0.5f, 0.2f, 1.0f), 1.5f, 0.35f};
+    world.peces[2] = {glm::vec3(-1.5f, -3.0f, -11.0f), glm::vec3(0.5f, 0.1f, -0.4f), glm::vec3(0.5f, 0.1f, -0.4f), glm::vec4(0.8f, 0.2f, 0.3f, 1.0f), 3.0f, 0.39f};
+    world.peces[3] = {glm::vec3(1.8f, -0.8f, -12.5f), glm::vec3(0.35f, 0.15f, -0.4f), glm::vec3(0.35f, 0.15f, -0.4f), glm::vec4(0.9f, 0.9f, 0.3f, 1.0f), 4.5f, 0.36f};
+    world.peces[4] = {glm::vec3(0.2f, -1.8f, -11.3f), glm::vec3(-0.55f, 0.0f, 0.3f), glm::vec3(-0.55f, 0.0f, 0.3f), glm::vec4(0.6f, 0.3f, 0.8f, 1.0f), 2.0f, 0.38f};
+    world.peces[5] = {glm::vec3(-1.8f, -1.3f, -13.0f), glm::vec3(0.4f, -0.08f, 0.4f), glm::vec3(0.4f, -0.08f, 0.4f), glm::vec4(0.3f, 0.8f, 0.6f, 1.0f), 3.5f, 0.39f};
+    world.peces[6] = {glm::vec3(1.2f, -2.5f, -11.8f), glm::vec3(-0.5f, 0.15f, -0.35f), glm::vec3(-0.5f, 0.15f, -0.35f), glm::vec4(0.9f, 0.3f, 0.5f, 1.0f), 5.0f, 0.37f};
+    world.peces[7] = {glm::vec3(-0.8f, -0.5f, -12.4f), glm::vec3(0.5f, -0.1f, 0.35f), glm::vec3(0.5f, -0.1f, 0.35f), glm::vec4(0.4f, 0.5f, 0.9f, 1.0f), 1.0f, 0.38f};
+    world.peces[8] = {glm::vec3(0.5f, -2.2f, -12.0f), glm::vec3(0.45f, 0.1f, 0.3f), glm::vec3(0.45f, 0.1f, 0.3f), glm::vec4(0.7f, 0.4f, 0.9f, 1.0f), 2.5f, 0.36f};
+    
+    for (int i = 0; i < NUM_PECES; i++) {
+        glm::vec3 velNorm = glm::normalize(world.peces[i].velocidad);
+        world.peces[i].anguloDireccion = atan2(velNorm.x, velNorm.z);
+        world.peces[i].anguloObjetivo = world.peces[i].anguloDireccion;
+        world.peces[i].tiempoOndulacion = random01() * 6.28f;
+        world.peces[i].amplitudOndulacion = 0.02f + random01() * 0.015f;
+        world.peces[i].frecuenciaOndulacion = 4.0f + random01() * 1.0f;
+        world.peces[i].tiempoCambio = random01() * 3.0f;
+        world.peces[i].alturaObjetivo = world.peces[i].posicion.y;
+        world.peces[i].modeloTipo = 0;
+        world.peces[i].persigiendoComida = false;
+    }
+
+    // Inicializar comida
+    for (int i = 0; i < MAX_COMIDA; i++) {
+        world.comidas[i].activa = false;
+    }
+    
+    // Inicializar burbujas
+    for (int i = 0; i < MAX_BURBUJAS; i++) {
+        world.burbujas[i].activa = false;
+    }
+    
+    // Inicializar ventilador
+    world.ventilador.posicion = glm::vec3(10.0f, -8.8f, -11.5f);  
+    world.ventilador.anguloAspas = 0.0f;
+    world.ventilador.velocidadRotacion = 360.0f;  // Velocidad de rotación de las aspas (grados/segundo)
+    world.ventilador.anguloMovimiento = 0.0f;     
+    world.ventilador.radio = 10.0f;
+    world.ventilador.anguloRotacionPalo = 0.0f;  // Inicializar rotación del palo               
+    
+    // Generar burbujas iniciales cerca de los peces
+    for (int i = 0; i < 15; i++) {
+        if (i < MAX_BURBUJAS) {
+            int pezIndex = randomInt(world.peces_visibles);
+            glm::vec3 posPez = world.peces[pezIndex].posicion;
+            
+            float offsetX = (randomInt(60) - 30) / 100.0f;  
+            float offsetY = randomInt(100) / 100.0f;      
+            float offsetZ = (randomInt(40) - 20) / 100.0f;  
+            
+            world.burbujas[i].posicion = glm::vec3(
+                posPez.x + offsetX,
+                posPez.y + offsetY,
+                posPez.z + offsetZ
+            );
+            world.burbujas[i].escala = 0.020f + randomInt(60) / 3000.0f;
+            world.burbujas[i].velocidadSubida = 0.25f + randomInt(80) / 400.0f;
+            world.burbujas[i].oscilacionX = 0.06f + randomInt(40) / 500.0f;
+            world.burbujas[i].oscilacionZ = 0.06f + randomInt(40) / 500.0f;
+            world.burbujas[i].fase = randomInt(628) / 100.0f;
+            world.burbujas[i].activa = true;
+        }
+    }
+
+    publish();
+
+}
+
+//--------------------------------------------
+// Lanza el hilo de simulación (a paso fijo)
+//--------------------------------------------
+void Simulation::start() {
+
+    if(running.exchange(true)) return;
+    thread = std::thread(&Simulation::run, this);
+
+}
+
+//---------------------------------------------------
+// Para el hilo y espera a que termine el paso actual
+//---------------------------------------------------
+void Simulation::stop() {
+
+    running = false;
+    if(thread.joinable()) thread.join();
+
+}
+
+//-----------------------------------------------------------------------------------------------
+// Un paso de STEP segundos: órdenes recibidas, comportamiento de todos los elementos y burbujas.
+// Los peces se comen la comida, así que la comida se actualiza después (dependencia); burbujas y
+// ventilador no comparten datos con ellos y van en paralelo. El resultado es idéntico al de
+// actualizarlo todo en orden, incluida la secuencia de números aleatorios
+//-----------------------------------------------------------------------------------------------
+void Simulation::step() {
+
+    TRACE_SCOPE("Simulation::step");
+    AllocScope scope(ALLOC_SIMULACION);
+    const std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    applyCommands();
+    applyInput(STEP);
+
+    JobCounter peces;
+    JobCounter resto;
+    jobs.submit([this] { actualizarPeces(STEP); }, &peces);
+    jobs.submit([this] { actualizarComida(STEP); }, &resto, &peces);
+    jobs.submit([this] { actualizarBurbujas(STEP); }, &resto);
+    actualizarVentilador(STEP);
+    jobs.wait(resto);
+
+    // Generar burbujas continuamente 
+    tiempoUltimaBurbuja += STEP;
+    if (tiempoUltimaBurbuja >= 0.25f + randomInt(100) / 200.0f) {  
+        generarBurbuja();
+        tiempoUltimaBurbuja = 0.0f;
+    }
+
+    world.tiempo += STEP;
+    world.paso++;
+
+    tiempoPasos.record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count());
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Avanza el mundo seconds segundos de tiempo simulado, sin hilo ni reloj, y publica el resultado.
+// Para el modo sin ventana: con la misma semilla y los mismos avances el resultado es el mismo. Los
+// pasos se cuentan sobre el tiempo total y no restando STEP (float) a un resto, que con el tiempo
+// acumula error y acaba perdiendo pasos: tras el avance el mundo va en el paso más cercano a él
+//------------------------------------------------------------------------------------------------
+void Simulation::advance(double seconds) {
+
+    tiempoAvanzado += seconds;
+    const unsigned long long objetivo = (unsigned long long)std::max(0LL, std::llround(tiempoAvanzado / STEP_D));
+    while(world.paso < objetivo) step();
+    publish();
+
+}
+
+//-----------------------------------------------------------------
+// Encola una orden (desde cualquier hilo) para el siguiente paso
+//-----------------------------------------------------------------
+void Simulation::post(SimCommandType type, float value) {
+
+    SimCommand command = { type, value };
+    std::lock_guard<std::mutex> lock(commandMutex);
+    commands.push_back(command);
+
+}
+
+//------------------------------------------------------------------------------
+// Encola un evento de entrada. Solo desde el hilo de la ventana (cola de un productor)
+//------------------------------------------------------------------------------
+void Simulation::postInput(const InputEvent &event) {
+
+    input.push(event);
+
+}
+
+//----------------------------------------------------------------------------------
+// Última copia completa del mundo (hilo del render; no bloquea). La referencia es
+// válida hasta la siguiente llamada
+//----------------------------------------------------------------------------------
+const WorldSnapshot& Simulation::latest() {
+
+    snapshots.update();
+    return snapshots.readBuffer();
+
+}
+
+//------------------------------------------------------------------------------------------
+// Bucle del hilo: ejecuta los pasos que tocan según el reloj, publica y duerme hasta el siguiente
+//------------------------------------------------------------------------------------------
+void Simulation::run() {
+
+    TRACE_THREAD("simulacion");
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration stepDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(STEP));
+
+    Clock::time_point next = Clock::now();
+    while(running) {
+        int pasos = 0;
+        while(Clock::now() >= next && pasos < MAX_CATCH_UP) {
+            step();
+            next += stepDuration;
+            pasos++;
+        }
+        if(pasos == MAX_CATCH_UP) next = Clock::now();
+        if(pasos > 0) publish();
+        std::this_thread::sleep_until(next);
+    }
+
+}
+
+//----------------------------------------------------------------------------------------------
+// Aplica las órdenes encoladas desde el hilo de la ventana. Al repetir una grabación se descartan
+// y se toman las grabadas para este paso, junto con sus eventos de entrada (para applyInput)
+//----------------------------------------------------------------------------------------------
+void Simulation::applyCommands() {
+
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        pendingCommands.swap(commands);
+    }
+    if(player) {
+        pendingCommands.clear();
+        InputRecord record;
+        while(player->next(world.paso, record)) {
+            if(record.isCommand) pendingCommands.push_back(record.command);
+            else replayedInput.push_back(record.event);
+        }
+    }
+    for(const SimCommand &command : pendingCommands) {
+        if(recorder) recorder->record(world.paso, command);
+        switch(command.type) {
+            case SIM_PAUSAR:
+                world.peces_pausados = !world.peces_pausados;
+                break;
+            case SIM_ECHAR_COMIDA:
+                echarComida();
+                break;
+            case SIM_QUITAR_COMIDA:
+                for (int i = 0; i < MAX_COMIDA; i++) world.comidas[i].activa = false;
+                break;
+            case SIM_PECES_VISIBLES:
+                world.peces_visibles = glm::clamp((int)command.value, 1, NUM_PECES);
+                break;
+            case SIM_MOVER_VENTILADOR:
+                world.ventilador.anguloMovimiento += command.value;
+                if (world.ventilador.anguloMovimiento >= 360.0f) world.ventilador.anguloMovimiento -= 360.0f;
+                if (world.ventilador.anguloMovimiento < 0.0f) world.ventilador.anguloMovimiento += 360.0f;
+                break;
+            case SIM_CAMARA_ALPHA:
+            case SIM_CAMARA_BETA:
+            case SIM_CAMARA_DIST:
+            case SIM_LUZ:
+                break;   // Las aplica la vista; aquí solo se graban
+        }
+    }
+    pendingCommands.clear();
+
+}
+
+//------------------------------------------------------------------------------------------
+// Procesa los eventos de entrada recibidos desde el último paso (todos se graban; los de cámara y
+// luz los aplica la vista) y aplica durante dt los controles que dependen de tener la tecla pulsada
+//------------------------------------------------------------------------------------------
+void Simulation::applyInput(float dt) {
+
+    TRACE_SCOPE("applyInput");
+    InputEvent event;
+    while (input.pop(event)) {
+        if (player) continue;
+        if (recorder) recorder->record(world.paso, event);
+        handleInput(event);
+    }
+    for (const InputEvent &replayed : replayedInput) {
+        if (recorder) recorder->record(world.paso, replayed);
+        handleInput(replayed);
+    }
+    replayedInput.clear();
+
+    // B (sentido horario) y R (sentido antihorario): ventilador alrededor de la pecera
+    float giro = 0.0f;
+    if (teclas[GLFW_KEY_B]) giro += FAN_ANGULAR_SPEED * dt;
+    if (teclas[GLFW_KEY_R]) giro -= FAN_ANGULAR_SPEED * dt;
+    if (giro != 0.0f) {
+        world.ventilador.anguloMovimiento += giro;
+        if (world.ventilador.anguloMovimiento >= 360.0f) world.ventilador.anguloMovimiento -= 360.0f;
+        if (world.ventilador.anguloMovimiento < 0.0f) world.ventilador.anguloMovimiento += 360.0f;
+    }
+
+}
+
+//------------------------------------------------------------------------------------------
+// Un evento: las acciones de una sola pulsación se hacen al pulsar (los eventos ya son flancos)
+//------------------------------------------------------------------------------------------
+void Simulation::handleInput(const InputEvent &event) {
+
+    switch (event.type) {
+        case INPUT_KEY:
+            if (event.code < 0 || event.code > GLFW_KEY_LAST || event.action == GLFW_REPEAT) break;
+            teclas[event.code] = event.action == GLFW_PRESS;
+            if (event.action != GLFW_PRESS) break;
+            if (event.code == GLFW_KEY_P) {
+                world.peces_pausados = !world.peces_pausados;
+            } else if (event.code == GLFW_KEY_C) {
+                echarComida();
+            } else if (event.code >= GLFW_KEY_1 && event.code <= GLFW_KEY_9) {
+                world.peces_visibles = event.code - GLFW_KEY_0;
+            } else if (event.code == GLFW_KEY_SPACE) {
+                for (int i = 0; i < MAX_COMIDA; i++) world.comidas[i].activa = false;   // La vista vuelve a la inicial
+            }
+            break;
+
+        default:
+            break;   // Ratón y rueda: solo mueven la cámara
+    }
+
+}
+
+//----------------------------------------------
+// Copia el estado actual en el triple buffer
+//----------------------------------------------
+void Simulation::publish() {
+
+    snapshots.writeBuffer() = world;
+    snapshots.publish();
+
+}
+
+float Simulation::random01() {
+
+    return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+
+}
+
+int Simulation::randomInt(int n) {
+
+    return std::uniform_int_distribution<int>(0, n - 1)(rng);
+
+}
+
+void Simulation::actualizarPeces(float dt)
+{
+    if (world.peces_pausados) return;
+    actualizarPeces(world.peces, NUM_PECES, world.comidas, MAX_COMIDA, dt, rng);
+}
+
+void Simulation::actualizarComida(float dt)
+{
+    actualizarComida(jobs, world.comidas, MAX_COMIDA, dt);
+}
+
+void Simulation::actualizarBurbujas(float dt)
+{
+    actualizarBurbujas(jobs, world.burbujas, MAX_BURBUJAS, dt);
+}
+
+//------------------------------------------------------------------------------------------------
+// Comportamiento de numPeces peces: buscan la comida más cercana, evitan paredes y a los demás
+// peces (todos con todos) y avanzan. Con los arrays del mundo es el paso normal de la simulación
+//------------------------------------------------------------------------------------------------
+void Simulation::actualizarPeces(Pez* peces, int numPeces, Comida* comidas, int numComidas, float dt, std::minstd_rand& rng)
+{
+    TRACE_SCOPE("actualizarPeces");
+    auto random01 = [&rng]() { return std::uniform_real_distribution<float>(0.0f, 1.0f)(rng); };
+
+    const float limiteX = 2.6f;
+    const float limiteY_min = -3.8f;
+    const float limiteY_max = 0.3f;
+    const float limiteZ_min = -13.5f;
+    const float limiteZ_max = -10.5f;
+    const float distanciaEvitacion = 1.5f;
+    const float margenGiro = 0.5f;
+
+    for (int i = 0; i < numPeces; i++) {
+        peces[i].tiempoOndulacion += dt;
+        
+        float velocidadBase = glm::length(peces[i].velocidadOriginal);
+        
+        // Buscar comida cercana
+        int comidaCercana = -1;
+        float distanciaMin = 999999.0f;
+        for (int c = 0; c < numComidas; c++) {
+            if (comidas[c].activa) {
+                float dist = glm::distance(peces[i].posicion, comidas[c].posicion);
+                if (dist < distanciaMin) {
+                    distanciaMin = dist;
+                    comidaCercana = c;
+                }
+            }
+        }
+
+        // perseguir comida 
+        if (comidaCercana != -1 && distanciaMin < 8.0f) {
+            peces[i].persigiendoComida = true;  
+            
+            glm::vec3 direccion = glm::normalize(comidas[comidaCercana].posicion - peces[i].posicion);
+            peces[i].anguloObjetivo = atan2(direccion.x, direccion.z);
+            peces[i].alturaObjetivo = comidas[comidaCercana].posicion.y;
+            
+            if (distanciaMin > 1.5f) {
+                velocidadBase = velocidadBase * (1.8f + (8.0f - distanciaMin) * 0.2f);
+            } else if (distanciaMin > 0.5f) {
+                velocidadBase = velocidadBase * 1.6f;
+            } else {
+                velocidadBase = velocidadBase * (0.5f + distanciaMin);
+            }
+            
+            // Comer comida cuando están cerca
+            if (distanciaMin < 0.4f) {
+                comidas[comidaCercana].escala -= dt * 1.5f;  
+                if (comidas[comidaCercana].escala <= 0.0f) {
+                    comidas[comidaCercana].activa = false;  
+                }
+            }
+        }
+        else {
+            peces[i].persigiendoComida = false;  // No hay comida cerca
+            
+            // nadar hacia adelante
+            peces[i].tiempoCambio -= dt;
+            if (peces[i].tiempoCambio <= 0.0f) {
+                peces[i].tiempoCambio = 3.0f + random01() * 4.0f;
+                
+                // Cambiar altura para explorar todo el volumen vertical
+                float random = random01();
+                if (random < 0.33f) {
+                    peces[i].alturaObjetivo = limiteY_min + random01() * 1.2f;
+                } else if (random < 0.66f) {
+                    peces[i].alturaObjetivo = limiteY_min + 1.2f + random01() * 1.5f;
+                } else {
+                    peces[i].alturaObjetivo = limiteY_min + 2.7f + random01() * 1.3f;
+                }
+                float ajusteDireccion = (random01() - 0.5f) * M_PI / 2.5f;
+                peces[i].anguloObjetivo = peces[i].anguloDireccion + ajusteDireccion;
+            }
+
+            // Evitar paredes
+            glm::vec3 direccionGiro(0.0f);
+            bool necesitaGirar = false;
+            
+            glm::vec3 dirActual(sin(peces[i].anguloDireccion), 0.0f, cos(peces[i].anguloDireccion));
+            glm::vec3 posFutura = peces[i].posicion + dirActual * velocidadBase * 1.2f;
+            
+            if (posFutura.x > limiteX - margenGiro) {
+                direccionGiro.x = -1.0f;
+                necesitaGirar = true;
+            }
+            if (posFutura.x < -limiteX + margenGiro) {
+                direccionGiro.x = 1.0f;
+                necesitaGirar = true;
+            }
+            if (posFutura.y > limiteY_max - margenGiro) {
+                direccionGiro.y = -0.5f;
+                necesitaGirar = true;
+            }
+            if (posFutura.y < limiteY_min + margenGiro) {
+                direccionGiro.y = 0.5f;
+                necesitaGirar = true;
+            }
+            if (posFutura.z > limiteZ_max - margenGiro) {
+                direccionGiro.z = -1.0f;
+                necesitaGirar = true;
+            }
+            if (posFutura.z < limiteZ_min + margenGiro) {
+                direccionGiro.z = 1.0f;
+                necesitaGirar = true;
+            }
+            
+            if (necesitaGirar) {
+                glm::vec3 nuevaDireccion = glm::normalize(dirActual + direccionGiro * 2.0f);
+                peces[i].anguloObjetivo = atan2(nuevaDireccion.x, nuevaDireccion.z);
+            }
+        }
+
+        // Evitar colisiones entre peces 
+        glm::vec3 fuerzaEvitacion(0.0f);
+        bool colisionDetectada = false;
+        const float radioColision = 0.4f;
+        
+        for (int j = 0; j < numPeces; j++) {
+            if (i != j) {
+                glm::vec3 diferencia = peces[i].posicion - peces[j].posicion;
+                float dist = glm::length(diferencia);
+                
+                if (dist < radioColision && dist > 0.01f) {
+                    glm::vec3 direccionSeparacion = glm::normalize(diferencia);
+                    float solapamiento = radioColision - dist;
+                    peces[i].posicion += direccionSeparacion * solapamiento * 0.5f;
+                    colisionDetectada = true;
+                    peces[i].anguloObjetivo = atan2(direccionSeparacion.x, direccionSeparacion.z);
+                }
+                else if (dist < distanciaEvitacion && dist > 0.01f) {
+                    glm::vec3 direccionEvitacion = glm::normalize(diferencia);
+                    float fuerza = (distanciaEvitacion - dist) / distanciaEvitacion;
+                    fuerzaEvitacion += direccionEvitacion * fuerza * 2.0f;
+                }
+            }
+        }
+        
+        if (!colisionDetectada && glm::length(fuerzaEvitacion) > 0.01f) {
+            glm::vec3 dirActual(sin(peces[i].anguloDireccion), 0.0f, cos(peces[i].anguloDireccion));
+            glm::vec3 nuevaDireccion = glm::normalize(dirActual + fuerzaEvitacion);
+            peces[i].anguloObjetivo = atan2(nuevaDireccion.x, nuevaDireccion.z);
+        }
+
+        float difAngulo = peces[i].anguloObjetivo - peces[i].anguloDireccion;
+        while (difAngulo > M_PI) difAngulo -= 2.0f * M_PI;
+        while (difAngulo < -M_PI) difAngulo += 2.0f * M_PI;
+        
+        float velocidadGiro = 1.2f * dt;
+        peces[i].anguloDireccion += glm::clamp(difAngulo, -velocidadGiro, velocidadGiro);
+        
+        // Calcular dirección de nado
+        glm::vec3 direccionNado;
+        direccionNado.x = sin(peces[i].anguloDireccion);
+        direccionNado.z = cos(peces[i].anguloDireccion);
+        direccionNado.y = 0.0f;
+        
+        // Movimiento vertical suave
+        float difAltura = peces[i].alturaObjetivo - peces[i].posicion.y;
+        float velocidadVertical = glm::clamp(difAltura * 0.5f, -0.3f, 0.3f);
+        direccionNado.y = velocidadVertical;
+        
+        glm::vec3 dirHorizontal = glm::normalize(glm::vec3(direccionNado.x, 0.0f, direccionNado.z));
+        peces[i].velocidad = dirHorizontal * velocidadBase + glm::vec3(0.0f, velocidadVertical, 0.0f);
+
+        // Actualizar posición
+        peces[i].posicion += peces[i].velocidad * dt;
+
+        // Limitar posición
+        peces[i].posicion.x = glm::clamp(peces[i].posicion.x, -limiteX, limiteX);
+        peces[i].posicion.y = glm::clamp(peces[i].posicion.y, limiteY_min, limiteY_max);
+        peces[i].posicion.z = glm::clamp(peces[i].posicion.z, limiteZ_min, limiteZ_max);
+    }
+}
+
+void Simulation::actualizarComida(JobSystem& jobs, Comida* comidas, int numComidas, float dt)
+{
+    TRACE_SCOPE("actualizarComida");
+    jobs.parallelFor(numComidas, SIM_CHUNK, [comidas, dt](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (comidas[i].activa) {
+                comidas[i].posicion.y -= 0.12f * dt;  
+                if (comidas[i].posicion.y < -3.5f) {
+                    comidas[i].activa = false;
+                }
+            }
+        }
+    });
+}
+
+void Simulation::actualizarBurbujas(JobSystem& jobs, Burbuja* burbujas, int numBurbujas, float dt)
+{
+    TRACE_SCOPE("actualizarBurbujas");
+    const float limiteX = 2.6f;
+    const float limiteZ_min = -13.5f;
+    const float limiteZ_max = -10.5f;
+    const float superficieY = 0.2f;
+    
+    jobs.parallelFor(numBurbujas, SIM_CHUNK, [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (burbujas[i].activa) {
+                burbujas[i].posicion.y += burbujas[i].velocidadSubida * dt;
+            
+                burbujas[i].fase += dt * 2.0f;
+                burbujas[i].posicion.x += sin(burbujas[i].fase) * burbujas[i].oscilacionX * dt;
+                burbujas[i].posicion.z += cos(burbujas[i].fase * 0.7f) * burbujas[i].oscilacionZ * dt;
+            
+                burbujas[i].posicion.x = glm::clamp(burbujas[i].posicion.x, -limiteX + 0.2f, limiteX - 0.2f);
+                burbujas[i].posicion.z = glm::clamp(burbujas[i].posicion.z, limiteZ_min + 0.2f, limiteZ_max - 0.2f);
+            
+                if (burbujas[i].posicion.y > superficieY) {
+                    burbujas[i].activa = false;
+                }
+            }
+        }
+    });
+}
+
+void Simulation::generarBurbuja()
+{
+    for (int i = 0; i < MAX_BURBUJAS; i++) {
+        if (!world.burbujas[i].activa) {
+            int pezIndex = randomInt(world.peces_visibles);
+            glm::vec3 posPez = world.peces[pezIndex].posicion;
+            
+            float offsetX = (randomInt(40) - 20) / 100.0f;  
+            float offsetY = (randomInt(30) - 15) / 100.0f;  
+            float offsetZ = 0.1f + randomInt(20) / 100.0f;  
+            
+            float dirX = sin(world.peces[pezIndex].anguloDireccion);
+            float dirZ = cos(world.peces[pezIndex].anguloDireccion);
+            
+            world.burbujas[i].posicion = glm::vec3(
+                posPez.x + dirX * offsetZ + offsetX,
+                posPez.y + offsetY,
+                posPez.z + dirZ * offsetZ
+            );
+            
+            world.burbujas[i].escala = 0.020f + randomInt(60) / 3000.0f;  
+            world.burbujas[i].velocidadSubida = 0.25f + randomInt(80) / 400.0f;  
+            world.burbujas[i].oscilacionX = 0.06f + randomInt(40) / 500.0f;  
+            world.burbujas[i].oscilacionZ = 0.06f + randomInt(40) / 500.0f;
+            world.burbujas[i].fase = randomInt(628) / 100.0f;  
+            world.burbujas[i].activa = true;
+            break; 
+        }
+    }
+}
+
+// Actualizar ventilador
+void Simulation::actualizarVentilador(float dt)
+{
+    world.ventilador.anguloAspas += world.ventilador.velocidadRotacion * dt;
+    if (world.ventilador.anguloAspas > 360.0f) {
+        world.ventilador.anguloAspas -= 360.0f;
+    }
+    
+    // Rotación del palo (más lenta que las aspas)
+    world.ventilador.anguloRotacionPalo += 90.0f * dt;  // 90 grados por segundo
+    if (world.ventilador.anguloRotacionPalo > 360.0f) {
+        world.ventilador.anguloRotacionPalo -= 360.0f;
+    }
+
+    // Posición alrededor de la pecera según el ángulo de movimiento
+    float anguloRad = glm::radians(world.ventilador.anguloMovimiento);
+    world.ventilador.posicion.x = cos(anguloRad) * world.ventilador.radio;
+    world.ventilador.posicion.z = -11.5f + sin(anguloRad) * world.ventilador.radio;
+}
+
+void Simulation::echarComida()
+{
+    int contador = 0;
+    for (int i = 0; i < MAX_COMIDA && contador < 50; i++) {
+        if (!world.comidas[i].activa) {
+            world.comidas[i].posicion = glm::vec3(
+                (randomInt(400) - 200) / 100.0f,
+                0.2f,
+                (randomInt(200) - 1300) / 100.0f
+            );
+
+            int colorType = randomInt(6);
+            switch(colorType) {
+                case 0: world.comidas[i].color = glm::vec4(1.0f, 0.9f, 0.2f, 1.0f); break;
+                case 1: world.comidas[i].color = glm::vec4(1.0f, 0.4f, 0.2f, 1.0f); break;
+                case 2: world.comidas[i].color = glm::vec4(0.9f, 0.2f, 0.2f, 1.0f); break;
+                case 3: world.comidas[i].color = glm::vec4(0.3f, 0.8f, 0.3f, 1.0f); break;
+                case 4: world.comidas[i].color = glm::vec4(0.8f, 0.6f, 0.3f, 1.0f); break;
+                case 5: world.comidas[i].color = glm::vec4(0.9f, 0.5f, 0.7f, 1.0f); break;
+            }
+
+            world.comidas[i].escala = 1.0f; 
+            world.comidas[i].activa = true;
+            contador++;
+        }
+    }
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+Simulation::~Simulation() {
+
+    stop();
+    MemoryRegistry::remove(MEMORIA_HOST, (unsigned long long)(size_t)this);
+
+}
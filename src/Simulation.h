@@ -0,0 +1,138 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <vector>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include <GLFW/glfw3.h>
+
+#include "World.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "JobSystem.h"
+#include "Histogram.h"
+
+// Órdenes que el hilo de la ventana envía a la simulación (se aplican al inicio del siguiente paso).
+// Las de cámara y luz las aplica la vista (View) y la simulación solo las graba
+enum SimCommandType {
+    SIM_PAUSAR,              // Pausar/reanudar peces
+    SIM_ECHAR_COMIDA,
+    SIM_QUITAR_COMIDA,
+    SIM_PECES_VISIBLES,      // value: número de peces
+    SIM_MOVER_VENTILADOR,    // value: grados que se desplaza el ventilador alrededor de la pecera
+    SIM_CAMARA_ALPHA,        // value: giro horizontal de la cámara (grados)
+    SIM_CAMARA_BETA,         // value: giro vertical de la cámara (grados)
+    SIM_CAMARA_DIST,         // value: distancia de la cámara al centro
+    SIM_LUZ                  // value: 1 enciende la luz móvil, 0 la apaga
+};
+
+struct SimCommand {
+    SimCommandType type;
+    float          value;
+};
+
+// Eventos de entrada tal como llegan de los callbacks de GLFW (la simulación no llama a GLFW)
+enum InputEventType {
+    INPUT_KEY,            // code: GLFW_KEY_*
+    INPUT_MOUSE_BUTTON,   // code: GLFW_MOUSE_BUTTON_*; x, y: posición del cursor
+    INPUT_CURSOR,         // x, y: posición del cursor
+    INPUT_SCROLL          // x, y: desplazamiento de la rueda
+};
+
+struct InputEvent {
+    InputEventType type;
+    int            code;
+    int            action;   // GLFW_PRESS, GLFW_RELEASE o GLFW_REPEAT
+    double         x;
+    double         y;
+    double         time;     // glfwGetTime() al recibirlo
+};
+
+const size_t INPUT_QUEUE_SIZE = 1024;
+
+class InputRecorder;
+class InputPlayer;
+
+// Simulación del acuario a paso fijo en su propio hilo. Cada paso publica una copia del mundo en
+// un triple buffer, de modo que el render dibuja siempre la última copia completa sin esperar. La
+// entrada llega como eventos por una cola sin bloqueos y se procesa al principio de cada paso; la
+// de cámara y luz solo se graba, porque la aplica la vista en el hilo de la ventana al leerla
+class Simulation {
+
+    public:
+
+        static const float  STEP;     // Duración de un paso (s)
+        static const double STEP_D;   // La misma en double, para contar los pasos de advance()
+
+        explicit Simulation(JobSystem &jobs);
+
+        void init (unsigned int seed);
+        void start();
+        void stop ();
+        void step ();
+        void advance(double seconds);
+        void post (SimCommandType type, float value = 0.0f);
+        void postInput(const InputEvent &event);
+
+        // Grabación de lo que recibe cada paso, o repetición de una grabación en lugar de la
+        // entrada y las órdenes en vivo (antes de start o del primer advance)
+        void setRecorder(InputRecorder *recorder) { this->recorder = recorder; }
+        void setPlayer  (InputPlayer *player)     { this->player = player; }
+
+        // Actualización de poblaciones de cualquier tamaño: el paso las aplica a los arrays del
+        // mundo y los microbenchmarks (bench/) a poblaciones mayores
+        static void actualizarPeces   (Pez *peces, int numPeces, Comida *comidas, int numComidas, float dt, std::minstd_rand &rng);
+        static void actualizarComida  (JobSystem &jobs, Comida *comidas, int numComidas, float dt);
+        static void actualizarBurbujas(JobSystem &jobs, Burbuja *burbujas, int numBurbujas, float dt);
+
+        const WorldSnapshot& latest();
+        unsigned long long   steps() const { return world.paso; }
+        const Histogram&     stepTimes() const { return tiempoPasos; }   // Tiempo de CPU de cada paso
+
+        virtual ~Simulation();
+
+    private:
+
+        JobSystem                    &jobs;
+        WorldSnapshot                 world;
+        TripleBuffer<WorldSnapshot>   snapshots;
+        float                         tiempoUltimaBurbuja;
+        double                        tiempoAvanzado;    // Tiempo total pedido a advance() desde init()
+        std::minstd_rand              rng;
+        Histogram                     tiempoPasos;
+
+        std::thread                   thread;
+        std::atomic<bool>             running;
+        std::mutex                    commandMutex;
+        std::vector<SimCommand>       commands;
+        std::vector<SimCommand>       pendingCommands;
+
+        SpscQueue<InputEvent, INPUT_QUEUE_SIZE> input;
+        bool                          teclas[GLFW_KEY_LAST + 1];   // Teclas pulsadas ahora mismo
+
+        InputRecorder                *recorder;
+        InputPlayer                  *player;
+        std::vector<InputEvent>       replayedInput;   // Eventos grabados del paso actual
+
+        void run();
+        void applyCommands();
+        void applyInput(float dt);
+        void handleInput(const InputEvent &event);
+        void publish();
+
+        float random01();
+        int   randomInt(int n);
+
+        void actualizarPeces(float dt);
+        void actualizarComida(float dt);
+        void actualizarBurbujas(float dt);
+        void actualizarVentilador(float dt);
+        void echarComida();
+        void generarBurbuja();
+
+};
+
+#endif /* SIMULATION_H */
@@ -0,0 +1,50 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Cola circular sin bloqueos para un productor y un consumidor con capacidad fija (potencia de 2).
+// Cada índice lo escribe un solo hilo; si la cola está llena, push() descarta el elemento y lo cuenta
+template <typename T, size_t N>
+class SpscQueue {
+
+    public:
+
+        SpscQueue() : head(0), tail(0), dropped(0) {}
+
+     // Productor
+        bool push(const T &value) {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if(t - head.load(std::memory_order_acquire) == N) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            items[t & (N - 1)] = value;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+     // Consumidor
+        bool pop(T &value) {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if(h == tail.load(std::memory_order_acquire)) return false;
+            value = items[h & (N - 1)];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+        unsigned int droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+    private:
+
+        static_assert((N & (N - 1)) == 0, "La capacidad debe ser potencia de 2");
+
+        T                         items[N];
+        alignas(64) std::atomic<size_t> head;   // Siguiente a leer (consumidor)
+        alignas(64) std::atomic<size_t> tail;   // Siguiente a escribir (productor)
+        std::atomic<unsigned int>       dropped;
+
+};
+
+#endif /* SPSCQUEUE_H */
@@ -0,0 +1,288 @@
+#include "TextRenderer.h"
+#include "RenderStats.h"
+#include "MemoryRegistry.h"
+
+#include <cstddef>
+#include <cstring>
+
+// Fuente de 8x8 de dominio público (font8x8_basic de Daniel Hepper), ASCII 32-126. Una fila por
+// byte, de arriba abajo; el bit 0 es el píxel de la izquierda
+static const unsigned char FONT_8X8[95][TEXT_GLYPH_SIZE] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // espacio
+    { 0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00 },   // !
+    { 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // "
+    { 0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00 },   // #
+    { 0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00 },   // $
+    { 0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00 },   // %
+    { 0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00 },   // &
+    { 0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00 },   // comilla
+    { 0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00 },   // (
+    { 0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00 },   // )
+    { 0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00 },   // *
+    { 0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00 },   // +
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06 },   // ,
+    { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00 },   // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00 },   // .
+    { 0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00 },   // /
+    { 0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00 },   // 0
+    { 0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00 },   // 1
+    { 0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00 },   // 2
+    { 0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00 },   // 3
+    { 0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00 },   // 4
+    { 0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00 },   // 5
+    { 0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00 },   // 6
+    { 0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00 },   // 7
+    { 0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00 },   // 8
+    { 0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00 },   // 9
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00 },   // :
+    { 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06 },   // ;
+    { 0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00 },   // <
+    { 0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00 },   // =
+    { 0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00 },   // >
+    { 0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00 },   // ?
+    { 0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00 },   // @
+    { 0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00 },   // A
+    { 0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00 },   // B
+    { 0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00 },   // C
+    { 0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00 },   // D
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00 },   // E
+    { 0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00 },   // F
+    { 0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00 },   // G
+    { 0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00 },   // H
+    { 0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // I
+    { 0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00 },   // J
+    { 0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00 },   // K
+    { 0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00 },   // L
+    { 0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00 },   // M
+    { 0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00 },   // N
+    { 0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00 },   // O
+    { 0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00 },   // P
+    { 0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00 },   // Q
+    { 0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00 },   // R
+    { 0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00 },   // S
+    { 0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // T
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00 },   // U
+    { 0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },   // V
+    { 0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00 },   // W
+    { 0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00 },   // X
+    { 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00 },   // Y
+    { 0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00 },   // Z
+    { 0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00 },   // [
+    { 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00 },   // barra invertida
+    { 0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00 },   // ]
+    { 0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00 },   // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF },   // _
+    { 0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00 },   // `
+    { 0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00 },   // a
+    { 0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00 },   // b
+    { 0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00 },   // c
+    { 0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00 },   // d
+    { 0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00 },   // e
+    { 0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00 },   // f
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F },   // g
+    { 0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00 },   // h
+    { 0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // i
+    { 0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E },   // j
+    { 0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00 },   // k
+    { 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00 },   // l
+    { 0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00 },   // m
+    { 0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00 },   // n
+    { 0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00 },   // o
+    { 0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F },   // p
+    { 0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78 },   // q
+    { 0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00 },   // r
+    { 0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00 },   // s
+    { 0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00 },   // t
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00 },   // u
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00 },   // v
+    { 0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00 },   // w
+    { 0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00 },   // x
+    { 0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F },   // y
+    { 0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00 },   // z
+    { 0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00 },   // {
+    { 0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00 },   // |
+    { 0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00 },   // }
+    { 0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }    // ~
+};
+
+// Primer carácter de la fuente y celda del atlas llena, para los paneles de fondo
+static const int FIRST_GLYPH = 32;
+static const int SOLID_GLYPH = 95;
+static const int ATLAS_ROWS  = 6;
+
+TextRenderer::TextRenderer() : vao(0), atlas(0), scale(1) {
+
+}
+
+//------------------------------------------------------------------------------------------
+// Crea el atlas (una textura de un canal con los 95 caracteres y la celda llena), el shader
+// y el anillo de vértices
+//------------------------------------------------------------------------------------------
+void TextRenderer::init(int scale) {
+
+    this->scale = scale > 0 ? scale : 1;
+
+    const int atlasWidth  = TEXT_ATLAS_COLUMNS * TEXT_GLYPH_SIZE;
+    const int atlasHeight = ATLAS_ROWS * TEXT_GLYPH_SIZE;
+    std::vector<unsigned char> pixels((size_t)atlasWidth * atlasHeight, 0);
+    for(int glyph = 0; glyph <= SOLID_GLYPH; glyph++) {
+        const int cellX = (glyph % TEXT_ATLAS_COLUMNS) * TEXT_GLYPH_SIZE;
+        const int cellY = (glyph / TEXT_ATLAS_COLUMNS) * TEXT_GLYPH_SIZE;
+        for(int row = 0; row < TEXT_GLYPH_SIZE; row++) {
+            const unsigned char bits = glyph == SOLID_GLYPH ? 0xFF : FONT_8X8[glyph][row];
+            for(int col = 0; col < TEXT_GLYPH_SIZE; col++) {
+                pixels[(size_t)(cellY + row) * atlasWidth + cellX + col] = (bits >> col) & 1 ? 255 : 0;
+            }
+        }
+    }
+    glGenTextures(1, &atlas);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    MemoryRegistry::add(MEMORIA_TEXTURA, atlas, MEMORIA_TEXTURAS, MemoryRegistry::textureBytes(atlasWidth, atlasHeight, 1, GL_R8, 1), "R8", "TextRenderer", "atlas del texto");
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    shader.initShaders(
+        "resources/shaders/vtext.glsl",
+        "resources/shaders/ftext.glsl"
+    );
+
+    glGenVertexArrays(1, &vao);
+
+ // Sitio para unos 2000 caracteres, para que el HUD no haga crecer la lista ni el anillo en pleno frame
+    vertices.reserve(2048 * 6);
+    ring.init(GL_ARRAY_BUFFER, vertices.capacity() * sizeof(TextVertex), "texto");
+    MemoryRegistry::add(MEMORIA_HOST, (unsigned long long)(size_t)this, MEMORIA_CPU, vertices.capacity() * sizeof(TextVertex), "TextVertex", "TextRenderer", "texto");
+
+}
+
+//-----------------------------------------------------------------------------
+// Añade una línea de texto con su esquina superior izquierda en (x, y) píxeles.
+// '\n' empieza otra línea; los caracteres fuera de la fuente salen como '?'
+//-----------------------------------------------------------------------------
+void TextRenderer::print(float x, float y, const char *text, glm::vec4 color) {
+
+    const float size = (float)(TEXT_GLYPH_SIZE * scale);
+    float penX = x;
+    for(const char *c = text; *c; c++) {
+        if(*c == '\n') {
+            penX = x;
+            y += lineHeight();
+            continue;
+        }
+        int glyph = (unsigned char)*c - FIRST_GLYPH;
+        if(glyph < 0 || glyph >= SOLID_GLYPH) glyph = '?' - FIRST_GLYPH;
+        if(glyph != 0) quad(penX, y, size, size, glyph, color);
+        penX += size;
+    }
+
+}
+
+//--------------------------------------------------
+// Añade un rectángulo de color liso (fondo del texto)
+//--------------------------------------------------
+void TextRenderer::panel(float x, float y, float width, float height, glm::vec4 color) {
+
+    quad(x, y, width, height, SOLID_GLYPH, color);
+
+}
+
+//------------------------------------------------------------------------------------------
+// Dibuja todo lo acumulado sobre el framebuffer activo (width x height) en una sola llamada
+// y vacía la lista. Sin profundidad; la mezcla se deja activada como la espera la escena
+//------------------------------------------------------------------------------------------
+void TextRenderer::draw(int width, int height) {
+
+    if(vertices.empty() || width <= 0 || height <= 0) {
+        vertices.clear();
+        return;
+    }
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+
+    // Cada dibujo usa su parte del anillo; alineado al vértice, el offset es el primer vértice
+    ring.beginFrame();
+    size_t offset = 0;
+    void *data = ring.allocate(vertices.size() * sizeof(TextVertex), sizeof(TextVertex), offset);
+    if(!data) {
+        ring.endFrame();
+        glEnable(GL_DEPTH_TEST);
+        vertices.clear();
+        return;
+    }
+    std::memcpy(data, vertices.data(), vertices.size() * sizeof(TextVertex));
+    ring.commit();
+
+    // Los atributos se apuntan al anillo en cada dibujo (como las instancias): al crecer, el buffer
+    // es otro objeto aunque el driver le dé el mismo nombre
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, ring.getId());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offsetof(TextVertex, x));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offsetof(TextVertex, u));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextVertex), (void *)offsetof(TextVertex, color));
+    glEnableVertexAttribArray(2);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    shader.useShaders();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas);
+    shader.setInt ("uAtlas", 0);
+    shader.setVec2("uScreen", glm::vec2(2.0f / width, 2.0f / height));
+    glDrawArrays(GL_TRIANGLES, (GLint)(offset / sizeof(TextVertex)), (GLsizei)vertices.size());
+    glBindVertexArray(0);
+    ring.endFrame();
+    RenderStats::countTexture();
+    RenderStats::countVao();
+    RenderStats::countDraw((unsigned int)vertices.size());
+
+    glEnable(GL_DEPTH_TEST);
+    vertices.clear();
+
+}
+
+void TextRenderer::quad(float x, float y, float width, float height, int glyph, glm::vec4 color) {
+
+    const float u0 = (float)(glyph % TEXT_ATLAS_COLUMNS) / TEXT_ATLAS_COLUMNS;
+    const float v0 = (float)(glyph / TEXT_ATLAS_COLUMNS) / ATLAS_ROWS;
+    const float u1 = u0 + 1.0f / TEXT_ATLAS_COLUMNS;
+    const float v1 = v0 + 1.0f / ATLAS_ROWS;
+
+    TextVertex corner;
+    for(int k = 0; k < 4; k++) corner.color[k] = (unsigned char)(glm::clamp(color[k], 0.0f, 1.0f) * 255.0f + 0.5f);
+
+    const float xs[6] = { x, x + width, x + width, x, x + width, x };
+    const float ys[6] = { y, y, y + height, y, y + height, y + height };
+    const float us[6] = { u0, u1, u1, u0, u1, u0 };
+    const float vs[6] = { v0, v0, v1, v0, v1, v1 };
+    for(int k = 0; k < 6; k++) {
+        corner.x = xs[k];
+        corner.y = ys[k];
+        corner.u = us[k];
+        corner.v = vs[k];
+        vertices.push_back(corner);
+    }
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+TextRenderer::~TextRenderer() {
+
+    if(vao) glDeleteVertexArrays(1, &vao);
+    if(atlas) {
+        glDeleteTextures(1, &atlas);
+        MemoryRegistry::remove(MEMORIA_TEXTURA, atlas);
+    }
+    MemoryRegistry::remove(MEMORIA_HOST, (unsigned long long)(size_t)this);
+
+}
@@ -0,0 +1,56 @@
+#ifndef TEXTRENDERER_H
+#define TEXTRENDERER_H
+
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Shaders.h"
+#include "RingBuffer.h"
+
+// Tamaño de cada carácter de la fuente (píxeles) y columnas del atlas
+const int TEXT_GLYPH_SIZE    = 8;
+const int TEXT_ATLAS_COLUMNS = 16;
+
+// Texto en pantalla con una fuente de mapa de bits de 8x8 (ASCII 32-126) en un atlas. print() y
+// panel() solo acumulan rectángulos; draw() los copia a un anillo de vértices (como las instancias,
+// sin volver a crear el buffer cada frame) y los dibuja en una única llamada
+class TextRenderer {
+
+    public:
+
+        TextRenderer();
+
+        void init (int scale = 2);
+        void print(float x, float y, const char *text, glm::vec4 color);
+        void panel(float x, float y, float width, float height, glm::vec4 color);
+        void draw (int width, int height);
+
+        float charWidth () const { return (float)(TEXT_GLYPH_SIZE * scale); }
+        float lineHeight() const { return (float)((TEXT_GLYPH_SIZE + 2) * scale); }
+
+        const RingBufferStats& getStats() const { return ring.getStats(); }
+
+        virtual ~TextRenderer();
+
+    private:
+
+        // Vértice en píxeles con origen arriba a la izquierda
+        struct TextVertex {
+            float         x, y;
+            float         u, v;
+            unsigned char color[4];
+        };
+
+        Shaders                 shader;
+        GLuint                  vao;
+        RingBuffer              ring;
+        GLuint                  atlas;
+        int                     scale;      // Píxeles de pantalla por píxel de la fuente
+        std::vector<TextVertex> vertices;
+
+        void quad(float x, float y, float width, float height, int glyph, glm::vec4 color);
+
+};
+
+#endif /* TEXTRENDERER_H */
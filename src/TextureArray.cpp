@@ -0,0 +1,161 @@
+#include "TextureArray.h"
+#include "RenderStats.h"
+#include "MemoryRegistry.h"
+#include "stb_image.h"
+
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+
+TextureArray::TextureArray(int layerSize) : textureID(0), layerSize(layerSize), levelCount(1) {
+
+    for(int size = layerSize; size > 1; size /= 2) levelCount++;
+
+}
+
+//------------------------------------------------------
+// Añade una imagen al array y devuelve su índice de capa
+//------------------------------------------------------
+int TextureArray::addLayer(const char *textureFile) {
+
+    Layer layer;
+    layer.file      = textureFile;
+    layer.useCooked = false;
+    layers.push_back(std::move(layer));
+    return (int)layers.size() - 1;
+
+}
+
+//---------------------------------------------------------------------------------------
+// Prepara una capa en CPU (se puede llamar desde cualquier hilo, una vez por capa): usa el
+// .dds cocinado si tiene el tamaño de la capa y, si no, decodifica y reescala la imagen
+//---------------------------------------------------------------------------------------
+bool TextureArray::decodeLayer(int index, bool s3tcSupported) {
+
+    Layer &layer = layers[index];
+    std::string cookedFile = TextureCooker::cookedFile(layer.file);
+    layer.useCooked = TextureCooker::openCooked(cookedFile.c_str(), layer.cooked) &&
+                      layer.cooked.levels.size() == (size_t)levelCount &&
+                      layer.cooked.levels[0].width == layerSize && layer.cooked.levels[0].height == layerSize &&
+                      (!layer.cooked.compressed || s3tcSupported);
+    if(layer.useCooked) return true;
+
+    layer.cooked = CookedTexture();
+    decodeSource(layer);
+    return !layer.levels.empty() && layer.levels[0].width == layerSize;
+
+}
+
+//---------------------------------------------------------------------------------------
+// Crea el array en la GPU con todas las capas (hilo del contexto). Solo se usa el formato
+// comprimido si todas las capas están cocinadas con el mismo; si no, las capas se suben en
+// RGBA8 y las que estaban comprimidas se vuelven a decodificar desde la imagen original
+//---------------------------------------------------------------------------------------
+void TextureArray::upload() {
+
+    if(layers.empty()) return;
+
+    bool   compressed = true;
+    GLenum format     = layers[0].useCooked ? layers[0].cooked.format : GL_RGBA8;
+    for(const auto& layer : layers) {
+        if(!layer.useCooked || !layer.cooked.compressed || layer.cooked.format != format) compressed = false;
+    }
+    if(!compressed) {
+        format = GL_RGBA8;
+        for(auto& layer : layers) {
+            if(layer.useCooked && layer.cooked.compressed) {
+                layer.useCooked = false;
+                layer.cooked = CookedTexture();
+                decodeSource(layer);
+            }
+        }
+    }
+
+    const GLsizei count = (GLsizei)layers.size();
+    size_t bytes = 0;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    for(int level = 0; level < levelCount; level++) {
+        int size = std::max(1, layerSize >> level);
+        if(compressed) {
+            GLsizei layerBytes = (GLsizei)layers[0].cooked.levels[level].size;
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, size, size, count, 0, layerBytes * count, NULL);
+            bytes += (size_t)layerBytes * count;
+            for(GLsizei i = 0; i < count; i++) {
+                const CookedLevel &data = layers[i].cooked.levels[level];
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, i, size, size, 1, format, (GLsizei)data.size, data.data);
+            }
+        } else {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, size, size, count, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            bytes += (size_t)size * size * 4 * count;
+            for(GLsizei i = 0; i < count; i++) {
+                const void *data = layers[i].useCooked ? (const void *)layers[i].cooked.levels[level].data
+                                                       : (const void *)layers[i].levels[level].pixels.data();
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, i, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            }
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    char name[64];
+    snprintf(name, sizeof(name), "array de %d capas de %dx%d", (int)count, layerSize, layerSize);
+    MemoryRegistry::add(MEMORIA_TEXTURA, textureID, MEMORIA_TEXTURAS, bytes, MemoryRegistry::formatName(format), "TextureArray", name);
+
+ // Los datos de CPU ya no hacen falta
+    for(auto& layer : layers) {
+        layer.cooked = CookedTexture();
+        std::vector<MipLevel>().swap(layer.levels);
+    }
+
+}
+
+//---------------------------------------------
+// Enlaza el array en la unidad de textura dada
+//---------------------------------------------
+void TextureArray::bind(unsigned int unit) const {
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    RenderStats::countTexture();
+
+}
+
+//------------------------------------------------------------------------------------------
+// Decodifica la imagen original, la reescala al tamaño de capa y genera sus mipmaps. Si no se
+// puede cargar la capa queda en negro, como una textura sin imagen
+//------------------------------------------------------------------------------------------
+void TextureArray::decodeSource(Layer &layer) {
+
+    int width, height, channels;
+    unsigned char *rgba = stbi_load(layer.file.c_str(), &width, &height, &channels, 4);
+    MipLevel base;
+    base.width  = layerSize;
+    base.height = layerSize;
+    if(rgba) {
+        if(width == layerSize && height == layerSize) base.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+        else TextureCooker::resample(rgba, width, height, base);
+        stbi_image_free(rgba);
+    } else {
+        std::cerr << "Error al cargar textura: " << layer.file << std::endl;
+        base.pixels.assign((size_t)layerSize * layerSize * 4, 0);
+        for(size_t i = 3; i < base.pixels.size(); i += 4) base.pixels[i] = 255;
+    }
+    TextureCooker::buildMipChain(base.pixels.data(), layerSize, layerSize, layer.levels);
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+TextureArray::~TextureArray() {
+
+    if(textureID) {
+        glDeleteTextures(1, &textureID);
+        MemoryRegistry::remove(MEMORIA_TEXTURA, textureID);
+    }
+
+}
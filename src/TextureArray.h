@@ -0,0 +1,52 @@
+#ifndef TEXTUREARRAY_H
+#define TEXTUREARRAY_H
+
+#include <vector>
+#include <string>
+#include <GL/glew.h>
+
+#include "TextureCooker.h"
+
+// Tamaño (ancho y alto) de cada capa; las imágenes se reescalan a él al cargarlas o cocinarlas
+const int TEXTURE_LAYER_SIZE = 1024;
+
+// Texturas de material empaquetadas en un único GL_TEXTURE_2D_ARRAY: se enlaza una sola
+// vez y cada dibujo elige su imagen con el índice de capa
+class TextureArray {
+
+    public:
+
+        explicit TextureArray(int layerSize = TEXTURE_LAYER_SIZE);
+
+        int  addLayer(const char *textureFile);
+        bool decodeLayer(int layer, bool s3tcSupported);
+        void upload();
+        void bind(unsigned int unit) const;
+
+        GLuint             getId()        const { return textureID; }
+        int                getLayerSize() const { return layerSize; }
+        int                layerCount()   const { return (int)layers.size(); }
+        const std::string& layerFile(int layer) const { return layers[layer].file; }
+        bool               layerCooked(int layer) const { return layers[layer].useCooked; }
+
+        virtual ~TextureArray();
+
+    private:
+
+        struct Layer {
+            std::string           file;
+            CookedTexture         cooked;
+            bool                  useCooked;
+            std::vector<MipLevel> levels;
+        };
+
+        GLuint             textureID;
+        int                layerSize;
+        int                levelCount;
+        std::vector<Layer> layers;
+
+        void decodeSource(Layer &layer);
+
+};
+
+#endif /* TEXTUREARRAY_H */
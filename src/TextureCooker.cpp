@@ -0,0 +1,523 @@
+#include "TextureCooker.h"
+#include "stb_image.h"
+#include "MemoryRegistry.h"
+
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TEXTURECOOKER_SSE2
+    #include <emmintrin.h>
+#endif
+
+// Constantes del formato DDS
+static const uint32_t DDS_MAGIC         = 0x20534444;   // "DDS "
+static const uint32_t DDSD_CAPS         = 0x1;
+static const uint32_t DDSD_HEIGHT       = 0x2;
+static const uint32_t DDSD_WIDTH        = 0x4;
+static const uint32_t DDSD_PITCH        = 0x8;
+static const uint32_t DDSD_PIXELFORMAT  = 0x1000;
+static const uint32_t DDSD_MIPMAPCOUNT  = 0x20000;
+static const uint32_t DDSD_LINEARSIZE   = 0x80000;
+static const uint32_t DDPF_ALPHAPIXELS  = 0x1;
+static const uint32_t DDPF_FOURCC       = 0x4;
+static const uint32_t DDPF_RGB          = 0x40;
+static const uint32_t DDSCAPS_COMPLEX   = 0x8;
+static const uint32_t DDSCAPS_TEXTURE   = 0x1000;
+static const uint32_t DDSCAPS_MIPMAP    = 0x400000;
+static const uint32_t FOURCC_DXT1       = 0x31545844;   // "DXT1"
+static const uint32_t FOURCC_DXT5       = 0x35545844;   // "DXT5"
+static const int      DDS_HEADER_DWORDS = 31;           // 124 bytes
+
+// Tablas de conversión sRGB <-> lineal (la de codificación se indexa con 12 bits)
+struct SrgbTables {
+    float         toLinear[256];
+    unsigned char toSrgb[4096];
+
+    SrgbTables() {
+        for(int i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            toLinear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for(int i = 0; i < 4096; i++) {
+            float l = i / 4095.0f;
+            float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            toSrgb[i] = (unsigned char)std::min(255.0f, std::max(0.0f, c * 255.0f + 0.5f));
+        }
+    }
+};
+
+static const SrgbTables& srgbTables() {
+    static const SrgbTables tables;
+    return tables;
+}
+
+//------------------------------------------------------------------------------
+// Reduce a la mitad un nivel RGBA en coma flotante (lineal) con un filtro de caja
+//------------------------------------------------------------------------------
+static void downsampleLinear(const std::vector<float> &src, int w, int h, std::vector<float> &dst, int dw, int dh) {
+
+    dst.resize((size_t)dw * dh * 4);
+    for(int y = 0; y < dh; y++) {
+        int y0 = std::min(2 * y, h - 1);
+        int y1 = std::min(2 * y + 1, h - 1);
+        const float *row0 = &src[(size_t)y0 * w * 4];
+        const float *row1 = &src[(size_t)y1 * w * 4];
+        float       *out  = &dst[(size_t)y * dw * 4];
+        for(int x = 0; x < dw; x++) {
+            int x0 = std::min(2 * x, w - 1) * 4;
+            int x1 = std::min(2 * x + 1, w - 1) * 4;
+#ifdef TEXTURECOOKER_SSE2
+            __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(row0 + x0), _mm_loadu_ps(row0 + x1)),
+                                    _mm_add_ps(_mm_loadu_ps(row1 + x0), _mm_loadu_ps(row1 + x1)));
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+            for(int c = 0; c < 4; c++) {
+                out[x * 4 + c] = 0.25f * (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]);
+            }
+#endif
+        }
+    }
+
+}
+
+//-------------------------------------------------------------
+// Convierte un nivel lineal en coma flotante a RGBA8 (sRGB)
+//-------------------------------------------------------------
+static void quantizeLevel(const std::vector<float> &src, int w, int h, MipLevel &level) {
+
+    const SrgbTables &tables = srgbTables();
+    level.width  = w;
+    level.height = h;
+    level.pixels.resize((size_t)w * h * 4);
+    size_t count = (size_t)w * h;
+
+#ifdef TEXTURECOOKER_SSE2
+    const __m128 scale = _mm_setr_ps(4095.0f, 4095.0f, 4095.0f, 255.0f);
+    const __m128 zero  = _mm_setzero_ps();
+    const __m128 one   = _mm_set1_ps(1.0f);
+    for(size_t i = 0; i < count; i++) {
+        __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&src[i * 4]), zero), one);
+        __m128i q = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+        int32_t idx[4];
+        _mm_storeu_si128((__m128i *)idx, q);
+        level.pixels[i * 4 + 0] = tables.toSrgb[idx[0]];
+        level.pixels[i * 4 + 1] = tables.toSrgb[idx[1]];
+        level.pixels[i * 4 + 2] = tables.toSrgb[idx[2]];
+        level.pixels[i * 4 + 3] = (unsigned char)idx[3];
+    }
+#else
+    for(size_t i = 0; i < count; i++) {
+        for(int c = 0; c < 3; c++) {
+            float v = std::min(1.0f, std::max(0.0f, src[i * 4 + c]));
+            level.pixels[i * 4 + c] = tables.toSrgb[(int)(v * 4095.0f + 0.5f)];
+        }
+        float a = std::min(1.0f, std::max(0.0f, src[i * 4 + 3]));
+        level.pixels[i * 4 + 3] = (unsigned char)(a * 255.0f + 0.5f);
+    }
+#endif
+
+}
+
+//---------------------------------------------------------------------------------------
+// Genera la cadena completa de mipmaps: los colores se promedian en espacio lineal y el
+// alfa tal cual; cada nivel se calcula a partir del anterior en coma flotante
+//---------------------------------------------------------------------------------------
+void TextureCooker::buildMipChain(const unsigned char *rgba, int width, int height, std::vector<MipLevel> &levels) {
+
+    const SrgbTables &tables = srgbTables();
+    std::vector<float> current((size_t)width * height * 4);
+    for(size_t i = 0; i < (size_t)width * height; i++) {
+        current[i * 4 + 0] = tables.toLinear[rgba[i * 4 + 0]];
+        current[i * 4 + 1] = tables.toLinear[rgba[i * 4 + 1]];
+        current[i * 4 + 2] = tables.toLinear[rgba[i * 4 + 2]];
+        current[i * 4 + 3] = rgba[i * 4 + 3] / 255.0f;
+    }
+
+    levels.clear();
+    MipLevel base;
+    base.width  = width;
+    base.height = height;
+    base.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+    levels.push_back(base);
+
+    std::vector<float> next;
+    int w = width;
+    int h = height;
+    while(w > 1 || h > 1) {
+        int dw = std::max(1, w / 2);
+        int dh = std::max(1, h / 2);
+        downsampleLinear(current, w, h, next, dw, dh);
+        MipLevel level;
+        quantizeLevel(next, dw, dh, level);
+        levels.push_back(level);
+        current.swap(next);
+        w = dw;
+        h = dh;
+    }
+
+}
+
+//--------------------------------------------------------------------------------------
+// Reescala una imagen RGBA8 al tamaño de out: se parte del mipmap más pequeño que siga
+// siendo mayor o igual que el destino y se interpola de forma bilineal desde él
+//--------------------------------------------------------------------------------------
+void TextureCooker::resample(const unsigned char *rgba, int width, int height, MipLevel &out) {
+
+    std::vector<MipLevel> levels;
+    buildMipChain(rgba, width, height, levels);
+    size_t base = 0;
+    while(base + 1 < levels.size() && levels[base + 1].width >= out.width && levels[base + 1].height >= out.height) base++;
+    const MipLevel &src = levels[base];
+
+    out.pixels.resize((size_t)out.width * out.height * 4);
+    float sx = (float)src.width  / out.width;
+    float sy = (float)src.height / out.height;
+    for(int y = 0; y < out.height; y++) {
+        float fy = std::max(0.0f, (y + 0.5f) * sy - 0.5f);
+        int   y0 = std::min((int)fy, src.height - 1);
+        int   y1 = std::min(y0 + 1, src.height - 1);
+        float ty = fy - y0;
+        for(int x = 0; x < out.width; x++) {
+            float fx = std::max(0.0f, (x + 0.5f) * sx - 0.5f);
+            int   x0 = std::min((int)fx, src.width - 1);
+            int   x1 = std::min(x0 + 1, src.width - 1);
+            float tx = fx - x0;
+            const unsigned char *p00 = &src.pixels[((size_t)y0 * src.width + x0) * 4];
+            const unsigned char *p01 = &src.pixels[((size_t)y0 * src.width + x1) * 4];
+            const unsigned char *p10 = &src.pixels[((size_t)y1 * src.width + x0) * 4];
+            const unsigned char *p11 = &src.pixels[((size_t)y1 * src.width + x1) * 4];
+            unsigned char *dst = &out.pixels[((size_t)y * out.width + x) * 4];
+            for(int c = 0; c < 4; c++) {
+                float top    = p00[c] + (p01[c] - p00[c]) * tx;
+                float bottom = p10[c] + (p11[c] - p10[c]) * tx;
+                dst[c] = (unsigned char)(top + (bottom - top) * ty + 0.5f);
+            }
+        }
+    }
+
+}
+
+//--------------------------------------------------------------------
+// Copia un bloque 4x4 del nivel (repitiendo el borde si se sale)
+//--------------------------------------------------------------------
+static void fetchBlock(const MipLevel &level, int bx, int by, unsigned char block[16][4]) {
+
+    for(int y = 0; y < 4; y++) {
+        int sy = std::min(by * 4 + y, level.height - 1);
+        for(int x = 0; x < 4; x++) {
+            int sx = std::min(bx * 4 + x, level.width - 1);
+            std::memcpy(block[y * 4 + x], &level.pixels[((size_t)sy * level.width + sx) * 4], 4);
+        }
+    }
+
+}
+
+static uint16_t pack565(int r, int g, int b) {
+    return (uint16_t)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+static void unpack565(uint16_t c, int rgb[3]) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+//------------------------------------------------------------------------------------------
+// Codifica la parte de color de un bloque (BC1 de 4 colores): extremos de la caja envolvente
+// reducida, orientando la diagonal según la covarianza de los canales
+//------------------------------------------------------------------------------------------
+static void encodeColorBlock(const unsigned char block[16][4], unsigned char out[8]) {
+
+    int minC[3] = {255, 255, 255};
+    int maxC[3] = {0, 0, 0};
+    int mean[3] = {0, 0, 0};
+    for(int i = 0; i < 16; i++) {
+        for(int c = 0; c < 3; c++) {
+            minC[c] = std::min(minC[c], (int)block[i][c]);
+            maxC[c] = std::max(maxC[c], (int)block[i][c]);
+            mean[c] += block[i][c];
+        }
+    }
+    for(int c = 0; c < 3; c++) mean[c] = (mean[c] + 8) / 16;
+
+ // Eje principal aproximado: el canal de mayor rango; los otros se invierten si su covarianza es negativa
+    int axis = 0;
+    for(int c = 1; c < 3; c++) if(maxC[c] - minC[c] > maxC[axis] - minC[axis]) axis = c;
+    for(int c = 0; c < 3; c++) {
+        if(c == axis) continue;
+        int cov = 0;
+        for(int i = 0; i < 16; i++) cov += (block[i][axis] - mean[axis]) * (block[i][c] - mean[c]);
+        if(cov < 0) std::swap(minC[c], maxC[c]);
+    }
+
+    int c0[3], c1[3];
+    for(int c = 0; c < 3; c++) {
+        int inset = (maxC[c] - minC[c]) / 16;
+        c0[c] = std::min(255, std::max(0, maxC[c] - inset));
+        c1[c] = std::min(255, std::max(0, minC[c] + inset));
+    }
+    uint16_t e0 = pack565(c0[0], c0[1], c0[2]);
+    uint16_t e1 = pack565(c1[0], c1[1], c1[2]);
+    if(e0 < e1) std::swap(e0, e1);
+
+    uint32_t indices = 0;
+    if(e0 != e1) {
+        int palette[4][3];
+        unpack565(e0, palette[0]);
+        unpack565(e1, palette[1]);
+        for(int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for(int i = 0; i < 16; i++) {
+            int best = 0, bestDist = 1 << 30;
+            for(int p = 0; p < 4; p++) {
+                int dr = block[i][0] - palette[p][0];
+                int dg = block[i][1] - palette[p][1];
+                int db = block[i][2] - palette[p][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if(dist < bestDist) { bestDist = dist; best = p; }
+            }
+            indices |= (uint32_t)best << (2 * i);
+        }
+    }
+
+    out[0] = (unsigned char)(e0 & 0xFF); out[1] = (unsigned char)(e0 >> 8);
+    out[2] = (unsigned char)(e1 & 0xFF); out[3] = (unsigned char)(e1 >> 8);
+    for(int b = 0; b < 4; b++) out[4 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+
+}
+
+//-----------------------------------------------------------
+// Codifica el alfa de un bloque BC3 (modo de 8 valores)
+//-----------------------------------------------------------
+static void encodeAlphaBlock(const unsigned char block[16][4], unsigned char out[8]) {
+
+    int a0 = 0, a1 = 255;
+    for(int i = 0; i < 16; i++) {
+        a0 = std::max(a0, (int)block[i][3]);
+        a1 = std::min(a1, (int)block[i][3]);
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+
+    uint64_t indices = 0;
+    if(a0 != a1) {
+        int palette[8] = {a0, a1};
+        for(int p = 1; p < 7; p++) palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+        for(int i = 0; i < 16; i++) {
+            int best = 0, bestDist = 1 << 30;
+            for(int p = 0; p < 8; p++) {
+                int dist = std::abs(block[i][3] - palette[p]);
+                if(dist < bestDist) { bestDist = dist; best = p; }
+            }
+            indices |= (uint64_t)best << (3 * i);
+        }
+    }
+    for(int b = 0; b < 6; b++) out[2 + b] = (unsigned char)((indices >> (8 * b)) & 0xFF);
+
+}
+
+void TextureCooker::encodeBC1(const MipLevel &level, std::vector<unsigned char> &out) {
+
+    int bw = (level.width + 3) / 4, bh = (level.height + 3) / 4;
+    out.resize((size_t)bw * bh * 8);
+    unsigned char block[16][4];
+    for(int by = 0; by < bh; by++) {
+        for(int bx = 0; bx < bw; bx++) {
+            fetchBlock(level, bx, by, block);
+            encodeColorBlock(block, &out[((size_t)by * bw + bx) * 8]);
+        }
+    }
+
+}
+
+void TextureCooker::encodeBC3(const MipLevel &level, std::vector<unsigned char> &out) {
+
+    int bw = (level.width + 3) / 4, bh = (level.height + 3) / 4;
+    out.resize((size_t)bw * bh * 16);
+    unsigned char block[16][4];
+    for(int by = 0; by < bh; by++) {
+        for(int bx = 0; bx < bw; bx++) {
+            fetchBlock(level, bx, by, block);
+            unsigned char *dst = &out[((size_t)by * bw + bx) * 16];
+            encodeAlphaBlock(block, dst);
+            encodeColorBlock(block, dst + 8);
+        }
+    }
+
+}
+
+//------------------------------------------------------------------------------
+// Cocina una textura: decodifica, genera mipmaps, comprime y escribe el DDS; si se
+// indica un tamaño la imagen se reescala antes a size x size (capas de un array)
+//------------------------------------------------------------------------------
+bool TextureCooker::cook(const char *srcFile, const char *dstFile, bool compress, int size) {
+
+    int width, height, channels;
+    unsigned char *rgba = stbi_load(srcFile, &width, &height, &channels, 4);
+    if(!rgba) {
+        std::cerr << "Error al cargar textura: " << srcFile << std::endl;
+        return false;
+    }
+
+    bool hasAlpha = false;
+    for(size_t i = 0; i < (size_t)width * height && !hasAlpha; i++) hasAlpha = rgba[i * 4 + 3] != 255;
+
+    std::vector<MipLevel> levels;
+    if(size > 0 && (width != size || height != size)) {
+        MipLevel resized;
+        resized.width  = size;
+        resized.height = size;
+        resample(rgba, width, height, resized);
+        width  = size;
+        height = size;
+        buildMipChain(resized.pixels.data(), width, height, levels);
+    } else {
+        buildMipChain(rgba, width, height, levels);
+    }
+    stbi_image_free(rgba);
+
+    std::vector< std::vector<unsigned char> > payloads(levels.size());
+    for(size_t i = 0; i < levels.size(); i++) {
+        if(!compress)     payloads[i].swap(levels[i].pixels);
+        else if(hasAlpha) encodeBC3(levels[i], payloads[i]);
+        else              encodeBC1(levels[i], payloads[i]);
+    }
+
+    uint32_t header[DDS_HEADER_DWORDS];
+    std::memset(header, 0, sizeof(header));
+    header[0]  = 124;
+    header[1]  = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+                 (compress ? DDSD_LINEARSIZE : DDSD_PITCH);
+    header[2]  = (uint32_t)height;
+    header[3]  = (uint32_t)width;
+    header[4]  = compress ? (uint32_t)payloads[0].size() : (uint32_t)width * 4;
+    header[6]  = (uint32_t)levels.size();
+    header[18] = 32;
+    if(compress) {
+        header[19] = DDPF_FOURCC;
+        header[20] = hasAlpha ? FOURCC_DXT5 : FOURCC_DXT1;
+    } else {
+        header[19] = DDPF_RGB | DDPF_ALPHAPIXELS;
+        header[21] = 32;
+        header[22] = 0x000000FF;
+        header[23] = 0x0000FF00;
+        header[24] = 0x00FF0000;
+        header[25] = 0xFF000000;
+    }
+    header[26] = DDSCAPS_TEXTURE | DDSCAPS_MIPMAP | DDSCAPS_COMPLEX;
+
+    FILE *file = std::fopen(dstFile, "wb");
+    if(!file) {
+        std::cerr << "El fichero " << dstFile << " no se puede crear." << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(&DDS_MAGIC, 4, 1, file) == 1 && std::fwrite(header, sizeof(header), 1, file) == 1;
+    for(size_t i = 0; i < payloads.size() && ok; i++) {
+        ok = std::fwrite(payloads[i].data(), 1, payloads[i].size(), file) == payloads[i].size();
+    }
+    std::fclose(file);
+    return ok;
+
+}
+
+//----------------------------------------------------------
+// Nombre del fichero cocinado: misma ruta con extensión .dds
+//----------------------------------------------------------
+std::string TextureCooker::cookedFile(const std::string &srcFile) {
+
+    size_t dot   = srcFile.find_last_of('.');
+    size_t slash = srcFile.find_last_of("/\\");
+    if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) return srcFile + ".dds";
+    return srcFile.substr(0, dot) + ".dds";
+
+}
+
+//-----------------------------------------------------------------------------
+// Abre un DDS cocinado con mmap y localiza cada nivel sin copiar los datos
+//-----------------------------------------------------------------------------
+bool TextureCooker::openCooked(const char *file, CookedTexture &texture) {
+
+    texture.levels.clear();
+    if(!texture.file.open(file)) return false;
+
+    const size_t headerSize = 4 + DDS_HEADER_DWORDS * 4;
+    if(texture.file.size() < headerSize) return false;
+    uint32_t magic;
+    uint32_t header[DDS_HEADER_DWORDS];
+    std::memcpy(&magic, texture.file.data(), 4);
+    std::memcpy(header, texture.file.data() + 4, sizeof(header));
+    if(magic != DDS_MAGIC || header[0] != 124) return false;
+
+    int width  = (int)header[3];
+    int height = (int)header[2];
+    int count  = (header[1] & DDSD_MIPMAPCOUNT) ? std::max(1, (int)header[6]) : 1;
+    size_t blockBytes = 0;
+    if(header[19] & DDPF_FOURCC) {
+        if     (header[20] == FOURCC_DXT1) { texture.format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;  blockBytes = 8;  }
+        else if(header[20] == FOURCC_DXT5) { texture.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; blockBytes = 16; }
+        else return false;
+        texture.compressed = true;
+    } else {
+        if(header[21] != 32 || header[22] != 0x000000FF) return false;
+        texture.format     = GL_RGBA8;
+        texture.compressed = false;
+    }
+
+    size_t offset = headerSize;
+    for(int i = 0; i < count; i++) {
+        CookedLevel level;
+        level.width  = width;
+        level.height = height;
+        level.size   = texture.compressed ? (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes
+                                          : (size_t)width * height * 4;
+        if(offset + level.size > texture.file.size()) return false;
+        level.data = texture.file.data() + offset;
+        offset += level.size;
+        texture.levels.push_back(level);
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+
+}
+
+//---------------------------------------------------------------------------
+// Sube todos los niveles de una textura cocinada (hilo del contexto OpenGL)
+//---------------------------------------------------------------------------
+GLuint TextureCooker::uploadCooked(const CookedTexture &texture, const char *name) {
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    for(size_t i = 0; i < texture.levels.size(); i++) {
+        const CookedLevel &level = texture.levels[i];
+        if(texture.compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, texture.format, level.width, level.height, 0, (GLsizei)level.size, level.data);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.levels.size() - 1);
+
+    size_t bytes = 0;
+    for(const CookedLevel &level : texture.levels) bytes += level.size;
+    MemoryRegistry::add(MEMORIA_TEXTURA, textureID, MEMORIA_TEXTURAS, bytes,
+                        MemoryRegistry::formatName(texture.compressed ? texture.format : GL_RGBA8), "TextureCooker", name);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    return textureID;
+
+}
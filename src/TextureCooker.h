@@ -0,0 +1,52 @@
+#ifndef TEXTURECOOKER_H
+#define TEXTURECOOKER_H
+
+#include <vector>
+#include <string>
+#include <GL/glew.h>
+
+#include "MappedFile.h"
+
+// Un nivel de la cadena de mipmaps en RGBA8
+struct MipLevel {
+    int                        width;
+    int                        height;
+    std::vector<unsigned char> pixels;
+};
+
+// Nivel de una textura cocinada: apunta directamente al fichero proyectado
+struct CookedLevel {
+    int                  width;
+    int                  height;
+    const unsigned char *data;
+    size_t               size;
+};
+
+// Textura cocinada (contenedor DDS) abierta con mmap y lista para subirse sin decodificar
+struct CookedTexture {
+    MappedFile               file;
+    GLenum                   format;       // Formato comprimido S3TC o GL_RGBA8 sin comprimir
+    bool                     compressed;
+    std::vector<CookedLevel> levels;
+};
+
+// Paso de cocinado offline: genera los mipmaps en CPU con un filtrado en espacio lineal
+// (gamma correcto), opcionalmente los comprime en BC1/BC3 y los guarda en un fichero DDS
+class TextureCooker {
+
+    public:
+
+        static bool        cook      (const char *srcFile, const char *dstFile, bool compress, int size = 0);
+        static std::string cookedFile(const std::string &srcFile);
+
+        static void buildMipChain(const unsigned char *rgba, int width, int height, std::vector<MipLevel> &levels);
+        static void resample     (const unsigned char *rgba, int width, int height, MipLevel &out);
+        static void encodeBC1    (const MipLevel &level, std::vector<unsigned char> &out);
+        static void encodeBC3    (const MipLevel &level, std::vector<unsigned char> &out);
+
+        static bool   openCooked  (const char *file, CookedTexture &texture);
+        static GLuint uploadCooked(const CookedTexture &texture, const char *name = NULL);
+
+};
+
+#endif /* TEXTURECOOKER_H */
@@ -0,0 +1,200 @@
+#include "Trace.h"
+
+#include <iostream>
+#include <cstdio>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+// Anillo de un hilo. Solo lo escribe su hilo; head se publica después de escribir cada evento
+struct TraceRing {
+    TraceEvent                          events[TRACE_RING_EVENTS];
+    std::atomic<unsigned long long>     head;
+    const char                         *name;
+    int                                 id;
+    const char                         *openNames[TRACE_MAX_DEPTH];    // Tramos de TRACE_BEGIN abiertos
+    long long                           openStarts[TRACE_MAX_DEPTH];
+    int                                 depth;
+};
+
+static const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+static std::atomic<TraceRing*> traceRings[TRACE_MAX_THREADS];
+static std::atomic<int>        traceNumRings(0);
+static thread_local TraceRing *traceRing = NULL;
+static thread_local bool       traceFull = false;
+
+static std::mutex              internMutex;
+static std::set<std::string>   internNames;
+
+//------------------------------------------------------------------------------------------
+// Anillo del hilo actual; se crea la primera vez y no se libera (se puede volcar tras acabar
+// el hilo). NULL si ya hay TRACE_MAX_THREADS hilos con traza
+//------------------------------------------------------------------------------------------
+static TraceRing* threadRing() {
+
+    if(traceRing || traceFull) return traceRing;
+
+    int id = traceNumRings.fetch_add(1);
+    if(id >= TRACE_MAX_THREADS) {
+        traceFull = true;
+        return NULL;
+    }
+    TraceRing *ring = new TraceRing();
+    ring->head  = 0;
+    ring->name  = NULL;
+    ring->id    = id;
+    ring->depth = 0;
+    traceRings[id].store(ring, std::memory_order_release);
+    traceRing = ring;
+    return ring;
+
+}
+
+bool Trace::enabled() {
+
+#ifdef AQUARIO_TRACE
+    return true;
+#else
+    return false;
+#endif
+
+}
+
+long long Trace::now() {
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceEpoch).count();
+
+}
+
+//----------------------------------------------------------------------
+// Nombre del hilo actual en la traza (un literal; por defecto "hilo N")
+//----------------------------------------------------------------------
+void Trace::setThreadName(const char *name) {
+
+    TraceRing *ring = threadRing();
+    if(ring) ring->name = name;
+
+}
+
+void Trace::record(const char *name, long long start, long long end) {
+
+    TraceRing *ring = threadRing();
+    if(!ring) return;
+    unsigned long long head = ring->head.load(std::memory_order_relaxed);
+    TraceEvent &event = ring->events[head & (TRACE_RING_EVENTS - 1)];
+    event.name     = name;
+    event.start    = start;
+    event.duration = end - start;
+    ring->head.store(head + 1, std::memory_order_release);
+
+}
+
+//--------------------------------------------------------------------------------------
+// Tramos que no coinciden con un ámbito: begin/end en el mismo hilo, anidados como una pila
+//--------------------------------------------------------------------------------------
+void Trace::begin(const char *name) {
+
+    TraceRing *ring = threadRing();
+    if(!ring) return;
+    if(ring->depth < TRACE_MAX_DEPTH) {
+        ring->openNames [ring->depth] = name;
+        ring->openStarts[ring->depth] = now();
+    }
+    ring->depth++;
+
+}
+
+void Trace::end() {
+
+    TraceRing *ring = threadRing();
+    if(!ring || ring->depth == 0) return;
+    ring->depth--;
+    if(ring->depth < TRACE_MAX_DEPTH) record(ring->openNames[ring->depth], ring->openStarts[ring->depth], now());
+
+}
+
+//------------------------------------------------------------------------------------------
+// Copia permanente de un nombre construido en tiempo de ejecución (p. ej. el de un fichero).
+// Usa un mutex: solo para tramos poco frecuentes
+//------------------------------------------------------------------------------------------
+const char* Trace::intern(const std::string &name) {
+
+    std::lock_guard<std::mutex> lock(internMutex);
+    return internNames.insert(name).first->c_str();
+
+}
+
+static void writeJsonString(FILE *out, const char *text) {
+
+    fputc('"', out);
+    for(const char *c = text; *c; c++) {
+        if(*c == '"' || *c == '\\') fputc('\\', out);
+        if((unsigned char)*c >= 0x20) fputc(*c, out);
+    }
+    fputc('"', out);
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Vuelca los tramos que empezaron en los últimos seconds segundos. Los hilos siguen escribiendo
+// mientras tanto: se copia su anillo y después se descartan los eventos que se hayan podido
+// sobrescribir durante la copia (los que no quedan a menos de una vuelta del head final, más el
+// hueco que se puede estar escribiendo en ese momento)
+//------------------------------------------------------------------------------------------------
+bool Trace::dump(const char *file, double seconds) {
+
+    FILE *out = fopen(file, "w");
+    if(!out) {
+        std::cerr << "No se puede crear la traza " << file << std::endl;
+        return false;
+    }
+
+    const long long from = now() - (long long)(seconds * 1.0e9);
+    const int numRings = std::min(traceNumRings.load(std::memory_order_acquire), TRACE_MAX_THREADS);
+    std::vector<TraceEvent> events;
+    size_t total = 0;
+
+    fprintf(out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Acuario\"}}");
+    for(int r = 0; r < numRings; r++) {
+        TraceRing *ring = traceRings[r].load(std::memory_order_acquire);
+        if(!ring) continue;
+
+        const unsigned long long head  = ring->head.load(std::memory_order_acquire);
+        const unsigned long long first = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+        events.clear();
+        for(unsigned long long i = first; i < head; i++) events.push_back(ring->events[i & (TRACE_RING_EVENTS - 1)]);
+        const unsigned long long after = ring->head.load(std::memory_order_acquire);
+        // El hilo puede estar escribiendo ya el evento after, que ocupa el hueco de after - TRACE_RING_EVENTS
+        const unsigned long long valid = after >= TRACE_RING_EVENTS ? after - TRACE_RING_EVENTS + 1 : 0;
+        const size_t skip = valid > first ? (size_t)std::min(valid - first, head - first) : 0;
+
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", ring->id + 1);
+        if(ring->name) {
+            writeJsonString(out, ring->name);
+        } else {
+            fprintf(out, "\"hilo %d\"", ring->id);
+        }
+        fprintf(out, "}}");
+
+        for(size_t i = skip; i < events.size(); i++) {
+            const TraceEvent &event = events[i];
+            if(event.start < from) continue;
+            fprintf(out, ",\n{\"name\":");
+            writeJsonString(out, event.name);
+            fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ring->id + 1, event.start / 1000.0, event.duration / 1000.0);
+            total++;
+        }
+    }
+    fprintf(out, "\n]}\n");
+    bool ok = ferror(out) == 0;
+    fclose(out);
+
+    std::cout << "Traza: " << total << " tramos de " << numRings << " hilos en " << file << std::endl;
+    return ok;
+
+}
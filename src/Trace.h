@@ -0,0 +1,68 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Eventos que guarda cada hilo (los más antiguos se sobrescriben), hilos con traza y anidamiento
+// máximo de TRACE_BEGIN/TRACE_END
+const unsigned long long TRACE_RING_EVENTS = 1 << 16;
+const int                TRACE_MAX_THREADS = 64;
+const int                TRACE_MAX_DEPTH   = 32;
+
+// Un tramo terminado. name debe seguir siendo válido hasta volcar la traza (literal o intern())
+struct TraceEvent {
+    const char *name;
+    long long   start;      // ns desde el arranque
+    long long   duration;   // ns
+};
+
+// Trazas de CPU: cada hilo escribe sus tramos en su propio anillo sin bloqueos (un solo escritor)
+// y dump() vuelca los últimos segundos de todos los hilos en formato trace_event de Chrome, que se
+// abre con Perfetto o chrome://tracing. Las macros solo existen si se compila con AQUARIO_TRACE;
+// sin él no generan código
+class Trace {
+
+    public:
+
+        static bool        enabled();
+        static long long   now();
+        static void        setThreadName(const char *name);
+        static void        record(const char *name, long long start, long long end);
+        static void        begin (const char *name);
+        static void        end   ();
+        static const char* intern(const std::string &name);
+        static bool        dump  (const char *file, double seconds);
+
+};
+
+// Tramo que dura lo que el ámbito en que se declara
+class TraceScope {
+
+    public:
+
+        explicit TraceScope(const char *name) : name(name), start(Trace::now()) {}
+        ~TraceScope() { Trace::record(name, start, Trace::now()); }
+
+    private:
+
+        const char *name;
+        long long   start;
+
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b)  TRACE_CONCAT_(a, b)
+
+#ifdef AQUARIO_TRACE
+#define TRACE_SCOPE(name)   TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_BEGIN(name)   Trace::begin(name)
+#define TRACE_END()         Trace::end()
+#define TRACE_THREAD(name)  Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(name)   ((void)0)
+#define TRACE_BEGIN(name)   ((void)0)
+#define TRACE_END()         ((void)0)
+#define TRACE_THREAD(name)  ((void)0)
+#endif
+
+#endif /* TRACE_H */
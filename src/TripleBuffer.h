@@ -0,0 +1,47 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Triple buffer sin bloqueos para un productor y un consumidor: el productor escribe siempre en
+// su copia y la publica intercambiándola con la intermedia; el consumidor toma la intermedia solo
+// si hay una nueva. Ninguno espera al otro y el consumidor siempre ve una copia completa
+template <typename T>
+class TripleBuffer {
+
+    public:
+
+        TripleBuffer() : front(0), back(2), middle(1) {}
+
+     // Productor: copia en la que escribir y publicación de esa copia
+        T&   writeBuffer() { return slots[back].value; }
+        void publish() {
+            back = middle.exchange((unsigned char)(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+     // Consumidor: toma la última copia publicada (si la hay) y devuelve la que tiene en uso
+        bool update() {
+            if(!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+            return true;
+        }
+        const T& readBuffer() const { return slots[front].value; }
+
+    private:
+
+        static const unsigned char INDEX_MASK = 0x3;
+        static const unsigned char FRESH      = 0x4;   // La intermedia aún no la ha leído el consumidor
+
+     // Cada copia en su propia línea de caché para que los dos hilos no se pisen
+        struct alignas(64) Slot {
+            T value;
+        };
+
+        Slot                       slots[3];
+        unsigned char              front;      // Solo lo toca el consumidor
+        unsigned char              back;       // Solo lo toca el productor
+        std::atomic<unsigned char> middle;     // Índice de la intermedia y bit FRESH
+
+};
+
+#endif /* TRIPLEBUFFER_H */
@@ -0,0 +1,67 @@
+#include "Upscaler.h"
+#include "RenderStats.h"
+
+#include <cstring>
+
+Upscaler::Upscaler() : vao(0), filter(UPSCALE_BILINEAR), sharpness(0.0f) {
+
+}
+
+void Upscaler::init(UpscaleFilter filter, float sharpness) {
+
+    this->filter    = filter;
+    this->sharpness = filter == UPSCALE_SHARPEN ? sharpness : 0.0f;
+
+    shader.initShaders(
+        "resources/shaders/vupscale.glsl",
+        "resources/shaders/fupscale.glsl"
+    );
+    glGenVertexArrays(1, &vao);
+
+}
+
+//--------------------------------------------------------------------------------------------
+// Dibuja source en el framebuffer activo ocupando width x height. Sin profundidad ni mezcla;
+// al terminar deja ambas activadas como las espera el render de la escena
+//--------------------------------------------------------------------------------------------
+void Upscaler::draw(const RenderTarget &source, int width, int height) {
+
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    shader.useShaders();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source.getTexture());
+    shader.setInt  ("uSource", 0);
+    shader.setVec2 ("uTexel", glm::vec2(1.0f / source.getWidth(), 1.0f / source.getHeight()));
+    shader.setFloat("uSharpness", sharpness);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    RenderStats::countTexture();
+    RenderStats::countVao();
+    RenderStats::countDraw(3);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+}
+
+//-----------------------------------
+// Destructor de la clase
+//-----------------------------------
+Upscaler::~Upscaler() {
+
+    if(vao) glDeleteVertexArrays(1, &vao);
+
+}
+
+bool parseUpscaleFilter(const char *text, UpscaleFilter &filter) {
+
+    if     (std::strcmp(text, "bilinear") == 0) filter = UPSCALE_BILINEAR;
+    else if(std::strcmp(text, "sharpen" ) == 0) filter = UPSCALE_SHARPEN;
+    else return false;
+    return true;
+
+}
@@ -0,0 +1,40 @@
+#ifndef UPSCALER_H
+#define UPSCALER_H
+
+#include <GL/glew.h>
+
+#include "Shaders.h"
+#include "RenderTarget.h"
+
+// Filtro al pasar la escena de la resolución interna a la de la ventana
+enum UpscaleFilter {
+    UPSCALE_BILINEAR,
+    UPSCALE_SHARPEN    // Bilineal con máscara de enfoque, para compensar la pérdida de detalle
+};
+
+// Escala la imagen de un RenderTarget al framebuffer activo con un triángulo a pantalla completa
+class Upscaler {
+
+    public:
+
+        Upscaler();
+
+        void init(UpscaleFilter filter, float sharpness = 0.5f);
+        void draw(const RenderTarget &source, int width, int height);
+
+        UpscaleFilter getFilter() const { return filter; }
+
+        virtual ~Upscaler();
+
+    private:
+
+        Shaders       shader;
+        GLuint        vao;        // Vacío: el perfil core no permite dibujar sin VAO
+        UpscaleFilter filter;
+        float         sharpness;
+
+};
+
+bool parseUpscaleFilter(const char *text, UpscaleFilter &filter);
+
+#endif /* UPSCALER_H */
@@ -0,0 +1,190 @@
+#include "View.h"
+#include "InputRecording.h"
+
+#include <iostream>
+
+// Velocidades de los controles con tecla mantenida (por segundo)
+const float CAM_MOVE_SPEED   = 6.0f;
+const float LIGHT_MOVE_SPEED = 9.0f;
+
+View::View() {
+
+    reset();
+
+}
+
+//------------------------------------------------------------
+// Cámara y luz del arranque, sin teclas pulsadas ni grabación
+//------------------------------------------------------------
+void View::reset() {
+
+    camara.alpha  = 0.0f;
+    camara.beta   = 0.0f;
+    camara.dist   = 14.0f;
+    camara.offset = AQUARIUM_CENTER;
+    luz.posicion  = glm::vec3(0.0f, -1.7f, -12.0f);
+    luz.encendida = false;
+    for (int i = 0; i <= GLFW_KEY_LAST; i++) teclas[i] = false;
+    rotando = false;
+    ultimoX = 0.0;
+    ultimoY = 0.0;
+    replayPosition = 0;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Un evento: las acciones de una sola pulsación se hacen al pulsar (los eventos ya son flancos)
+//------------------------------------------------------------------------------------------
+void View::handleInput(const InputEvent &event) {
+
+    if (!isViewInput(event)) return;
+    switch (event.type) {
+        case INPUT_KEY:
+            if (event.action == GLFW_REPEAT) break;
+            teclas[event.code] = event.action == GLFW_PRESS;
+            if (event.action != GLFW_PRESS) break;
+            if (event.code == GLFW_KEY_T) {
+                luz.encendida = !luz.encendida;
+                std::cout << "Luz móvil: " << (luz.encendida ? "ENCENDIDA" : "APAGADA") << std::endl;
+            } else if (event.code == GLFW_KEY_SPACE) {
+                resetearVista();
+            }
+            break;
+
+        case INPUT_MOUSE_BUTTON:
+            // Rotar cámara
+            rotando = event.action == GLFW_PRESS;
+            ultimoX = event.x;
+            ultimoY = event.y;
+            break;
+
+        case INPUT_CURSOR:
+            if (rotando) {
+                camara.alpha += static_cast<float>(event.x - ultimoX) * 0.3f;
+                camara.beta  += static_cast<float>(event.y - ultimoY) * 0.3f;
+                camara.beta   = glm::clamp(camara.beta, -89.0f, 89.0f);
+            }
+            ultimoX = event.x;
+            ultimoY = event.y;
+            break;
+
+        case INPUT_SCROLL:
+            // Acercar/Alejar
+            camara.dist -= static_cast<float>(event.y) * 0.5f;
+            camara.dist  = glm::clamp(camara.dist, 0.5f, 60.0f);
+            break;
+    }
+
+}
+
+//--------------------------------------------------------------------------
+// Orden de cámara o luz (escenarios y grabaciones); las demás no son suyas
+//--------------------------------------------------------------------------
+void View::post(SimCommandType type, float value) {
+
+    switch (type) {
+        case SIM_CAMARA_ALPHA:
+            camara.alpha = value;
+            break;
+        case SIM_CAMARA_BETA:
+            camara.beta = glm::clamp(value, -89.0f, 89.0f);
+            break;
+        case SIM_CAMARA_DIST:
+            camara.dist = glm::clamp(value, 0.5f, 60.0f);
+            break;
+        case SIM_LUZ:
+            luz.encendida = value != 0.0f;
+            break;
+        default:
+            break;
+    }
+
+}
+
+//------------------------------------------------------------------------------------------
+// Controles que dependen de tener la tecla pulsada, durante dt segundos
+//------------------------------------------------------------------------------------------
+void View::update(float dt) {
+
+    // WASD/QE y flechas: desplazamiento de la cámara
+    const float camMove = CAM_MOVE_SPEED * dt;
+    if (teclas[GLFW_KEY_W]) camara.offset.z -= camMove;
+    if (teclas[GLFW_KEY_S]) camara.offset.z += camMove;
+    if (teclas[GLFW_KEY_A]) camara.offset.x -= camMove;
+    if (teclas[GLFW_KEY_D]) camara.offset.x += camMove;
+    if (teclas[GLFW_KEY_Q]) camara.offset.y -= camMove;
+    if (teclas[GLFW_KEY_E]) camara.offset.y += camMove;
+    if (teclas[GLFW_KEY_LEFT])  camara.offset.x -= camMove;
+    if (teclas[GLFW_KEY_RIGHT]) camara.offset.x += camMove;
+    if (teclas[GLFW_KEY_UP])    camara.offset.y += camMove;
+    if (teclas[GLFW_KEY_DOWN])  camara.offset.y -= camMove;
+
+    // IJKLUO: luz móvil, limitada a la pecera
+    const float lightMove = LIGHT_MOVE_SPEED * dt;
+    if (teclas[GLFW_KEY_J]) luz.posicion.x -= lightMove;
+    if (teclas[GLFW_KEY_L]) luz.posicion.x += lightMove;
+    if (teclas[GLFW_KEY_I]) luz.posicion.y += lightMove;
+    if (teclas[GLFW_KEY_K]) luz.posicion.y -= lightMove;
+    if (teclas[GLFW_KEY_U]) luz.posicion.z += lightMove;
+    if (teclas[GLFW_KEY_O]) luz.posicion.z -= lightMove;
+    luz.posicion.x = glm::clamp(luz.posicion.x, -4.5f, 4.5f);
+    luz.posicion.y = glm::clamp(luz.posicion.y, -4.8f, 1.0f);
+    luz.posicion.z = glm::clamp(luz.posicion.z, -14.0f, -10.0f);
+
+}
+
+//------------------------------------------------------------------------------------------------
+// Toma la última vista grabada con una copia del mundo de como mucho steps pasos: la misma cámara y
+// la misma luz con las que se dibujó ese paso al grabar. Sustituye a la entrada y a update()
+//------------------------------------------------------------------------------------------------
+void View::replay(const InputPlayer &player, unsigned long long steps) {
+
+    ViewState state;
+    while (player.nextView(steps, state, replayPosition)) {
+        camara = state.camara;
+        luz    = state.luz;
+    }
+
+}
+
+ViewState View::getState() const {
+
+    ViewState state;
+    state.camara = camara;
+    state.luz    = luz;
+    return state;
+
+}
+
+//------------------------------------------------------------------------------------------
+// Ratón, rueda y las teclas de cámara (WASD/QE, flechas), luz (IJKLUO, T) y vista inicial
+// (espacio, que en la simulación además quita la comida)
+//------------------------------------------------------------------------------------------
+bool View::isViewInput(const InputEvent &event) {
+
+    if (event.type == INPUT_MOUSE_BUTTON) return event.code == GLFW_MOUSE_BUTTON_LEFT || event.code == GLFW_MOUSE_BUTTON_RIGHT;
+    if (event.type != INPUT_KEY) return true;
+    switch (event.code) {
+        case GLFW_KEY_W: case GLFW_KEY_A: case GLFW_KEY_S: case GLFW_KEY_D: case GLFW_KEY_Q: case GLFW_KEY_E:
+        case GLFW_KEY_LEFT: case GLFW_KEY_RIGHT: case GLFW_KEY_UP: case GLFW_KEY_DOWN:
+        case GLFW_KEY_I: case GLFW_KEY_J: case GLFW_KEY_K: case GLFW_KEY_L: case GLFW_KEY_U: case GLFW_KEY_O:
+        case GLFW_KEY_T: case GLFW_KEY_SPACE:
+            return true;
+        default:
+            return false;
+    }
+
+}
+
+//------------------------------------------------------------------
+// Vista inicial: cámara y luz en su sitio
+//------------------------------------------------------------------
+void View::resetearVista() {
+
+    camara.alpha  = 0.0f;
+    camara.beta   = 0.0f;
+    camara.dist   = 18.0f;
+    camara.offset = AQUARIUM_CENTER;
+    luz.posicion  = glm::vec3(0.0f, 2.0f, -10.0f);
+
+}
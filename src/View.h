@@ -0,0 +1,67 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <GLFW/glfw3.h>
+
+#include "Simulation.h"
+
+// Cámara orbital alrededor de offset (ángulos en grados)
+struct Camara {
+    float alpha;
+    float beta;
+    float dist;
+    glm::vec3 offset;
+};
+
+// Luz móvil que se controla con el teclado
+struct LuzMovil {
+    glm::vec3 posicion;
+    bool encendida;
+};
+
+// Lo que la vista aporta a un frame; es lo que se graba de ella
+struct ViewState {
+    Camara   camara;
+    LuzMovil luz;
+};
+
+// Cámara y luz móvil: estado del hilo de la ventana, no de la simulación. La entrada que las mueve
+// se aplica al leerla, justo antes de construir el frame, sin esperar a un paso de simulación, y
+// las teclas mantenidas avanzan con el tiempo real del frame. Por eso una grabación no guarda su
+// entrada sino la vista de cada frame junto al paso del mundo que se dibujó con ella, y al repetirla
+// la vista la toma del InputPlayer según ese paso, sea cual sea el ritmo de frames de la repetición
+class View {
+
+    public:
+
+        View();
+
+        void reset      ();
+        void handleInput(const InputEvent &event);
+        void post       (SimCommandType type, float value);
+        void update     (float dt);                                   // Teclas mantenidas durante dt
+        void replay     (const InputPlayer &player, unsigned long long steps);   // La grabada hasta el paso steps
+
+        const Camara&   getCamara() const { return camara; }
+        const LuzMovil& getLuz()    const { return luz; }
+        ViewState       getState () const;
+
+        static bool isViewInput(const InputEvent &event);
+
+    private:
+
+        Camara   camara;
+        LuzMovil luz;
+        bool     teclas[GLFW_KEY_LAST + 1];   // Teclas de cámara y luz pulsadas ahora mismo
+        bool     rotando;                     // Botón del ratón pulsado
+        double   ultimoX;
+        double   ultimoY;
+        size_t   replayPosition;              // Cursor propio en las vistas grabadas
+
+        void resetearVista();
+
+};
+
+#endif /* VIEW_H */
@@ -0,0 +1,76 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <glm/glm.hpp>
+
+// Estructura pez 
+struct Pez {
+    glm::vec3 posicion;
+    glm::vec3 velocidad;
+    glm::vec3 velocidadOriginal;
+    glm::vec4 color;
+    float fase;
+    float escala;
+    float anguloDireccion;
+    float anguloObjetivo;
+    float tiempoOndulacion;
+    float amplitudOndulacion;
+    float frecuenciaOndulacion;
+    float tiempoCambio;
+    float alturaObjetivo;
+    int modeloTipo;
+    bool persigiendoComida;
+};
+
+const int NUM_PECES = 9;
+
+// Estructura comida
+struct Comida {
+    glm::vec3 posicion;
+    bool activa;
+    glm::vec4 color;
+    float escala; 
+};
+
+const int MAX_COMIDA = 300;
+
+// Estructura burbuja
+struct Burbuja {
+    glm::vec3 posicion;
+    bool activa;
+    float escala;
+    float velocidadSubida;
+    float oscilacionX;
+    float oscilacionZ;
+    float fase;  
+};
+
+const int MAX_BURBUJAS = 120;
+
+// Estructura ventilador
+struct Ventilador {
+    glm::vec3 posicion;
+    float anguloAspas;
+    float velocidadRotacion;
+    float anguloMovimiento; 
+    float radio;
+    float anguloRotacionPalo;  // Rotación del palo sobre sí mismo
+};
+
+// Centro del acuario 
+const glm::vec3 AQUARIUM_CENTER(0.0f, -1.7f, -12.0f);
+
+// Estado completo del mundo simulado: lo modifica la simulación y el render dibuja copias inmutables
+// de él (la cámara y la luz móvil son del render: View.h)
+struct WorldSnapshot {
+    Pez                peces[NUM_PECES];
+    Comida             comidas[MAX_COMIDA];
+    Burbuja            burbujas[MAX_BURBUJAS];
+    Ventilador         ventilador;
+    int                peces_visibles;
+    bool               peces_pausados;
+    float              tiempo;          // Tiempo simulado en segundos
+    unsigned long long paso;            // Número de pasos de simulación
+};
+
+#endif /* WORLD_H */
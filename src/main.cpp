@@ -1,7 +1,12 @@
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
 #include <cmath>
 #include <ctime>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <vector>
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -15,26 +20,38 @@
 
 #include "Shaders.h"
 #include "Model.h"
+#include "AssetLoader.h"
+#include "TextureArray.h"
+#include "Frustum.h"
+#include "Lod.h"
+#include "Options.h"
+#include "Simulation.h"
+#include "Instancing.h"
+#include "JobSystem.h"
+#include "RingBuffer.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
+#include "HeadlessContext.h"
+#include "RenderTarget.h"
+#include "BatchRender.h"
+#include "GoldenImage.h"
+#include "DynamicResolution.h"
+#include "Upscaler.h"
+#include "GpuProfiler.h"
+#include "Trace.h"
+#include "Histogram.h"
+#include "RenderStats.h"
+#include "TextRenderer.h"
+#include "Scenario.h"
+#include "InputRecording.h"
+#include "View.h"
+#include "AllocStats.h"
+#include "MemoryRegistry.h"
 
 // Tamaño de la ventana 
 const unsigned int SCR_WIDTH = 1280;
 const unsigned int SCR_HEIGHT = 720;
-
-// Centro del acuario 
-const glm::vec3 AQUARIUM_CENTER(0.0f, -1.7f, -12.0f);
-
-// Parámetros de la cámara 
-float camAlpha = 0.0f;
-float camBeta  = 0.0f;
-float camDist  = 14.0f;
-glm::vec3 camOffset = AQUARIUM_CENTER;
-
-// Control del ratón 
-bool rotating = false;
-bool panning = false;
-bool movingLight = false;  
-double lastX = 0.0;
-double lastY = 0.0;
+const char* const  WINDOW_TITLE = "Pecera 3D - Proyecto Final";
 
 float t_global = 0.0f;
 
@@ -46,14 +63,8 @@ glm::vec3 ambientLight(0.4f, 0.4f, 0.45f);
 glm::vec3 dirLightDir(0.2f, -1.0f, -0.3f);
 glm::vec3 dirLightColor(0.5f, 0.5f, 0.6f);  
 
-// Luz móvil 
-glm::vec3 movingLightPos(0.0f, -1.7f, -12.0f);  
+// Luz móvil (su posición y si está encendida son parte del mundo simulado)
 glm::vec3 movingLightColor(3.0f, 2.8f, 2.5f);  
-bool movingLightEnabled = false;  
-
-// Estados
-bool peces_pausados = false;
-int peces_visibles = 5;
 
 // Shaders y modelos globales
 Shaders shader;
@@ -64,83 +75,88 @@ Model   tableModel;
 Model   coralModel;
 Model   coneModel;
 
-// Texturas (GLuint)
-GLuint sandTexture;
-GLuint coralTexture;
-GLuint ventiladorTexture;
+// Niveles de detalle del pez: fishModel es el nivel 0 y fishLods[i] el nivel i + 1. La cola se
+// anima en el vertex shader a partir de z = FISH_TAIL_START_Z, que los LOD no pueden cruzar
+const int   FISH_LOD_LEVELS   = 3;
+const float FISH_TAIL_START_Z = -4.45f;
+Model fishLods[FISH_LOD_LEVELS];
+
+// Tamaño proyectado (radio en NDC) por debajo del cual se pasa a cada nivel siguiente, y margen
+const float FISH_LOD_THRESHOLDS[FISH_LOD_LEVELS] = { 0.25f, 0.12f, 0.06f };
+const float FISH_LOD_HYSTERESIS = 0.15f;
+
+// Texturas: todas en un único array, cada material usa su capa
+TextureArray sceneTextures;
+int sandLayer = 0;
+int coralLayer = 0;
+int ventiladorLayer = 0;
+int roomBackLayer = 0;
+int backgroundLayer = 0;
 GLuint backgroundVAO = 0;
 GLuint backgroundVBO = 0;
-GLuint backgroundTexture = 0;
-GLuint roomBackTexture = 0;
-
-// Estructura pez 
-struct Pez {
-    glm::vec3 posicion;
-    glm::vec3 velocidad;
-    glm::vec3 velocidadOriginal;
-    glm::vec4 color;
-    float fase;
-    float escala;
-    float anguloDireccion;
-    float anguloObjetivo;
-    float tiempoOndulacion;
-    float amplitudOndulacion;
-    float frecuenciaOndulacion;
-    float tiempoCambio;
-    float alturaObjetivo;
-    int modeloTipo;
-    bool persigiendoComida;
-};
 
-const int NUM_PECES = 9;
-Pez peces[NUM_PECES];
+// Recorte por frustum: lotes de esferas envolventes por categoría y contadores del frame
+CullStats cullStats = {0, 0};
+CullBatch fishBatch;
+CullBatch foodBatch;
+CullBatch bubbleBatch;
+CullBatch coralBatch;
+CullBatch fanBatch;
 
-// Estructura comida
-struct Comida {
-    glm::vec3 posicion;
-    bool activa;
-    glm::vec4 color;
-    float escala; 
-};
+// Margen extra del radio del pez para que la cola animada no se salga de la esfera
+const float FISH_BOUNDS_MARGIN = 1.25f;
 
-const int MAX_COMIDA = 300;
-Comida comidas[MAX_COMIDA];
+// Nivel de detalle actual de cada pez (estado del render)
+int pecesLod[NUM_PECES];
 
-// Estructura burbuja
-struct Burbuja {
-    glm::vec3 posicion;
-    bool activa;
-    float escala;
-    float velocidadSubida;
-    float oscilacionX;
-    float oscilacionZ;
-    float fase;  
-};
+// Sistema de tareas compartido por la carga de recursos, la simulación y el render
+JobSystem jobs;
 
-const int MAX_BURBUJAS = 120;
-Burbuja burbujas[MAX_BURBUJAS];
-float tiempoUltimaBurbuja = 0.0f;
-
-// Estructura ventilador
-struct Ventilador {
-    glm::vec3 posicion;
-    float anguloAspas;
-    float velocidadRotacion;
-    float anguloMovimiento; 
-    float radio;
-    float anguloRotacionPalo;  // Rotación del palo sobre sí mismo
-};
+// Simulación del acuario (en su propio hilo, con sus actualizaciones repartidas en tareas)
+Simulation simulation(jobs);
+
+// Escenario con guion (--scenario): si está cargado, la simulación avanza a paso fijo con sus órdenes
+Scenario scenario;
+
+// Cámara y luz móvil: son del hilo de la ventana, que aplica su entrada al leerla
+View view;
+
+// Grabación de la entrada (--record) y repetición de una grabación (--replay)
+InputRecorder inputRecorder;
+InputPlayer   inputPlayer;
 
-Ventilador ventilador;
+// Semilla de la sesión: la de la grabación al repetirla; si no, --seed o la dada por defecto
+unsigned int sessionSeed(const Options& options, unsigned int defaultSeed)
+{
+    if (inputPlayer.isLoaded()) return inputPlayer.seed();
+    return options.seed ? options.seed : defaultSeed;
+}
 
-// Declaraciones de funciones
-void actualizarPeces(float dt);
-void actualizarComida(float dt);
-void echarComida();
-void actualizarBurbujas(float dt);
-void generarBurbuja();
-void actualizarVentilador(float dt);
-void drawVentilador(glm::mat4 P, glm::mat4 V);
+// Empieza a grabar lo que recibe la simulación desde su estado inicial
+void startRecording(const Options& options, unsigned int seed)
+{
+    if (!options.recordFile || !inputRecorder.start(options.recordFile, seed)) return;
+    simulation.setRecorder(&inputRecorder);
+}
+
+// Avance de la simulación sin su hilo, con las órdenes del escenario si lo hay
+void advanceSimulation(double dt)
+{
+    if (scenario.isLoaded()) scenario.advance(simulation, view, dt);
+    else simulation.advance(dt);
+}
+
+// Vista del frame que se va a dibujar: al repetir una grabación, la grabada para el paso de esa copia
+// del mundo; si no, las teclas mantenidas durante dt, y al grabar se guarda con ese paso
+void updateView(const WorldSnapshot& world, double dt)
+{
+    if (inputPlayer.isLoaded()) {
+        view.replay(inputPlayer, world.paso);
+        return;
+    }
+    view.update(static_cast<float>(dt));
+    if (inputRecorder.isActive()) inputRecorder.recordView(world.paso, view.getState());
+}
 
 // Creación del plano de fondo 
 void createBackgroundPlane() {
@@ -159,6 +175,7 @@ void createBackgroundPlane() {
     glBindVertexArray(backgroundVAO);
     glBindBuffer(GL_ARRAY_BUFFER, backgroundVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    MemoryRegistry::add(MEMORIA_BUFFER, backgroundVBO, MEMORIA_MALLAS, sizeof(vertices), "pos+normal+uv", "main", "plano de fondo");
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -170,34 +187,23 @@ void createBackgroundPlane() {
     glBindVertexArray(0);
 }
  
-// Cargar texturas 
-GLuint loadTexture(const char* path) {
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrChannels == 1) format = GL_RED;
-        else if (nrChannels == 3) format = GL_RGB;
-        else if (nrChannels == 4) format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    } else {
-        std::cerr << "Error al cargar textura: " << path << std::endl;
-        stbi_image_free(data);
-    }
-    return textureID;
+// Modelos y texturas de la escena
+void registerAssets(AssetLoader& loader)
+{
+    loader.addModel(&cubeModel, "resources/models/cube.obj");
+    loader.addModel(&fishModel, "resources/models/pez.obj");
+    loader.addModelLods(fishLods, FISH_LOD_LEVELS, "resources/models/pez.obj", FISH_TAIL_START_Z);
+    loader.addModel(&sphereModel, "resources/models/sphere.obj");
+    loader.addModel(&tableModel, "resources/models/Table.obj");
+    loader.addModel(&coralModel, "resources/models/coral.obj");
+    loader.addModel(&coneModel, "resources/models/cone.obj");
+
+    sandLayer = sceneTextures.addLayer("resources/textures/arena.jpg");
+    coralLayer = sceneTextures.addLayer("resources/textures/coral.jpg");
+    ventiladorLayer = sceneTextures.addLayer("resources/textures/ventilador1.jpg");
+    roomBackLayer = sceneTextures.addLayer("resources/textures/room_back.jpg");
+    backgroundLayer = sceneTextures.addLayer("resources/textures/acuario.jpeg");
+    loader.addTextureArray(&sceneTextures);
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int w, int h)
@@ -206,243 +212,124 @@ void framebuffer_size_callback(GLFWwindow* window, int w, int h)
     glViewport(0, 0, w, h);
 }
 
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+//------------------------------------------------------------------------------------------
+// Entrada: los callbacks convierten lo que llega de GLFW en eventos. La vista aplica ya los de
+// cámara y luz y la simulación procesa (y graba) todos al principio de su siguiente paso (los
+// controles están en la documentación)
+//------------------------------------------------------------------------------------------
+// Segundos de traza que se vuelcan (--trace-seconds) y volcados hechos con F12
+double traceSeconds = 10.0;
+int    traceDumps = 0;
+
+// Vuelca la traza de CPU de los últimos traceSeconds segundos (sin fichero: traza_<n>.json)
+void dumpTrace(const char* file)
 {
-    (void)mods;
-    // Rotar cámara
-    if (button == GLFW_MOUSE_BUTTON_LEFT || button == GLFW_MOUSE_BUTTON_RIGHT) {
-        if (action == GLFW_PRESS) {
-            rotating = true;
-            glfwGetCursorPos(window, &lastX, &lastY);
-        } else if (action == GLFW_RELEASE) {
-            rotating = false;
-        }
+    AllocScope scope(ALLOC_OTROS);
+    if (!Trace::enabled()) {
+        std::cerr << "Trazas no disponibles: compilar con -DAQUARIO_TRACE=ON" << std::endl;
+        return;
+    }
+    char name[64];
+    if (!file) {
+        snprintf(name, sizeof(name), "traza_%d.json", ++traceDumps);
+        file = name;
     }
+    Trace::dump(file, traceSeconds);
 }
 
-void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
-{
-    (void)window;
-    if (!rotating && !panning) return;
+// Contadores de render en pantalla (F3 o --hud)
+TextRenderer hudText;
+bool         hudVisible = false;
 
-    double dx = xpos - lastX;
-    double dy = ypos - lastY;
+// Tiempos de cada frame (ms): intervalo entre frames, envío de órdenes de render, swap y GPU. La
+// simulación mide sus pasos en su propio hilo (Simulation::stepTimes)
+Histogram frameHistogram;
+Histogram renderHistogram;
+Histogram swapHistogram;
+Histogram gpuHistogram;
 
-    if (rotating) {
-        camAlpha += static_cast<float>(dx) * 0.3f;
-        camBeta  += static_cast<float>(dy) * 0.3f;
-
-        if (camBeta > 89.0f)  camBeta = 89.0f;
-        if (camBeta < -89.0f) camBeta = -89.0f;
-    } else if (panning) {
-        camOffset.x -= static_cast<float>(dx) * 0.01f;
-        camOffset.y += static_cast<float>(dy) * 0.01f;
-    }
+// Percentiles de todos los tiempos (y en CSV si se da un fichero)
+void printFrameTimes(const char* csvFile)
+{
+    AllocScope scope(ALLOC_OTROS);
+    const NamedHistogram histograms[] = {
+        { "frame",      &frameHistogram },
+        { "simulacion", &simulation.stepTimes() },
+        { "render",     &renderHistogram },
+        { "swap",       &swapHistogram },
+        { "gpu",        &gpuHistogram }
+    };
+    const int count = sizeof(histograms) / sizeof(histograms[0]);
+    printHistograms("Percentiles de tiempo (ms)", histograms, count);
+    if (csvFile) writeHistogramsCsv(csvFile, histograms, count);
+}
 
-    lastX = xpos;
-    lastY = ypos;
+// Memoria de GPU y de CPU registrada, por categorías y por recurso (al salir y con F10)
+void printMemory()
+{
+    AllocScope scope(ALLOC_OTROS);
+    MemoryRegistry::printReport();
 }
 
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+// Con escenario o repitiendo una grabación la simulación solo recibe sus órdenes y eventos: la
+// entrada en vivo haría cada pasada distinta
+void postInput(InputEventType type, int code, int action, double x, double y)
 {
-    (void)window;
-    (void)xoffset;
-    // Acercar/Alejar 
-    camDist -= static_cast<float>(yoffset) * 0.5f;
-    if (camDist < 0.5f) camDist = 0.5f;
-    if (camDist > 60.0f) camDist = 60.0f;
+    if (scenario.isLoaded() || inputPlayer.isLoaded()) return;
+    InputEvent event = { type, code, action, x, y, glfwGetTime() };
+    view.handleInput(event);
+    simulation.postInput(event);
 }
 
-// Entrada por teclado (Los diferentes controles se encuentran en la documentación del proyecto)
-void processInput(GLFWwindow* window)
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+    (void)scancode;
+    (void)mods;
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+        dumpTrace(NULL);
+    if (key == GLFW_KEY_F11 && action == GLFW_PRESS)
+        printFrameTimes(NULL);
+    if (key == GLFW_KEY_F10 && action == GLFW_PRESS)
+        printMemory();
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS)
+        hudVisible = !hudVisible;
+    postInput(INPUT_KEY, key, action, 0.0, 0.0);
+}
 
-    // Pausar/reanudar peces
-    static bool p_pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS && !p_pressed) {
-        peces_pausados = !peces_pausados;
-        p_pressed = true;
-    }
-    if (glfwGetKey(window, GLFW_KEY_P) == GLFW_RELEASE) {
-        p_pressed = false;
-    }
-
-    // WASD: Desplazamiento lateral y profundidad de la cámara
-    const float camMoveSpeed = 0.1f;
-    
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) {
-        // Adelante 
-        camOffset.z -= camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) {
-        // Atrás 
-        camOffset.z += camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) {
-        // Izquierda 
-        camOffset.x -= camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) {
-        // Derecha
-        camOffset.x += camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
-        // Bajar
-        camOffset.y -= camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS) {
-        // Subir 
-        camOffset.y += camMoveSpeed;
-    }
-    
-    // Flechas del teclado: Mover cámara
-    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-        // Flecha Izquierda: Mover cámara hacia la izquierda
-        camOffset.x -= camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-        // Flecha Derecha: Mover cámara hacia la derecha
-        camOffset.x += camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-        // Flecha Arriba: Mover cámara hacia arriba
-        camOffset.y += camMoveSpeed;
-    }
-    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-        // Flecha Abajo: Mover cámara hacia abajo
-        camOffset.y -= camMoveSpeed;
-    }
-    
-    // IJKLUO: Controles luz móvil
-    const float lightMoveSpeed = 0.15f;
-    if (glfwGetKey(window, GLFW_KEY_J) == GLFW_PRESS) {
-        movingLightPos.x -= lightMoveSpeed;  // J: Izquierda
-    }
-    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
-        movingLightPos.x += lightMoveSpeed;  // L: Derecha
-    }
-    if (glfwGetKey(window, GLFW_KEY_I) == GLFW_PRESS) {
-        movingLightPos.y += lightMoveSpeed;  // I: Arriba
-    }
-    if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS) {
-        movingLightPos.y -= lightMoveSpeed;  // K: Abajo
-    }
-    if (glfwGetKey(window, GLFW_KEY_U) == GLFW_PRESS) {
-        movingLightPos.z += lightMoveSpeed;  // U: Adelante 
-    }
-    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS) {
-        movingLightPos.z -= lightMoveSpeed;  // O: Atrás 
-    }
-    
-    // Límites luz móvil pecera
-    float minX = -4.5f;   
-    float maxX = 4.5f;
-    float minY = -4.8f;   
-    float maxY = 1.0f;
-    float minZ = -14.0f;  
-    float maxZ = -10.0f;
-    
-    movingLightPos.x = glm::clamp(movingLightPos.x, minX, maxX);
-    movingLightPos.y = glm::clamp(movingLightPos.y, minY, maxY);
-    movingLightPos.z = glm::clamp(movingLightPos.z, minZ, maxZ);
-    
-    
-    // Encender/Apagar luz móvil con la tecla T
-    static bool t_pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !t_pressed) {
-        movingLightEnabled = !movingLightEnabled;
-        std::cout << "Luz móvil: " << (movingLightEnabled ? "ENCENDIDA" : "APAGADA") << std::endl;
-        t_pressed = true;
-    }
-    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE) {
-        t_pressed = false;
-    }
-
-    // Echar comida con la tecla C
-    static bool c_pressed = false;
-    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !c_pressed) {
-        echarComida();
-        c_pressed = true;
-    }
-    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE) {
-        c_pressed = false;
-    }
-
-    // Mover ventilador con teclas B (sentido horario) y R (sentido antihorario)
-    const float velocidadAngular = 0.3f; 
-    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS) {
-        ventilador.anguloMovimiento += velocidadAngular;  
-        if (ventilador.anguloMovimiento >= 360.0f) ventilador.anguloMovimiento -= 360.0f;
-    }
-    if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
-        ventilador.anguloMovimiento -= velocidadAngular;  
-        if (ventilador.anguloMovimiento < 0.0f) ventilador.anguloMovimiento += 360.0f;
-    }
-    
-    // Actualizar posición del ventilador 
-    float anguloRad = glm::radians(ventilador.anguloMovimiento);
-    ventilador.posicion.x = cos(anguloRad) * ventilador.radio;
-    ventilador.posicion.z = -11.5f + sin(anguloRad) * ventilador.radio;
-
-    // Control de número de peces visibles
-    static bool num_pressed = false;
-    if (!num_pressed) {
-        if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS) { peces_visibles = 1; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS) { peces_visibles = 2; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS) { peces_visibles = 3; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS) { peces_visibles = 4; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_5) == GLFW_PRESS) { peces_visibles = 5; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_6) == GLFW_PRESS) { peces_visibles = 6; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_7) == GLFW_PRESS) { peces_visibles = 7; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_8) == GLFW_PRESS) { peces_visibles = 8; num_pressed = true; }
-        else if (glfwGetKey(window, GLFW_KEY_9) == GLFW_PRESS) { peces_visibles = 9; num_pressed = true; }
-    }
-    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_2) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_3) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_4) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_5) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_6) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_7) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_8) == GLFW_RELEASE &&
-        glfwGetKey(window, GLFW_KEY_9) == GLFW_RELEASE) {
-        num_pressed = false;
-    }
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    (void)mods;
+    double x = 0.0;
+    double y = 0.0;
+    glfwGetCursorPos(window, &x, &y);
+    postInput(INPUT_MOUSE_BUTTON, button, action, x, y);
+}
 
+void cursor_pos_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    (void)window;
+    postInput(INPUT_CURSOR, 0, 0, xpos, ypos);
+}
 
-    // Resetear vista
-    static bool spaceKeyPressed = false;
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !spaceKeyPressed) {
-        camAlpha = 0.0f;
-        camBeta = 0.0f;
-        camDist = 18.0f;
-        camOffset = AQUARIUM_CENTER;
-        movingLightPos = glm::vec3(0.0f, 2.0f, -10.0f);  
-        
-        for (int i = 0; i < MAX_COMIDA; i++) {
-            comidas[i].activa = false;
-        }
-        
-        spaceKeyPressed = true;
-    }
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE) {
-        spaceKeyPressed = false;
-    }
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    (void)window;
+    postInput(INPUT_SCROLL, 0, 0, xoffset, yoffset);
 }
 
-glm::vec3 computeCameraPosition()
+glm::vec3 computeCameraPosition(const Camara& camara)
 {
-    const float alpha = glm::radians(camAlpha);
-    const float beta  = glm::radians(camBeta);
+    const float alpha = glm::radians(camara.alpha);
+    const float beta  = glm::radians(camara.beta);
     const float cosBeta = cosf(beta);
     glm::vec3 basePos = glm::vec3(
-        camDist * cosBeta * sinf(alpha),
-        camDist * sinf(beta),
-        camDist * cosBeta * cosf(alpha)
+        camara.dist * cosBeta * sinf(alpha),
+        camara.dist * sinf(beta),
+        camara.dist * cosBeta * cosf(alpha)
     );
-    return basePos + camOffset;
+    return basePos + camara.offset;
 }
 
 // Dibujar cubo
@@ -456,445 +343,114 @@ void drawCube(glm::mat4 P, glm::mat4 V, glm::mat4 M, glm::vec4 color, bool enabl
     shader.setBool("useTexture", false);
     shader.setBool("uEnableLighting", enableLighting);
     
-    if (enableLighting) {
-        shader.setVec3("uAmbientLight", ambientLight);
-        shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-        shader.setVec3("uDirLightColor", dirLightColor);
-        shader.setVec3("uMovingLightPos", movingLightPos);
-        shader.setVec3("uMovingLightColor", movingLightColor);
-        shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    }
-    
     cubeModel.renderModel(GL_TRIANGLES);
 }
 
-// Dibujar Pez
-void drawPez(glm::mat4 P, glm::mat4 V, Pez &pez)
+// Matriz de modelo de un pez: traslación * giro en Y * escala, compuesta directamente
+glm::mat4 pezMatrix(const Pez &pez)
 {
-    glm::mat4 M = glm::mat4(1.0f);
-    M = glm::translate(M, pez.posicion);
-    M = glm::rotate(M, pez.anguloDireccion, glm::vec3(0, 1, 0));
-    M = glm::scale(M, glm::vec3(pez.escala * 0.5f));
+    const float s = pez.escala * 0.5f;
+    const float c = cosf(pez.anguloDireccion) * s;
+    const float n = sinf(pez.anguloDireccion) * s;
+    glm::mat4 M(1.0f);
+    M[0] = glm::vec4(c, 0.0f, -n, 0.0f);
+    M[1] = glm::vec4(0.0f, s, 0.0f, 0.0f);
+    M[2] = glm::vec4(n, 0.0f, c, 0.0f);
+    M[3] = glm::vec4(pez.posicion, 1.0f);
+    return M;
+}
 
+// Instancia de un pez: la cola se anima más rápido cuanto más rápido nada
+InstanceData pezInstance(const Pez &pez, const glm::mat4 &M)
+{
     float velocidadNado = glm::length(pez.velocidad);
     float velocidadAnimacion = velocidadNado * 2.2f;
     
     if (pez.persigiendoComida) {
         velocidadAnimacion *= 6.0f; 
     }
-    
-    glDisable(GL_CULL_FACE);
-    glEnable(GL_POLYGON_OFFSET_FILL);
-    glPolygonOffset(-4.0f, -4.0f);
 
-    shader.useShaders();
-    shader.setMat4("uPVM", P * V * M);
-    shader.setMat4("uModel", M);
-    shader.setMat4("uView", V);
-    shader.setFloat("uTime", t_global * velocidadAnimacion + pez.fase * 2.0f);
-    shader.setBool("uAnimateTail", true);
-    shader.setBool("useTexture", false);
-    shader.setVec4("uColor", pez.color);
-    shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    
-    fishModel.renderModel(GL_TRIANGLES);
-
-    glDisable(GL_POLYGON_OFFSET_FILL);
-    glEnable(GL_CULL_FACE);
+    InstanceData instance;
+    instance.model  = M;
+    instance.color  = pez.color;
+    instance.params = glm::vec4(t_global * velocidadAnimacion + pez.fase * 2.0f, 1.0f, 0.0f, 0.0f);
+    return instance;
 }
 
-void actualizarPeces(float dt)
+// Matriz de modelo de una bola de comida (traslación y escala uniforme)
+glm::mat4 comidaMatrix(const Comida &comida)
 {
-    if (peces_pausados) return;
-
-    const float limiteX = 2.6f;
-    const float limiteY_min = -3.8f;
-    const float limiteY_max = 0.3f;
-    const float limiteZ_min = -13.5f;
-    const float limiteZ_max = -10.5f;
-    const float distanciaEvitacion = 1.5f;
-    const float margenGiro = 0.5f;
-
-    for (int i = 0; i < NUM_PECES; i++) {
-        peces[i].tiempoOndulacion += dt;
-        
-        float velocidadBase = glm::length(peces[i].velocidadOriginal);
-        
-        // Buscar comida cercana
-        int comidaCercana = -1;
-        float distanciaMin = 999999.0f;
-        for (int c = 0; c < MAX_COMIDA; c++) {
-            if (comidas[c].activa) {
-                float dist = glm::distance(peces[i].posicion, comidas[c].posicion);
-                if (dist < distanciaMin) {
-                    distanciaMin = dist;
-                    comidaCercana = c;
-                }
-            }
-        }
-
-        // perseguir comida 
-        if (comidaCercana != -1 && distanciaMin < 8.0f) {
-            peces[i].persigiendoComida = true;  
-            
-            glm::vec3 direccion = glm::normalize(comidas[comidaCercana].posicion - peces[i].posicion);
-            peces[i].anguloObjetivo = atan2(direccion.x, direccion.z);
-            peces[i].alturaObjetivo = comidas[comidaCercana].posicion.y;
-            
-            if (distanciaMin > 1.5f) {
-                velocidadBase = velocidadBase * (1.8f + (8.0f - distanciaMin) * 0.2f);
-            } else if (distanciaMin > 0.5f) {
-                velocidadBase = velocidadBase * 1.6f;
-            } else {
-                velocidadBase = velocidadBase * (0.5f + distanciaMin);
-            }
-            
-            // Comer comida cuando están cerca
-            if (distanciaMin < 0.4f) {
-                comidas[comidaCercana].escala -= dt * 1.5f;  
-                if (comidas[comidaCercana].escala <= 0.0f) {
-                    comidas[comidaCercana].activa = false;  
-                }
-            }
-        }
-        else {
-            peces[i].persigiendoComida = false;  // No hay comida cerca
-            
-            // nadar hacia adelante
-            peces[i].tiempoCambio -= dt;
-            if (peces[i].tiempoCambio <= 0.0f) {
-                peces[i].tiempoCambio = 3.0f + (float)rand() / RAND_MAX * 4.0f;
-                
-                // Cambiar altura para explorar todo el volumen vertical
-                float random = (float)rand() / RAND_MAX;
-                if (random < 0.33f) {
-                    peces[i].alturaObjetivo = limiteY_min + ((float)rand() / RAND_MAX) * 1.2f;
-                } else if (random < 0.66f) {
-                    peces[i].alturaObjetivo = limiteY_min + 1.2f + ((float)rand() / RAND_MAX) * 1.5f;
-                } else {
-                    peces[i].alturaObjetivo = limiteY_min + 2.7f + ((float)rand() / RAND_MAX) * 1.3f;
-                }
-                float ajusteDireccion = ((float)rand() / RAND_MAX - 0.5f) * M_PI / 2.5f;
-                peces[i].anguloObjetivo = peces[i].anguloDireccion + ajusteDireccion;
-            }
-
-            // Evitar paredes
-            glm::vec3 direccionGiro(0.0f);
-            bool necesitaGirar = false;
-            
-            glm::vec3 dirActual(sin(peces[i].anguloDireccion), 0.0f, cos(peces[i].anguloDireccion));
-            glm::vec3 posFutura = peces[i].posicion + dirActual * velocidadBase * 1.2f;
-            
-            if (posFutura.x > limiteX - margenGiro) {
-                direccionGiro.x = -1.0f;
-                necesitaGirar = true;
-            }
-            if (posFutura.x < -limiteX + margenGiro) {
-                direccionGiro.x = 1.0f;
-                necesitaGirar = true;
-            }
-            if (posFutura.y > limiteY_max - margenGiro) {
-                direccionGiro.y = -0.5f;
-                necesitaGirar = true;
-            }
-            if (posFutura.y < limiteY_min + margenGiro) {
-                direccionGiro.y = 0.5f;
-                necesitaGirar = true;
-            }
-            if (posFutura.z > limiteZ_max - margenGiro) {
-                direccionGiro.z = -1.0f;
-                necesitaGirar = true;
-            }
-            if (posFutura.z < limiteZ_min + margenGiro) {
-                direccionGiro.z = 1.0f;
-                necesitaGirar = true;
-            }
-            
-            if (necesitaGirar) {
-                glm::vec3 nuevaDireccion = glm::normalize(dirActual + direccionGiro * 2.0f);
-                peces[i].anguloObjetivo = atan2(nuevaDireccion.x, nuevaDireccion.z);
-            }
-        }
-
-        // Evitar colisiones entre peces 
-        glm::vec3 fuerzaEvitacion(0.0f);
-        bool colisionDetectada = false;
-        const float radioColision = 0.4f;
-        
-        for (int j = 0; j < NUM_PECES; j++) {
-            if (i != j) {
-                glm::vec3 diferencia = peces[i].posicion - peces[j].posicion;
-                float dist = glm::length(diferencia);
-                
-                if (dist < radioColision && dist > 0.01f) {
-                    glm::vec3 direccionSeparacion = glm::normalize(diferencia);
-                    float solapamiento = radioColision - dist;
-                    peces[i].posicion += direccionSeparacion * solapamiento * 0.5f;
-                    colisionDetectada = true;
-                    peces[i].anguloObjetivo = atan2(direccionSeparacion.x, direccionSeparacion.z);
-                }
-                else if (dist < distanciaEvitacion && dist > 0.01f) {
-                    glm::vec3 direccionEvitacion = glm::normalize(diferencia);
-                    float fuerza = (distanciaEvitacion - dist) / distanciaEvitacion;
-                    fuerzaEvitacion += direccionEvitacion * fuerza * 2.0f;
-                }
-            }
-        }
-        
-        if (!colisionDetectada && glm::length(fuerzaEvitacion) > 0.01f) {
-            glm::vec3 dirActual(sin(peces[i].anguloDireccion), 0.0f, cos(peces[i].anguloDireccion));
-            glm::vec3 nuevaDireccion = glm::normalize(dirActual + fuerzaEvitacion);
-            peces[i].anguloObjetivo = atan2(nuevaDireccion.x, nuevaDireccion.z);
-        }
-
-        float difAngulo = peces[i].anguloObjetivo - peces[i].anguloDireccion;
-        while (difAngulo > M_PI) difAngulo -= 2.0f * M_PI;
-        while (difAngulo < -M_PI) difAngulo += 2.0f * M_PI;
-        
-        float velocidadGiro = 1.2f * dt;
-        peces[i].anguloDireccion += glm::clamp(difAngulo, -velocidadGiro, velocidadGiro);
-        
-        // Calcular dirección de nado
-        glm::vec3 direccionNado;
-        direccionNado.x = sin(peces[i].anguloDireccion);
-        direccionNado.z = cos(peces[i].anguloDireccion);
-        direccionNado.y = 0.0f;
-        
-        // Movimiento vertical suave
-        float difAltura = peces[i].alturaObjetivo - peces[i].posicion.y;
-        float velocidadVertical = glm::clamp(difAltura * 0.5f, -0.3f, 0.3f);
-        direccionNado.y = velocidadVertical;
-        
-        glm::vec3 dirHorizontal = glm::normalize(glm::vec3(direccionNado.x, 0.0f, direccionNado.z));
-        peces[i].velocidad = dirHorizontal * velocidadBase + glm::vec3(0.0f, velocidadVertical, 0.0f);
-
-        // Actualizar posición
-        peces[i].posicion += peces[i].velocidad * dt;
-
-        // Limitar posición
-        peces[i].posicion.x = glm::clamp(peces[i].posicion.x, -limiteX, limiteX);
-        peces[i].posicion.y = glm::clamp(peces[i].posicion.y, limiteY_min, limiteY_max);
-        peces[i].posicion.z = glm::clamp(peces[i].posicion.z, limiteZ_min, limiteZ_max);
-    }
+    glm::mat4 M(0.04f * comida.escala);
+    M[3] = glm::vec4(comida.posicion, 1.0f);
+    return M;
 }
 
-void actualizarComida(float dt)
+// Instancia de una bola de comida
+InstanceData comidaInstance(const Comida &comida)
 {
-    for (int i = 0; i < MAX_COMIDA; i++) {
-        if (comidas[i].activa) {
-            comidas[i].posicion.y -= 0.12f * dt;  
-            if (comidas[i].posicion.y < -3.5f) {
-                comidas[i].activa = false;
-            }
-        }
-    }
+    InstanceData instance;
+    instance.model  = comidaMatrix(comida);
+    instance.color  = comida.color;
+    instance.params = glm::vec4(t_global, 0.0f, 0.0f, 0.0f);
+    return instance;
 }
 
-void actualizarBurbujas(float dt)
+// Matriz de modelo de una burbuja (traslación y escala uniforme)
+glm::mat4 burbujaMatrix(const Burbuja &burbuja)
 {
-    const float limiteX = 2.6f;
-    const float limiteZ_min = -13.5f;
-    const float limiteZ_max = -10.5f;
-    const float superficieY = 0.2f;
-    
-    for (int i = 0; i < MAX_BURBUJAS; i++) {
-        if (burbujas[i].activa) {
-            burbujas[i].posicion.y += burbujas[i].velocidadSubida * dt;
-            
-            burbujas[i].fase += dt * 2.0f;
-            burbujas[i].posicion.x += sin(burbujas[i].fase) * burbujas[i].oscilacionX * dt;
-            burbujas[i].posicion.z += cos(burbujas[i].fase * 0.7f) * burbujas[i].oscilacionZ * dt;
-            
-            burbujas[i].posicion.x = glm::clamp(burbujas[i].posicion.x, -limiteX + 0.2f, limiteX - 0.2f);
-            burbujas[i].posicion.z = glm::clamp(burbujas[i].posicion.z, limiteZ_min + 0.2f, limiteZ_max - 0.2f);
-            
-            if (burbujas[i].posicion.y > superficieY) {
-                burbujas[i].activa = false;
-            }
-        }
-    }
+    glm::mat4 M(burbuja.escala);
+    M[3] = glm::vec4(burbuja.posicion, 1.0f);
+    return M;
 }
 
-void generarBurbuja()
+// Instancia de una burbuja
+InstanceData burbujaInstance(const Burbuja &burbuja)
 {
-    for (int i = 0; i < MAX_BURBUJAS; i++) {
-        if (!burbujas[i].activa) {
-            int pezIndex = rand() % peces_visibles;
-            glm::vec3 posPez = peces[pezIndex].posicion;
-            
-            float offsetX = (rand() % 40 - 20) / 100.0f;  
-            float offsetY = (rand() % 30 - 15) / 100.0f;  
-            float offsetZ = 0.1f + (rand() % 20) / 100.0f;  
-            
-            float dirX = sin(peces[pezIndex].anguloDireccion);
-            float dirZ = cos(peces[pezIndex].anguloDireccion);
-            
-            burbujas[i].posicion = glm::vec3(
-                posPez.x + dirX * offsetZ + offsetX,
-                posPez.y + offsetY,
-                posPez.z + dirZ * offsetZ
-            );
-            
-            burbujas[i].escala = 0.020f + (rand() % 60) / 3000.0f;  
-            burbujas[i].velocidadSubida = 0.25f + (rand() % 80) / 400.0f;  
-            burbujas[i].oscilacionX = 0.06f + (rand() % 40) / 500.0f;  
-            burbujas[i].oscilacionZ = 0.06f + (rand() % 40) / 500.0f;
-            burbujas[i].fase = (rand() % 628) / 100.0f;  
-            burbujas[i].activa = true;
-            break; 
-        }
-    }
-}
-
-// Dibujar comida 
-void drawComida(glm::mat4 P, glm::mat4 V, Comida &comida)
-{
-    if (!comida.activa) return;
-
-    glm::mat4 M = glm::mat4(1.0f);
-    M = glm::translate(M, comida.posicion);
-    M = glm::scale(M, glm::vec3(0.04f * comida.escala));  
-
-    shader.useShaders();
-    shader.setMat4("uPVM", P * V * M);
-    shader.setMat4("uModel", M);
-    shader.setMat4("uView", V);
-    shader.setVec4("uColor", comida.color);
-    shader.setBool("useTexture", false);
-    shader.setFloat("uTime", t_global);
-    shader.setBool("uAnimateTail", false);
-    shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    sphereModel.renderModel(GL_TRIANGLES);
-}
-
-// Dibujar burbuja
-void drawBurbuja(glm::mat4 P, glm::mat4 V, Burbuja &burbuja)
-{
-    if (!burbuja.activa) return;
-
-    glm::mat4 M = glm::mat4(1.0f);
-    M = glm::translate(M, burbuja.posicion);
-    M = glm::scale(M, glm::vec3(burbuja.escala));
-
-    shader.useShaders();
-    shader.setMat4("uPVM", P * V * M);
-    shader.setMat4("uModel", M);
-    shader.setMat4("uView", V);
-    shader.setVec4("uColor", glm::vec4(0.8f, 0.9f, 1.0f, 0.5f));
-    shader.setBool("useTexture", false);
-    shader.setFloat("uTime", t_global);
-    shader.setBool("uAnimateTail", false);
-    shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    sphereModel.renderModel(GL_TRIANGLES);
+    InstanceData instance;
+    instance.model  = burbujaMatrix(burbuja);
+    instance.color  = glm::vec4(0.8f, 0.9f, 1.0f, 0.5f);
+    instance.params = glm::vec4(t_global, 0.0f, 0.0f, 0.0f);
+    return instance;
 }
 
-// Actualizar ventilador
-void actualizarVentilador(float dt)
-{
-    ventilador.anguloAspas += ventilador.velocidadRotacion * dt;
-    if (ventilador.anguloAspas > 360.0f) {
-        ventilador.anguloAspas -= 360.0f;
-    }
-    
-    // Rotación del palo (más lenta que las aspas)
-    ventilador.anguloRotacionPalo += 90.0f * dt;  // 90 grados por segundo
-    if (ventilador.anguloRotacionPalo > 360.0f) {
-        ventilador.anguloRotacionPalo -= 360.0f;
-    }
-}
+// Piezas del ventilador: base, palo, esfera y las aspas
+const int NUM_ASPAS = 5;
+const int NUM_PIEZAS_VENTILADOR = 3 + NUM_ASPAS;
 
-// Dibujar ventilador
-void drawVentilador(glm::mat4 P, glm::mat4 V)
+// Matrices de modelo de cada pieza del ventilador (mismo orden que ventiladorModel)
+void ventiladorMatrices(const Ventilador &ventilador, glm::mat4 piezas[NUM_PIEZAS_VENTILADOR])
 {
-    shader.useShaders();
-    shader.setBool("uAnimateTail", false);
-    shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    
     const float CUBE_HALF = 1.0f;
 
     const float paloScaleY = 3.0f;   
     const float baseScaleY = 0.15f;
     const float paloHeight = 2.0f * CUBE_HALF * paloScaleY; 
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ventiladorTexture);
-    shader.setInt("uTexture", 0);
-    shader.setBool("useTexture", true);
-
-    // Dibujar base (cubo achatado)
+    // Base (cubo achatado)
     glm::mat4 baseMatrix(1.0f);
     baseMatrix = glm::translate(baseMatrix, ventilador.posicion);
     baseMatrix = glm::translate(baseMatrix, glm::vec3(0.0f, -baseScaleY * CUBE_HALF, 0.0f)); // bajar "media base"
     baseMatrix = glm::scale(baseMatrix, glm::vec3(0.9f, baseScaleY, 0.9f));
+    piezas[0] = baseMatrix;
 
-    shader.setMat4("uPVM", P * V * baseMatrix);
-    shader.setMat4("uModel", baseMatrix);
-    shader.setMat4("uView", V);
-    shader.setVec4("uColor", glm::vec4(0.3f, 0.3f, 0.3f, 1.0f));
-    cubeModel.renderModel(GL_TRIANGLES);
-
-    // Dibujar palo (cubo alargado)
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ventiladorTexture);
-    shader.setInt("uTexture", 0);
-    shader.setBool("useTexture", true);
-    
+    // Palo (cubo alargado)
     glm::mat4 paloMatrix(1.0f);
     paloMatrix = glm::translate(paloMatrix, ventilador.posicion);
     paloMatrix = glm::rotate(paloMatrix, glm::radians(ventilador.anguloRotacionPalo), glm::vec3(0.0f, 1.0f, 0.0f));
     paloMatrix = glm::translate(paloMatrix, glm::vec3(0.0f, paloScaleY * CUBE_HALF, 0.0f)); 
     paloMatrix = glm::scale(paloMatrix, glm::vec3(0.12f, paloScaleY, 0.12f));
+    piezas[1] = paloMatrix;
 
-    shader.setMat4("uPVM", P * V * paloMatrix);
-    shader.setMat4("uModel", paloMatrix);
-    shader.setMat4("uView", V);
-    shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    cubeModel.renderModel(GL_TRIANGLES);
-    
-    // Dibujar esfera (centro superior del ventilador)
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ventiladorTexture);
-    shader.setInt("uTexture", 0);
-    shader.setBool("useTexture", true);
-    
+    // Esfera (centro superior del ventilador)
     glm::mat4 esferaMatrix = glm::mat4(1.0f);
     esferaMatrix = glm::translate(esferaMatrix, ventilador.posicion);
     esferaMatrix = glm::rotate(esferaMatrix, glm::radians(ventilador.anguloRotacionPalo), glm::vec3(0.0f, 1.0f, 0.0f));  // Girar con el palo
     esferaMatrix = glm::translate(esferaMatrix, glm::vec3(0.0f, paloHeight, 0.0f));
     esferaMatrix = glm::scale(esferaMatrix, glm::vec3(0.25f));
-    shader.setMat4("uPVM", P * V * esferaMatrix);
-    shader.setMat4("uModel", esferaMatrix);
-    shader.setMat4("uView", V);
-    shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    sphereModel.renderModel(GL_TRIANGLES);
-    
-    // Dibujar aspas (5 conos rotando)
-    const int numAspas = 5;
-    for (int i = 0; i < numAspas; i++) {
+    piezas[2] = esferaMatrix;
+
+    // Aspas (5 conos rotando)
+    for (int i = 0; i < NUM_ASPAS; i++) {
         float anguloAspa = ventilador.anguloAspas + (i * 72.0f);  // 72 grados entre cada aspa (360/5)
         
         glm::mat4 aspaMatrix = glm::mat4(1.0f);
@@ -909,83 +465,359 @@ void drawVentilador(glm::mat4 P, glm::mat4 V)
         aspaMatrix = glm::translate(aspaMatrix, glm::vec3(0.6f, 0.0f, 0.0f));
         aspaMatrix = glm::rotate(aspaMatrix, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
         aspaMatrix = glm::scale(aspaMatrix, glm::vec3(0.15f, 0.8f, 0.15f));
-        
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, ventiladorTexture);
-        shader.setInt("uTexture", 0);
-        shader.setBool("useTexture", true);
-        
-        shader.setMat4("uPVM", P * V * aspaMatrix);
-        shader.setMat4("uModel", aspaMatrix);
-        shader.setMat4("uView", V);
-        shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-        coneModel.renderModel(GL_TRIANGLES);
+        piezas[3 + i] = aspaMatrix;
     }
 }
 
-void echarComida()
+// Modelo de cada pieza del ventilador
+Model* ventiladorModel(int pieza)
 {
-    int contador = 0;
-    for (int i = 0; i < MAX_COMIDA && contador < 50; i++) {
-        if (!comidas[i].activa) {
-            comidas[i].posicion = glm::vec3(
-                (rand() % 400 - 200) / 100.0f,
-                0.2f,
-                (rand() % 200 - 1300) / 100.0f
-            );
-
-            int colorType = rand() % 6;
-            switch(colorType) {
-                case 0: comidas[i].color = glm::vec4(1.0f, 0.9f, 0.2f, 1.0f); break;
-                case 1: comidas[i].color = glm::vec4(1.0f, 0.4f, 0.2f, 1.0f); break;
-                case 2: comidas[i].color = glm::vec4(0.9f, 0.2f, 0.2f, 1.0f); break;
-                case 3: comidas[i].color = glm::vec4(0.3f, 0.8f, 0.3f, 1.0f); break;
-                case 4: comidas[i].color = glm::vec4(0.8f, 0.6f, 0.3f, 1.0f); break;
-                case 5: comidas[i].color = glm::vec4(0.9f, 0.5f, 0.7f, 1.0f); break;
-            }
+    if (pieza < 2) return &cubeModel;
+    if (pieza == 2) return &sphereModel;
+    return &coneModel;
+}
+
+// Posiciones de los corales en el fondo
+const int NUM_CORALES = 11;
+const glm::vec3 CORAL_POSITIONS[NUM_CORALES] = {
+    glm::vec3(-2.3f, -5.2f, -10.2f),
+    glm::vec3(1.8f, -5.2f, -11.3f),
+    glm::vec3(-1.5f, -5.2f, -12.8f),
+    glm::vec3(2.7f, -5.2f, -10.7f),
+    glm::vec3(0.5f, -5.2f, -11.8f),
+    glm::vec3(-0.8f, -5.2f, -13.2f),
+    glm::vec3(-0.2f, -5.2f, -10.5f),
+    glm::vec3(2.0f, -5.2f, -12.3f),
+    glm::vec3(-1.8f, -5.2f, -11.7f),
+    glm::vec3(0.9f, -5.2f, -10.8f),
+    glm::vec3(-2.1f, -5.2f, -12.1f)
+};
+
+// Matriz de modelo de un coral, que se mece con el tiempo
+glm::mat4 coralMatrix(int i, float timeValue)
+{
+    glm::mat4 coralMatrix(1.0f);
+    coralMatrix = glm::translate(coralMatrix, CORAL_POSITIONS[i]);
+    coralMatrix = glm::rotate(coralMatrix, glm::radians(-90.0f), glm::vec3(1, 0, 0)); 
+    
+    float frequencia = 1.0f + (i * 0.1f);  
+    float amplitudX = 0.8f + sin(i * 0.5f) * 0.3f;  
+    float amplitudZ = 0.6f + cos(i * 0.7f) * 0.2f;  
+    float faseX = i * 0.8f;  
+    float faseZ = i * 1.2f;
+    
+    float anguloX = sin(timeValue * frequencia + faseX) * amplitudX;
+    float anguloZ = cos(timeValue * frequencia * 0.8f + faseZ) * amplitudZ;
+    
+    coralMatrix = glm::rotate(coralMatrix, glm::radians(anguloX), glm::vec3(1, 0, 0));
+    coralMatrix = glm::rotate(coralMatrix, glm::radians(anguloZ), glm::vec3(0, 0, 1));
+    
+    float escala;
+    if (i < 6) escala = 0.025f;
+    else if (i < 9) escala = 0.015f;
+    else escala = 0.014f;
+    return glm::scale(coralMatrix, glm::vec3(escala));
+}
+
+// Instancias del frame: todos los grupos van seguidos en un único buffer y cada uno se dibuja con
+// una sola llamada. Los peces se agrupan por nivel de detalle y el ventilador por modelo
+struct FrameInstances {
+    InstanceRange peces[FISH_LOD_LEVELS + 1];
+    InstanceRange corales;
+    InstanceRange ventilador[3];   // Cubos (base y palo), esfera y conos (aspas)
+    InstanceRange comidas;
+    InstanceRange burbujas;
+};
+
+InstanceBuffer instanceBuffer;
+RingBuffer     uniformRing;     // Bloques uniformes escritos cada frame (iluminación)
+
+// Tiempo de GPU de cada parte de la escena (--gpu-profile)
+GpuProfiler gpuProfiler;
+
+// Parte de la escena: tramo de tiempo de GPU y, si se compila con trazas, también de CPU
+void beginPass(const char* name)
+{
+    gpuProfiler.begin(name);
+    TRACE_BEGIN(name);
+}
 
-            comidas[i].escala = 1.0f; 
-            comidas[i].activa = true;
-            contador++;
+void endPass()
+{
+    TRACE_END();
+    gpuProfiler.end();
+}
+
+// Elementos por trozo al repartir el trabajo de instancias entre los hilos
+const size_t INSTANCE_CHUNK = 256;
+
+// Trabajo intermedio del frame (se conserva entre frames para no reservar memoria)
+std::vector<glm::mat4> matricesPeces;
+std::vector<glm::vec4> esferasPeces;
+std::vector<int>       pecesPorLod[FISH_LOD_LEVELS + 1];
+std::vector<int>       comidasVisibles;
+std::vector<int>       burbujasVisibles;
+
+// Grupo del ventilador de cada pieza (índice en FrameInstances::ventilador)
+int ventiladorGrupo(int pieza)
+{
+    if (pieza < 2) return 0;
+    if (pieza == 2) return 1;
+    return 2;
+}
+
+//--------------------------------------------------------------------------------------------
+// Matrices, recorte y nivel de detalle de los peces (pecesPorLod). El nivel de cada pez depende
+// del que tenía (histéresis), así que se llama también en los frames que se saltan sin dibujar
+//--------------------------------------------------------------------------------------------
+void selectFishLods(const WorldSnapshot& world, const Frustum& frustum, const glm::mat4& projection, const glm::vec3& eye)
+{
+    // Fase 1: matrices y esferas de los peces
+    const int numPeces = world.peces_visibles;
+    matricesPeces.resize(numPeces);
+    esferasPeces.resize(numPeces);
+    jobs.parallelFor(numPeces, INSTANCE_CHUNK, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            matricesPeces[i] = pezMatrix(world.peces[i]);
+            esferasPeces[i] = transformSphere(matricesPeces[i], fishModel.getBounds());
+            esferasPeces[i].w *= FISH_BOUNDS_MARGIN;
         }
+    });
+
+    // Recorte y nivel de detalle de los peces
+    fishBatch.clear();
+    for (int i = 0; i < numPeces; i++) fishBatch.add(esferasPeces[i], i);
+    fishBatch.cull(frustum, cullStats);
+    for (int lod = 0; lod <= FISH_LOD_LEVELS; lod++) pecesPorLod[lod].clear();
+    for (size_t k = 0; k < fishBatch.size(); k++) {
+        if (!fishBatch.isVisible(k)) continue;
+        int i = fishBatch.id(k);
+        float size = projectedSize(esferasPeces[i], eye, projection);
+        pecesLod[i] = selectLod(size, pecesLod[i], FISH_LOD_THRESHOLDS, FISH_LOD_LEVELS + 1, FISH_LOD_HYSTERESIS);
+        pecesPorLod[pecesLod[i]].push_back(i);
     }
 }
 
-void renderScene(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye, float timeValue)
+//--------------------------------------------------------------------------------------------
+// Calcula las instancias visibles del frame. El recorte de cada grupo es una tarea independiente;
+// las matrices y los datos de instancia se generan en paralelo y se escriben directamente en el
+// buffer proyectado. El reparto de los peces por LOD se hace en este hilo entre las dos fases
+//--------------------------------------------------------------------------------------------
+void buildInstances(const WorldSnapshot& world, const Frustum& frustum, const glm::mat4& projection, const glm::vec3& eye, float timeValue, FrameInstances& frame)
 {
+    TRACE_SCOPE("buildInstances");
+
+    // Recorte de corales, ventilador, comida y burbujas mientras este hilo se ocupa de los peces
+    CullStats estadisticas[4] = {};
+    glm::mat4 corales[NUM_CORALES];
+    glm::mat4 piezas[NUM_PIEZAS_VENTILADOR];
+    JobCounter recorte;
+
+    jobs.submit([&] {
+        coralBatch.clear();
+        for (int i = 0; i < NUM_CORALES; i++) {
+            corales[i] = coralMatrix(i, timeValue);
+            coralBatch.add(transformSphere(corales[i], coralModel.getBounds()), i);
+        }
+        coralBatch.cull(frustum, estadisticas[0]);
+    }, &recorte);
+
+    jobs.submit([&] {
+        ventiladorMatrices(world.ventilador, piezas);
+        fanBatch.clear();
+        for (int i = 0; i < NUM_PIEZAS_VENTILADOR; i++) {
+            fanBatch.add(transformSphere(piezas[i], ventiladorModel(i)->getBounds()), i);
+        }
+        fanBatch.cull(frustum, estadisticas[1]);
+    }, &recorte);
+
+    jobs.submit([&] {
+        foodBatch.clear();
+        for (int i = 0; i < MAX_COMIDA; i++) {
+            if (world.comidas[i].activa) foodBatch.add(transformSphere(comidaMatrix(world.comidas[i]), sphereModel.getBounds()), i);
+        }
+        foodBatch.cull(frustum, estadisticas[2]);
+        comidasVisibles.clear();
+        for (size_t k = 0; k < foodBatch.size(); k++) {
+            if (foodBatch.isVisible(k)) comidasVisibles.push_back(foodBatch.id(k));
+        }
+    }, &recorte);
+
+    jobs.submit([&] {
+        bubbleBatch.clear();
+        for (int i = 0; i < MAX_BURBUJAS; i++) {
+            if (world.burbujas[i].activa) bubbleBatch.add(transformSphere(burbujaMatrix(world.burbujas[i]), sphereModel.getBounds()), i);
+        }
+        bubbleBatch.cull(frustum, estadisticas[3]);
+        burbujasVisibles.clear();
+        for (size_t k = 0; k < bubbleBatch.size(); k++) {
+            if (bubbleBatch.isVisible(k)) burbujasVisibles.push_back(bubbleBatch.id(k));
+        }
+    }, &recorte);
+
+    // Peces en este hilo mientras tanto
+    selectFishLods(world, frustum, projection, eye);
+
+    jobs.wait(recorte);
+    for (int g = 0; g < 4; g++) {
+        cullStats.visible += estadisticas[g].visible;
+        cullStats.culled  += estadisticas[g].culled;
+    }
+
+    // Rangos de cada grupo dentro del buffer
+    size_t total = 0;
+    for (int lod = 0; lod <= FISH_LOD_LEVELS; lod++) {
+        frame.peces[lod].first = total;
+        frame.peces[lod].count = pecesPorLod[lod].size();
+        total += frame.peces[lod].count;
+    }
+    frame.corales.first = total;
+    frame.corales.count = 0;
+    for (size_t k = 0; k < coralBatch.size(); k++) frame.corales.count += coralBatch.isVisible(k);
+    total += frame.corales.count;
+    for (int g = 0; g < 3; g++) frame.ventilador[g].count = 0;
+    for (size_t k = 0; k < fanBatch.size(); k++) {
+        if (fanBatch.isVisible(k)) frame.ventilador[ventiladorGrupo(fanBatch.id(k))].count++;
+    }
+    for (int g = 0; g < 3; g++) {
+        frame.ventilador[g].first = total;
+        total += frame.ventilador[g].count;
+    }
+    frame.comidas.first = total;
+    frame.comidas.count = comidasVisibles.size();
+    total += frame.comidas.count;
+    frame.burbujas.first = total;
+    frame.burbujas.count = burbujasVisibles.size();
+    total += frame.burbujas.count;
+
+    // Fase 2: datos de instancia escritos directamente en el buffer proyectado
+    // Sin buffer no hay nada que dibujar en este frame: los grupos vacíos no generan dibujos
+    InstanceData *instances = instanceBuffer.map(total);
+    if (!instances) {
+        frame = FrameInstances();
+        return;
+    }
+
+    for (int lod = 0; lod <= FISH_LOD_LEVELS; lod++) {
+        const std::vector<int> &peces = pecesPorLod[lod];
+        InstanceData *dst = instances + frame.peces[lod].first;
+        jobs.parallelFor(peces.size(), INSTANCE_CHUNK, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; k++) dst[k] = pezInstance(world.peces[peces[k]], matricesPeces[peces[k]]);
+        });
+    }
+    jobs.parallelFor(comidasVisibles.size(), INSTANCE_CHUNK, [&](size_t begin, size_t end) {
+        InstanceData *dst = instances + frame.comidas.first;
+        for (size_t k = begin; k < end; k++) dst[k] = comidaInstance(world.comidas[comidasVisibles[k]]);
+    });
+    jobs.parallelFor(burbujasVisibles.size(), INSTANCE_CHUNK, [&](size_t begin, size_t end) {
+        InstanceData *dst = instances + frame.burbujas.first;
+        for (size_t k = begin; k < end; k++) dst[k] = burbujaInstance(world.burbujas[burbujasVisibles[k]]);
+    });
+
+    InstanceData *coral = instances + frame.corales.first;
+    for (size_t k = 0; k < coralBatch.size(); k++) {
+        if (!coralBatch.isVisible(k)) continue;
+        coral->model  = corales[coralBatch.id(k)];
+        coral->color  = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+        coral->params = glm::vec4(timeValue, 0.0f, (float)coralLayer, 1.0f);
+        coral++;
+    }
+
+    // La base del ventilador es gris; el resto de piezas usa la textura tal cual
+    size_t siguiente[3] = { frame.ventilador[0].first, frame.ventilador[1].first, frame.ventilador[2].first };
+    for (size_t k = 0; k < fanBatch.size(); k++) {
+        if (!fanBatch.isVisible(k)) continue;
+        int i = fanBatch.id(k);
+        InstanceData &pieza = instances[siguiente[ventiladorGrupo(i)]++];
+        pieza.model  = piezas[i];
+        pieza.color  = i == 0 ? glm::vec4(0.3f, 0.3f, 0.3f, 1.0f) : glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+        pieza.params = glm::vec4(timeValue, 0.0f, (float)ventiladorLayer, 1.0f);
+    }
+
+    instanceBuffer.unmap();
+}
+
+//------------------------------------------------------------------------------------------
+// Escribe la iluminación del frame en el anillo de uniformes y la enlaza al bloque Lighting:
+// una escritura por frame en vez de seis uniformes por cada objeto dibujado
+//------------------------------------------------------------------------------------------
+void uploadLighting(const LuzMovil& luz)
+{
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    size_t offset;
+    LightingBlock *block = (LightingBlock *)uniformRing.allocate(sizeof(LightingBlock), (size_t)alignment, offset);
+    if (!block) return;
+    block->ambientLight     = glm::vec4(ambientLight, 0.0f);
+    block->dirLightDir      = glm::vec4(glm::normalize(dirLightDir), 0.0f);
+    block->dirLightColor    = glm::vec4(dirLightColor, 0.0f);
+    block->movingLightPos   = glm::vec4(luz.posicion, 1.0f);
+    block->movingLightColor = glm::vec4(movingLightColor, luz.encendida ? 1.0f : 0.0f);
+    uniformRing.commit();
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTING_BLOCK_BINDING, uniformRing.getId(), (GLintptr)offset, sizeof(LightingBlock));
+}
+
+void renderScene(const WorldSnapshot& world, const LuzMovil& luz, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& eye, float timeValue)
+{
+    TRACE_SCOPE("renderScene");
+
+    // Proyección por vista una sola vez por frame: volumen de visión y uPV de las instancias
+    const glm::mat4 PV = projection * view;
+    const Frustum frustum = extractFrustum(PV);
+    cullStats.visible = 0;
+    cullStats.culled = 0;
+
+    // Datos por frame en una parte nueva de los anillos (espera solo si la GPU va muy atrasada)
+    instanceBuffer.beginFrame();
+    uniformRing.beginFrame();
+    uploadLighting(luz);
+
     // Fondo de habitación
+    beginPass("fondo");
     glDisable(GL_DEPTH_TEST);
     shader.useShaders();
     shader.setVec3("uViewPos", eye);
+    shader.setMat4("uPV", PV);
+    shader.setBool("uInstanced", false);
+    sceneTextures.bind(0);
+    shader.setInt("uTextureArray", 0);
     
     glm::mat4 roomBackMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -15.0f));
     roomBackMatrix = glm::scale(roomBackMatrix, glm::vec3(20.0f, 15.0f, 1.0f));
-    shader.setMat4("uPVM", projection * view * roomBackMatrix);
+    shader.setMat4("uPVM", PV * roomBackMatrix);
     shader.setMat4("uModel", roomBackMatrix);
     shader.setMat4("uView", view);
     shader.setBool("useTexture", true);
     shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
     shader.setBool("uEnableLighting", false);
-    glBindTexture(GL_TEXTURE_2D, roomBackTexture);
+    shader.setFloat("uTextureLayer", (float)roomBackLayer);
     glBindVertexArray(backgroundVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::countVao();
+    RenderStats::countDraw(6);
     
     // Fondo del acuario
     glm::mat4 backgroundMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.7f, -14.5f));
     backgroundMatrix = glm::scale(backgroundMatrix, glm::vec3(5.0f, 3.5f, 1.0f));
-    shader.setMat4("uPVM", projection * view * backgroundMatrix);
+    shader.setMat4("uPVM", PV * backgroundMatrix);
     shader.setMat4("uModel", backgroundMatrix);
     shader.setMat4("uView", view);
     shader.setBool("useTexture", true);
     shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
     shader.setBool("uEnableLighting", false);
-    glBindTexture(GL_TEXTURE_2D, backgroundTexture);
+    shader.setFloat("uTextureLayer", (float)backgroundLayer);
     glBindVertexArray(backgroundVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
     glBindVertexArray(0);
+    RenderStats::countVao();
+    RenderStats::countDraw(6);
     glEnable(GL_DEPTH_TEST);
+    endPass();
 
     // Mesa
+    beginPass("mesa");
     shader.useShaders();
     shader.setVec3("uViewPos", eye);
     glDisable(GL_BLEND);
@@ -994,7 +826,7 @@ void renderScene(const glm::mat4& projection, const glm::mat4& view, const glm::
     tableMatrix = glm::translate(tableMatrix, glm::vec3(0.0f, -10.0f, -12.0f));
     tableMatrix = glm::rotate(tableMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
     tableMatrix = glm::scale(tableMatrix, glm::vec3(12.0f, 12.0f, 12.0f));
-    shader.setMat4("uPVM", projection * view * tableMatrix);
+    shader.setMat4("uPVM", PV * tableMatrix);
     shader.setMat4("uModel", tableMatrix);
     shader.setMat4("uView", view);
     shader.setFloat("uTime", timeValue);
@@ -1002,28 +834,23 @@ void renderScene(const glm::mat4& projection, const glm::mat4& view, const glm::
     shader.setVec4("uColor", glm::vec4(0.85f, 0.85f, 0.85f, 1.0f));
     shader.setBool("useTexture", false);
     shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
     glFrontFace(GL_CW);
     tableModel.renderModel(GL_FILL);
     glFrontFace(GL_CCW);
     glEnable(GL_BLEND);
+    endPass();
 
     // Arena del fondo
+    beginPass("arena");
     shader.useShaders();
     shader.setVec3("uViewPos", eye);
     glDisable(GL_BLEND);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, sandTexture);
+    shader.setFloat("uTextureLayer", (float)sandLayer);
     glm::mat4 sandMatrix(1.0f);
     sandMatrix = glm::translate(sandMatrix, glm::vec3(0.0f, -5.19f, -12.0f));
     sandMatrix = glm::rotate(sandMatrix, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
     sandMatrix = glm::scale(sandMatrix, glm::vec3(5.0f, 2.5f, 0.01f));
-    shader.setMat4("uPVM", projection * view * sandMatrix);
+    shader.setMat4("uPVM", PV * sandMatrix);
     shader.setMat4("uModel", sandMatrix);
     shader.setMat4("uView", view);
     shader.setFloat("uTime", timeValue);
@@ -1031,22 +858,18 @@ void renderScene(const glm::mat4& projection, const glm::mat4& view, const glm::
     shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
     shader.setBool("useTexture", true);
     shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
     cubeModel.renderModel(GL_FILL);
     glEnable(GL_BLEND);
+    endPass();
 
     // Agua del acuario 
+    beginPass("agua");
     shader.useShaders();
     shader.setVec3("uViewPos", eye);
     glm::mat4 waterTableMatrix(1.0f);
     waterTableMatrix = glm::translate(waterTableMatrix, glm::vec3(0.0f, -1.7f, -12.0f));
     waterTableMatrix = glm::scale(waterTableMatrix, glm::vec3(5.0f, 3.5f, 2.5f));
-    shader.setMat4("uPVM", projection * view * waterTableMatrix);
+    shader.setMat4("uPVM", PV * waterTableMatrix);
     shader.setMat4("uModel", waterTableMatrix);
     shader.setMat4("uView", view);
     shader.setFloat("uTime", timeValue);
@@ -1054,116 +877,363 @@ void renderScene(const glm::mat4& projection, const glm::mat4& view, const glm::
     shader.setVec4("uColor", glm::vec4(0.12f, 0.4f, 0.6f, 0.32f));
     shader.setBool("useTexture", false);
     shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
     glDepthMask(GL_FALSE);
     cubeModel.renderModel(GL_FILL);
     glDepthMask(GL_TRUE);
+    endPass();
+
+    // Resto de la escena con instancias: un dibujo por grupo
+    FrameInstances frame;
+    buildInstances(world, frustum, projection, eye, timeValue, frame);
+    const GLuint instances = instanceBuffer.getId();
+    const size_t base = instanceBuffer.baseInstance();
 
-    // Corales en el fondo
     shader.useShaders();
     shader.setVec3("uViewPos", eye);
+    shader.setMat4("uView", view);
     shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-    
+    shader.setBool("uInstanced", true);
+
     // Corales 
-    shader.setBool("uAnimateTail", false);
-    shader.setBool("uEnableLighting", true);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, coralTexture);
-    shader.setInt("uTexture", 0);
-    shader.setBool("useTexture", true);
-    shader.setVec4("uColor", glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    
-    glm::vec3 coralPositions[11] = {
-        glm::vec3(-2.3f, -5.2f, -10.2f),
-        glm::vec3(1.8f, -5.2f, -11.3f),
-        glm::vec3(-1.5f, -5.2f, -12.8f),
-        glm::vec3(2.7f, -5.2f, -10.7f),
-        glm::vec3(0.5f, -5.2f, -11.8f),
-        glm::vec3(-0.8f, -5.2f, -13.2f),
-        glm::vec3(-0.2f, -5.2f, -10.5f),
-        glm::vec3(2.0f, -5.2f, -12.3f),
-        glm::vec3(-1.8f, -5.2f, -11.7f),
-        glm::vec3(0.9f, -5.2f, -10.8f),
-        glm::vec3(-2.1f, -5.2f, -12.1f)
-    };
-    
-    for (int i = 0; i < 11; i++) {
-        glm::mat4 coralMatrix(1.0f);
-        coralMatrix = glm::translate(coralMatrix, coralPositions[i]);
-        coralMatrix = glm::rotate(coralMatrix, glm::radians(-90.0f), glm::vec3(1, 0, 0)); 
-        
-        float frequencia = 1.0f + (i * 0.1f);  
-        float amplitudX = 0.8f + sin(i * 0.5f) * 0.3f;  
-        float amplitudZ = 0.6f + cos(i * 0.7f) * 0.2f;  
-        float faseX = i * 0.8f;  
-        float faseZ = i * 1.2f;
-        
-        float anguloX = sin(timeValue * frequencia + faseX) * amplitudX;
-        float anguloZ = cos(timeValue * frequencia * 0.8f + faseZ) * amplitudZ;
-        
-        coralMatrix = glm::rotate(coralMatrix, glm::radians(anguloX), glm::vec3(1, 0, 0));
-        coralMatrix = glm::rotate(coralMatrix, glm::radians(anguloZ), glm::vec3(0, 0, 1));
-        
-        float escala;
-        if (i < 6) escala = 0.025f;
-        else if (i < 9) escala = 0.015f;
-        else escala = 0.014f;
-        coralMatrix = glm::scale(coralMatrix, glm::vec3(escala));
-        
-        shader.setMat4("uPVM", projection * view * coralMatrix);
-        shader.setMat4("uModel", coralMatrix);
-        shader.setMat4("uView", view);
-        shader.setFloat("uTime", timeValue);
-        
-        coralModel.renderModel(GL_TRIANGLES);
-    }
+    beginPass("corales");
+    coralModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.corales.first, frame.corales.count);
+    endPass();
 
     // Ventilador
-    drawVentilador(projection, view);
+    beginPass("ventilador");
+    cubeModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.ventilador[0].first, frame.ventilador[0].count);
+    sphereModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.ventilador[1].first, frame.ventilador[1].count);
+    coneModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.ventilador[2].first, frame.ventilador[2].count);
+    endPass();
 
     // Peces
-    shader.useShaders();
-    shader.setVec3("uViewPos", eye);
-    shader.setBool("uEnableLighting", true);
-    shader.setVec3("uAmbientLight", ambientLight);
-    shader.setVec3("uDirLightDir", glm::normalize(dirLightDir));
-    shader.setVec3("uDirLightColor", dirLightColor);
-    shader.setVec3("uMovingLightPos", movingLightPos);
-    shader.setVec3("uMovingLightColor", movingLightColor);
-    shader.setBool("uMovingLightEnabled", movingLightEnabled);
-
-    for (int i = 0; i < peces_visibles; i++) {
-        drawPez(projection, view, peces[i]);
+    beginPass("peces");
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(-4.0f, -4.0f);
+    for (int lod = 0; lod <= FISH_LOD_LEVELS; lod++) {
+        Model &model = lod == 0 ? fishModel : fishLods[lod - 1];
+        model.renderModelInstanced(GL_TRIANGLES, instances, base + frame.peces[lod].first, frame.peces[lod].count);
     }
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glEnable(GL_CULL_FACE);
+    endPass();
 
     // Comida
-    for (int i = 0; i < MAX_COMIDA; i++) {
-        drawComida(projection, view, comidas[i]);
-    }
+    beginPass("comida");
+    sphereModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.comidas.first, frame.comidas.count);
+    endPass();
     
     // Burbujas 
+    beginPass("burbujas");
     glDepthMask(GL_FALSE);  
-    for (int i = 0; i < MAX_BURBUJAS; i++) {
-        drawBurbuja(projection, view, burbujas[i]);
-    }
+    sphereModel.renderModelInstanced(GL_TRIANGLES, instances, base + frame.burbujas.first, frame.burbujas.count);
     glDepthMask(GL_TRUE);  
+    endPass();
+
+    shader.setBool("uInstanced", false);
+    RenderStats::countCulled(cullStats.culled);
+
+    // La GPU puede seguir leyendo esta parte de los anillos hasta que pase su fence
+    instanceBuffer.endFrame();
+    uniformRing.endFrame();
 }
 
-int main()
+//------------------------------------------------------------------------------------------
+// GLEW con el contexto ya activo. Sin servidor X (contexto EGL u OSMesa) GLEW carga igualmente
+// las funciones de OpenGL, pero devuelve GLEW_ERROR_NO_GLX_DISPLAY al no encontrar GLX
+//------------------------------------------------------------------------------------------
+bool initGlew(bool headless)
 {
-    srand((unsigned)time(nullptr));
+    glewExperimental = GL_TRUE;
+    const GLenum result = glewInit();
+    if (result == GLEW_OK || (headless && result == GLEW_ERROR_NO_GLX_DISPLAY)) return true;
+    std::cerr << "ERROR: No se pudo iniciar GLEW\n";
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+// Estado de OpenGL, shaders, anillos, recursos y estado inicial de la simulación: común a la
+// ventana y al modo sin ventana
+//------------------------------------------------------------------------------------------
+void initScene(unsigned int seed)
+{
+    AllocScope scope(ALLOC_CARGA);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0.85f, 0.82f, 0.75f, 1.0f);
+
+    shader.initShaders(
+        "resources/shaders/vshader.glsl",
+        "resources/shaders/fshader.glsl"
+    );
+    shader.setUniformBlock("Lighting", LIGHTING_BLOCK_BINDING);
+
+    // Anillos para los datos que cambian cada frame (crecen si se quedan pequeños)
+    instanceBuffer.init(1024);
+    uniformRing.init(GL_UNIFORM_BUFFER, 4096, "uniformes");
+
+    // Modelos y texturas: se decodifican en paralelo y se suben desde este hilo
+    AssetLoader assetLoader(jobs);
+    registerAssets(assetLoader);
+    assetLoader.loadAll();
+    assetLoader.printReport();
+    
+    createBackgroundPlane();
+    hudText.init(2);
+
+    simulation.init(seed);
+}
+
+// Cámara y proyección del frame para un framebuffer de width x height
+struct FrameCamera {
+    glm::vec3 eye;
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
+FrameCamera frameCamera(const Camara& camara, int width, int height)
+{
+    if (height == 0) height = 1;
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    FrameCamera camera;
+    camera.eye = computeCameraPosition(camara);
+    camera.view = glm::lookAt(camera.eye, camara.offset, glm::vec3(0.0f, 1.0f, 0.0f));
+    camera.projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+    return camera;
+}
+
+// Dibujo de la escena en el framebuffer activo, de width x height, con la vista actual
+void drawWorld(const WorldSnapshot& world, int width, int height)
+{
+    const FrameCamera camera = frameCamera(view.getCamara(), width, height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    renderScene(world, view.getLuz(), camera.projection, camera.view, camera.eye, world.tiempo);
+}
+
+// Superposición con los contadores del último frame completo, los frames por segundo y el tiempo
+// simulado, sobre el framebuffer activo de width x height (un solo dibujo)
+void drawHud(const WorldSnapshot& world, double fps, int width, int height)
+{
+    const RenderCounters& stats = RenderStats::last();
+    const MemoryUsage gpu = MemoryRegistry::gpuUsage();
+    char text[512];
+    snprintf(text, sizeof(text),
+             "%.0f fps (%.2f ms)  sim %.2f s  paso %llu\n"
+             "dibujos %u  triangulos %llu  vertices %llu\n"
+             "uniformes %u  programas %u  texturas %u  VAOs %u\n"
+             "buffers %.1f KB  recortados %u\n"
+             "reservas %llu (%.1f KB)\n"
+             "GPU %.1f MB (max %.1f)  CPU %.1f MB",
+             fps, fps > 0.0 ? 1000.0 / fps : 0.0, world.tiempo, world.paso,
+             stats.drawCalls, stats.triangles, stats.vertices,
+             stats.uniforms, stats.programBinds, stats.textureBinds, stats.vaoBinds,
+             stats.bufferBytes / 1024.0, stats.culled,
+             AllocStats::lastTotal().allocs, AllocStats::lastTotal().bytes / 1024.0,
+             gpu.bytes / 1048576.0, gpu.peak / 1048576.0, MemoryRegistry::cpuUsage().bytes / 1048576.0);
+
+    int lines = 1;
+    int columns = 0;
+    for (int i = 0, column = 0; text[i]; i++) {
+        if (text[i] == '\n') {
+            lines++;
+            column = 0;
+        } else {
+            columns = std::max(columns, ++column);
+        }
+    }
+    const float margin = 8.0f;
+    const float padding = 6.0f;
+    hudText.panel(margin, margin, columns * hudText.charWidth() + 2.0f * padding, lines * hudText.lineHeight() + 2.0f * padding, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+    hudText.print(margin + padding, margin + padding, text, glm::vec4(1.0f, 1.0f, 0.85f, 1.0f));
+    hudText.draw(width, height);
+}
+
+// Esperas de cada anillo a las fences de la GPU y veces que ha tenido que crecer
+void printRingStats(const char* name, const RingBufferStats& ringStats)
+{
+    std::cout << "Anillo de " << name << " (" << (ringStats.persistent ? "persistente" : "huerfano") << "): "
+              << ringStats.stalls << " esperas, " << ringStats.totalStallMs << " ms en total, "
+              << ringStats.maxStallMs << " ms como maximo, " << ringStats.resizes << " ampliaciones" << std::endl;
+}
+
+void printRingStats()
+{
+    printRingStats("instancias", instanceBuffer.getStats());
+    printRingStats("uniformes", uniformRing.getStats());
+    printRingStats("texto", hudText.getStats());
+}
+
+//------------------------------------------------------------------------------------------------
+// Modo sin ventana: contexto EGL u OSMesa y escena en un FBO del tamaño pedido. La simulación no
+// usa su hilo ni el reloj: avanza options.fixedDt por frame, así que con la misma semilla salen
+// siempre los mismos frames. Opcionalmente guarda cada frame en PPM y el tiempo de cada uno en CSV
+//------------------------------------------------------------------------------------------------
+int runHeadless(const Options& options)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    HeadlessContext context;
+    if (!context.create() || !initGlew(true)) return EXIT_FAILURE;
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+
+    const unsigned int seed = sessionSeed(options, 1);
+    initScene(seed);
+    startRecording(options, seed);
+    AllocStats::setCheck(options.allocCheck);
+
+    RenderTarget target;
+    if (!target.init(options.width, options.height)) return EXIT_FAILURE;
+
+    FrameCapture capture;
+    if (options.captureFile && !capture.start(options.captureFile, options.width, options.height)) return EXIT_FAILURE;
+    const bool percentiles = options.percentiles || options.percentilesFile;
+    gpuProfiler.init(options.gpuProfile || percentiles);
+    gpuProfiler.setFrameHistogram(&gpuHistogram);
+
+    // Con --first-frame se avanza hasta ese frame sin dibujar. El nivel de detalle de los peces
+    // se sigue calculando para que los frames salgan iguales que en una pasada completa
+    for (int i = 0; i < options.firstFrame; i++) {
+        advanceSimulation(options.fixedDt);
+        const WorldSnapshot& world = simulation.latest();
+        updateView(world, options.fixedDt);
+        const FrameCamera camera = frameCamera(view.getCamara(), options.width, options.height);
+        selectFishLods(world, extractFrustum(camera.projection * camera.view), camera.projection, camera.eye);
+    }
+
+    // Con --timing se espera a la GPU en cada frame para medirlo entero; si no, se mide lo enviado.
+    // Un escenario dura lo que diga su guion y una repetición hasta el paso en que acabó la grabación,
+    // salvo que --frames pida menos (p. ej. un solo frame de un escenario con --golden)
+    int frames = options.frames;
+    if (scenario.isLoaded()) frames = std::max(0, scenario.frames(options.fixedDt) - options.firstFrame);
+    if (inputPlayer.isLoaded()) frames = std::max(0, (int)std::ceil(inputPlayer.endTick() * Simulation::STEP_D / options.fixedDt - 1.0e-6) - options.firstFrame);
+    if (options.framesGiven) frames = std::min(frames, options.frames);
+    std::vector<double> frameMs;
+    frameMs.reserve(frames);
+    double submitMs = 0.0;   // Lo enviado en el frame anterior, con o sin --timing: lo que enseña el HUD
+    const Clock::time_point begin = Clock::now();
+    AllocStats::setThreadSubsystem(ALLOC_RENDER);
+    for (int i = 0; i < frames; i++) {
+        const Clock::time_point frameStart = Clock::now();
+        advanceSimulation(options.fixedDt);
+        const WorldSnapshot& world = simulation.latest();
+        updateView(world, options.fixedDt);
+        t_global = world.tiempo;
+
+        const Clock::time_point start = Clock::now();
+        RenderStats::beginFrame();
+        gpuProfiler.beginFrame();
+        target.bind();
+        drawWorld(world, options.width, options.height);
+        if (options.hud) drawHud(world, submitMs > 0.0 ? 1000.0 / submitMs : 0.0, options.width, options.height);
+        gpuProfiler.endFrame();
+        RenderStats::endFrame();
+        AllocStats::endFrame();
+        submitMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        renderHistogram.record(submitMs);
+        if (options.timingFile) glFinish();
+        frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+        {
+            AllocScope tools(ALLOC_OTROS);
+            capture.capture(target.getFramebuffer(), options.width, options.height);
+            if (options.dumpFrames) {
+                char file[512];
+                snprintf(file, sizeof(file), "%s_%05d.ppm", options.dumpFrames, options.firstFrame + i);
+                target.savePPM(file);
+            }
+        }
+        const double totalFrameMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        frameHistogram.record(totalFrameMs);
+        scenario.recordFrame(totalFrameMs);
+    }
+    glFinish();
+    const double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    AllocStats::setThreadSubsystem(ALLOC_OTROS);
+    inputRecorder.finish(simulation.steps());
+
+    if (capture.isActive()) {
+        capture.finish();
+        capture.printReport();
+    }
+
+    if (!frameMs.empty()) {
+        double sum = 0.0;
+        for (double ms : frameMs) sum += ms;
+        char line[256];
+        std::cout << "---- Sin ventana (" << context.backend() << ", " << options.width << "x" << options.height << ") ----" << std::endl;
+        snprintf(line, sizeof(line), "Frames: %d en %.1f ms (%.1f fps), %.3f s simulados",
+                 frames, totalMs, frames * 1000.0 / totalMs, frames * options.fixedDt);
+        std::cout << line << std::endl;
+        snprintf(line, sizeof(line), "Frame: media %.3f ms, min %.3f ms, max %.3f ms", sum / frameMs.size(),
+                 *std::min_element(frameMs.begin(), frameMs.end()), *std::max_element(frameMs.begin(), frameMs.end()));
+        std::cout << line << std::endl;
+    }
+
+    if (options.timingFile) {
+        FILE* out = fopen(options.timingFile, "w");
+        if (!out) {
+            std::cerr << "No se puede crear el fichero de tiempos " << options.timingFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        fprintf(out, "frame,tiempo_simulado,ms\n");
+        for (size_t i = 0; i < frameMs.size(); i++) {
+            const int frame = options.firstFrame + (int)i;
+            fprintf(out, "%d,%.6f,%.4f\n", frame, (frame + 1) * options.fixedDt, frameMs[i]);
+        }
+        fclose(out);
+    }
+
+    if (options.gpuProfile) gpuProfiler.printReport();
+    if (percentiles) printFrameTimes(options.percentilesFile);
+    scenario.printReport();
+    if (options.scenarioCsv && scenario.isLoaded()) scenario.writeCsv(options.scenarioCsv);
+    jobs.printStats();
+    printRingStats();
+    AllocStats::printReport();
+    printMemory();
+    if (options.traceFile) dumpTrace(options.traceFile);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    TRACE_THREAD("render");
+    traceSeconds = options.traceSeconds;
+
+    // El sistema de tareas se crea antes de leer las opciones; aún no lo ha usado nadie
+    if (options.workers > 0) jobs.resize(options.workers);
+
+    // Paso de cocinado de texturas (no necesita ventana ni contexto)
+    if (options.cookTextures || options.cookModels) {
+        AssetLoader cooker(jobs);
+        registerAssets(cooker);
+        bool ok = true;
+        if (options.cookTextures) ok = cooker.cookTextures(options.compressTextures) && ok;
+        if (options.cookModels) ok = cooker.cookModels() && ok;
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Las pruebas de imagen lanzan sus propios procesos sin ventana, con su escenario y su semilla
+    if (options.goldenFile) return runGolden(argv[0], options);
+
+    if (options.scenarioFile && options.replayFile) {
+        std::cerr << "--scenario y --replay no se pueden usar a la vez" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (options.scenarioFile && !scenario.load(options.scenarioFile)) return EXIT_FAILURE;
+    if (options.replayFile) {
+        if (!inputPlayer.load(options.replayFile)) return EXIT_FAILURE;
+        simulation.setPlayer(&inputPlayer);
+    }
+    if (options.batch > 0) return runBatch(argv[0], options);
+    if (options.headless) return runHeadless(options);
 
     if (!glfwInit()) {
         std::cerr << "No se pudo inicializar GLFW\n";
@@ -1177,7 +1247,7 @@ int main()
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Pecera 3D - Proyecto Final", nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
     if (!window) {
         std::cerr << "No se pudo crear la ventana GLFW\n";
         glfwTerminate();
@@ -1185,150 +1255,165 @@ int main()
     }
     glfwMakeContextCurrent(window);
 
-    glewExperimental = GL_TRUE;
-    if (glewInit() != GLEW_OK) {
-        std::cerr << "ERROR: No se pudo iniciar GLEW\n";
+    if (!initGlew(false)) {
         glfwTerminate();
         return EXIT_FAILURE;
     }
 
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glClearColor(0.85f, 0.82f, 0.75f, 1.0f);
-
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetCursorPosCallback(window, cursor_pos_callback);
     glfwSetScrollCallback(window, scroll_callback);
-
-    shader.initShaders(
-        "resources/shaders/vshader.glsl",
-        "resources/shaders/fshader.glsl"
-    );
-
-    cubeModel.initModel("resources/models/cube.obj");
-    fishModel.initModel("resources/models/pez.obj");
-    sphereModel.initModel("resources/models/sphere.obj");
-    tableModel.initModel("resources/models/Table.obj");
-    coralModel.initModel("resources/models/coral.obj");
-    coneModel.initModel("resources/models/cone.obj");
-
-    sandTexture = loadTexture("resources/textures/arena.jpg");
-    coralTexture = loadTexture("resources/textures/coral.jpg");
-    ventiladorTexture = loadTexture("resources/textures/ventilador1.jpg");
-    
-    createBackgroundPlane();
-    roomBackTexture = loadTexture("resources/textures/room_back.jpg");
-    backgroundTexture = loadTexture("resources/textures/acuario.jpeg");
-
-    // Inicializar peces
-    srand(time(NULL));
-    peces[0] = {glm::vec3(-2.0f, -0.3f, -11.2f), glm::vec3(0.6f, 0.1f, 0.25f), glm::vec3(0.6f, 0.1f, 0.25f), glm::vec4(0.2f, 0.6f, 0.8f, 1.0f), 0.0f, 0.37f};
-    peces[1] = {glm::vec3(2.0f, -2.8f, -12.8f), glm::vec3(-0.4f, -0.15f, 0.35f), glm::vec3(-0.4f, -0.15f, 0.35f), glm::vec4(0.9f, 0.5f, 0.2f, 1.0f), 1.5f, 0.35f};
-    peces[2] = {glm::vec3(-1.5f, -3.0f, -11.0f), glm::vec3(0.5f, 0.1f, -0.4f), glm::vec3(0.5f, 0.1f, -0.4f), glm::vec4(0.8f, 0.2f, 0.3f, 1.0f), 3.0f, 0.39f};
-    peces[3] = {glm::vec3(1.8f, -0.8f, -12.5f), glm::vec3(0.35f, 0.15f, -0.4f), glm::vec3(0.35f, 0.15f, -0.4f), glm::vec4(0.9f, 0.9f, 0.3f, 1.0f), 4.5f, 0.36f};
-    peces[4] = {glm::vec3(0.2f, -1.8f, -11.3f), glm::vec3(-0.55f, 0.0f, 0.3f), glm::vec3(-0.55f, 0.0f, 0.3f), glm::vec4(0.6f, 0.3f, 0.8f, 1.0f), 2.0f, 0.38f};
-    peces[5] = {glm::vec3(-1.8f, -1.3f, -13.0f), glm::vec3(0.4f, -0.08f, 0.4f), glm::vec3(0.4f, -0.08f, 0.4f), glm::vec4(0.3f, 0.8f, 0.6f, 1.0f), 3.5f, 0.39f};
-    peces[6] = {glm::vec3(1.2f, -2.5f, -11.8f), glm::vec3(-0.5f, 0.15f, -0.35f), glm::vec3(-0.5f, 0.15f, -0.35f), glm::vec4(0.9f, 0.3f, 0.5f, 1.0f), 5.0f, 0.37f};
-    peces[7] = {glm::vec3(-0.8f, -0.5f, -12.4f), glm::vec3(0.5f, -0.1f, 0.35f), glm::vec3(0.5f, -0.1f, 0.35f), glm::vec4(0.4f, 0.5f, 0.9f, 1.0f), 1.0f, 0.38f};
-    peces[8] = {glm::vec3(0.5f, -2.2f, -12.0f), glm::vec3(0.45f, 0.1f, 0.3f), glm::vec3(0.45f, 0.1f, 0.3f), glm::vec4(0.7f, 0.4f, 0.9f, 1.0f), 2.5f, 0.36f};
-    
-    for (int i = 0; i < NUM_PECES; i++) {
-        glm::vec3 velNorm = glm::normalize(peces[i].velocidad);
-        peces[i].anguloDireccion = atan2(velNorm.x, velNorm.z);
-        peces[i].anguloObjetivo = peces[i].anguloDireccion;
-        peces[i].tiempoOndulacion = (float)rand() / RAND_MAX * 6.28f;
-        peces[i].amplitudOndulacion = 0.02f + (float)rand() / RAND_MAX * 0.015f;
-        peces[i].frecuenciaOndulacion = 4.0f + (float)rand() / RAND_MAX * 1.0f;
-        peces[i].tiempoCambio = (float)rand() / RAND_MAX * 3.0f;
-        peces[i].alturaObjetivo = peces[i].posicion.y;
-        peces[i].modeloTipo = 0;
-        peces[i].persigiendoComida = false;
+    hudVisible = options.hud;
+
+    // Con escenario, semilla fija como sin ventana
+    const unsigned int seed = sessionSeed(options, scenario.isLoaded() ? 1 : (unsigned)time(nullptr));
+    initScene(seed);
+    startRecording(options, seed);
+    AllocStats::setCheck(options.allocCheck);
+
+    // Simulación en su propio hilo; este hilo solo atiende la ventana y dibuja. Con escenario la
+    // avanza este hilo a paso fijo, un frame cada vez, igual que sin ventana
+    if (!scenario.isLoaded()) simulation.start();
+    // Ritmo de frames: vsync y limitador según la línea de órdenes
+    FramePacer pacer;
+    pacer.init(options.targetFps, options.vsync);
+
+    // Grabación de frames (opcional): el tamaño queda fijado al del framebuffer inicial
+    FrameCapture capture;
+    if (options.captureFile) {
+        int captureWidth = 0;
+        int captureHeight = 0;
+        glfwGetFramebufferSize(window, &captureWidth, &captureHeight);
+        if (!capture.start(options.captureFile, captureWidth, captureHeight)) {
+            simulation.stop();
+            glfwTerminate();
+            return EXIT_FAILURE;
+        }
     }
 
-    // Inicializar comida
-    for (int i = 0; i < MAX_COMIDA; i++) {
-        comidas[i].activa = false;
-    }
-    
-    // Inicializar burbujas
-    for (int i = 0; i < MAX_BURBUJAS; i++) {
-        burbujas[i].activa = false;
-    }
-    
-    // Inicializar ventilador
-    ventilador.posicion = glm::vec3(10.0f, -8.8f, -11.5f);  
-    ventilador.anguloAspas = 0.0f;
-    ventilador.velocidadRotacion = 360.0f;  // Velocidad de rotación de las aspas (grados/segundo)
-    ventilador.anguloMovimiento = 0.0f;     
-    ventilador.radio = 10.0f;
-    ventilador.anguloRotacionPalo = 0.0f;  // Inicializar rotación del palo               
-    
-    // Generar burbujas iniciales cerca de los peces
-    for (int i = 0; i < 15; i++) {
-        if (i < MAX_BURBUJAS) {
-            int pezIndex = rand() % peces_visibles;
-            glm::vec3 posPez = peces[pezIndex].posicion;
-            
-            float offsetX = (rand() % 60 - 30) / 100.0f;  
-            float offsetY = (rand() % 100) / 100.0f;      
-            float offsetZ = (rand() % 40 - 20) / 100.0f;  
-            
-            burbujas[i].posicion = glm::vec3(
-                posPez.x + offsetX,
-                posPez.y + offsetY,
-                posPez.z + offsetZ
-            );
-            burbujas[i].escala = 0.020f + (rand() % 60) / 3000.0f;
-            burbujas[i].velocidadSubida = 0.25f + (rand() % 80) / 400.0f;
-            burbujas[i].oscilacionX = 0.06f + (rand() % 40) / 500.0f;
-            burbujas[i].oscilacionZ = 0.06f + (rand() % 40) / 500.0f;
-            burbujas[i].fase = (rand() % 628) / 100.0f;
-            burbujas[i].activa = true;
-        }
+    // Resolución dinámica (opcional): la escena va a un framebuffer interno que se escala a la ventana
+    DynamicResolution dynres;
+    RenderTarget sceneTarget;
+    Upscaler upscaler;
+    if (options.dynresBudgetMs > 0.0) {
+        dynres.init(options.dynresBudgetMs, options.dynresMinScale);
+        upscaler.init(options.upscale);
     }
 
+    // Los percentiles de GPU necesitan las consultas de tiempo aunque no se pida --gpu-profile
+    const bool percentiles = options.percentiles || options.percentilesFile;
+    gpuProfiler.init(options.gpuProfile || percentiles);
+    gpuProfiler.setFrameHistogram(&gpuHistogram);
+
     // Bucle principal
-    float lastTime = static_cast<float>(glfwGetTime());
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point lastFrame = Clock::now();
+    bool firstFrame = true;
+    AllocStats::setThreadSubsystem(ALLOC_RENDER);
     while (!glfwWindowShouldClose(window))
     {
-        float currentTime = static_cast<float>(glfwGetTime());
-        float deltaTime = currentTime - lastTime;
-        lastTime = currentTime;
-        t_global = currentTime;
-
-        actualizarPeces(deltaTime);
-        actualizarComida(deltaTime);
-        actualizarBurbujas(deltaTime);
-        actualizarVentilador(deltaTime);
-        
-        // Generar burbujas continuamente 
-        tiempoUltimaBurbuja += deltaTime;
-        if (tiempoUltimaBurbuja >= 0.25f + (rand() % 100) / 200.0f) {  
-            generarBurbuja();
-            tiempoUltimaBurbuja = 0.0f;
+        // Primero el limitador y después la entrada, para que la cámara use el estado más reciente
+        pacer.waitFrame();
+        const Clock::time_point frameStart = Clock::now();
+        const double intervalMs = std::chrono::duration<double, std::milli>(frameStart - lastFrame).count();
+        frameHistogram.record(intervalMs);
+        if (!firstFrame) scenario.recordFrame(intervalMs);
+        lastFrame = frameStart;
+        firstFrame = false;
+        glfwPollEvents();
+
+        // El escenario avanza su tiempo fijo por frame y cierra la ventana al terminar
+        if (scenario.isLoaded()) {
+            if (scenario.finished()) break;
+            advanceSimulation(options.fixedDt);
         }
-        
-        processInput(window);
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Última copia completa del mundo publicada por la simulación (no bloquea)
+        const WorldSnapshot& world = simulation.latest();
+        t_global = world.tiempo;
+        if (inputPlayer.isLoaded() && world.paso >= inputPlayer.endTick()) glfwSetWindowShouldClose(window, true);
+
+        // La entrada de cámara y luz ya se ha aplicado en los callbacks; aquí solo las teclas
+        // mantenidas durante el último frame (y lo grabado, al repetir una grabación)
+        updateView(world, intervalMs / 1000.0);
 
         int width = 0;
         int height = 0;
         glfwGetFramebufferSize(window, &width, &height);
-        if (height == 0) height = 1;
 
-        const float aspect = static_cast<float>(width) / static_cast<float>(height);
-        const glm::vec3 eye = computeCameraPosition();
-        const glm::mat4 view = glm::lookAt(eye, camOffset, glm::vec3(0.0f, 1.0f, 0.0f));
-        const glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+        // La cámara se construye ya con la entrada leída
+        pacer.inputRead();
+        const Clock::time_point renderStart = Clock::now();
+        RenderStats::beginFrame();
+        gpuProfiler.beginFrame();
+        if (options.dynresBudgetMs > 0.0 && width > 0 && height > 0) {
+            int renderWidth = 0;
+            int renderHeight = 0;
+            dynres.renderSize(width, height, renderWidth, renderHeight);
+            if (renderWidth != sceneTarget.getWidth() || renderHeight != sceneTarget.getHeight()) sceneTarget.init(renderWidth, renderHeight);
+
+            dynres.beginScene();
+            sceneTarget.bind();
+            drawWorld(world, renderWidth, renderHeight);
+            dynres.endScene();
+
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            beginPass("escalado");
+            upscaler.draw(sceneTarget, width, height);
+            endPass();
+        } else {
+            drawWorld(world, width, height);
+        }
+        if (hudVisible) drawHud(world, pacer.getFps(), width, height);
+        gpuProfiler.endFrame();
+        RenderStats::endFrame();
+        AllocStats::endFrame();
+        if (options.gpuProfile) gpuProfiler.logPeriodically(1.0);
+        {
+            AllocScope tools(ALLOC_OTROS);
+            capture.capture(0, width, height);
+        }
+        const Clock::time_point swapStart = Clock::now();
+        renderHistogram.record(std::chrono::duration<double, std::milli>(swapStart - renderStart).count());
+
+        {
+            TRACE_SCOPE("swap");
+            glfwSwapBuffers(window);
+        }
+        swapHistogram.record(std::chrono::duration<double, std::milli>(Clock::now() - swapStart).count());
 
-        renderScene(projection, view, eye, t_global);
+        // Una vez por segundo: frames por segundo y latencia en el título de la ventana
+        if (pacer.framePresented()) {
+            char title[128];
+            if (options.dynresBudgetMs > 0.0) {
+                snprintf(title, sizeof(title), "%s | %.0f fps | latencia %.1f ms | escala %.2f", WINDOW_TITLE, pacer.getFps(), pacer.getLatency().lastMs, dynres.getScale());
+            } else {
+                snprintf(title, sizeof(title), "%s | %.0f fps | latencia %.1f ms", WINDOW_TITLE, pacer.getFps(), pacer.getLatency().lastMs);
+            }
+            glfwSetWindowTitle(window, title);
+        }
+    }
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    AllocStats::setThreadSubsystem(ALLOC_OTROS);
+    simulation.stop();
+    inputRecorder.finish(simulation.steps());
+    if (capture.isActive()) {
+        capture.finish();
+        capture.printReport();
     }
+    pacer.printReport();
+    if (options.dynresBudgetMs > 0.0) dynres.printReport();
+    if (options.gpuProfile) gpuProfiler.printReport();
+    if (percentiles) printFrameTimes(options.percentilesFile);
+    scenario.printReport();
+    if (options.scenarioCsv && scenario.isLoaded()) scenario.writeCsv(options.scenarioCsv);
+    jobs.printStats();
+    printRingStats();
+    AllocStats::printReport();
+    printMemory();
+    if (options.traceFile) dumpTrace(options.traceFile);
 
     glfwTerminate();
     return EXIT_SUCCESS;